@@ -1,11 +1,14 @@
 #pragma once
 
 #include "ai_safety_common/shared_memory_types.hpp"
+#include "ai_safety_controller/common/gateway_serial.hpp"
 #include "ai_safety_controller/common/status.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
 
 #include <atomic>
 #include <boost/signals2.hpp>
 #include <chrono>
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
@@ -56,6 +59,10 @@ class DevicesManagerClient {
   ai_safety_common::CraneState getCraneState() const;
   /** 获取各单点激光最近一次有效原始值（单位 mm，key 为实例 id）。 */
   std::unordered_map<std::string, std::uint16_t> getLatestLidarRawMm() const;
+  /** 获取各端点 / 功能码的收发延迟与计数统计，同 Interface::metricsSnapshot。 */
+  std::vector<common::TransactionSeriesSnapshot> getMetricsSnapshot() const;
+  /** 获取各总线按优先级的排队延迟与轮询跳过统计，同 Interface::busQueueSnapshot。 */
+  std::vector<common::BusQueueSnapshot> getBusQueueSnapshot() const;
 
   /**
    * 获取当前报警状态（四个 bool 字段）。
@@ -105,23 +112,36 @@ class DevicesManagerClient {
   void notifyThreadFunc();
   void applySpeakerControlByAlert(const ai_safety_common::AlertMessage& alert);
   bool applySpeakerMode(SpeakerMode mode, bool quiet = false);
+  void collectSpeakerCommand();
   void applyBatteryButtonControl(std::uint8_t raw_cmd, bool force_send = false);
+  bool collectBatteryButtonCommand();
   bool isBatteryButtonCommandOutOfSync(PowerCommand expected_cmd);
-  void restoreBatteryButtonPowerStateFromRelays(bool log_output = true);
+  bool readBatteryButtonRelays(std::chrono::milliseconds max_age, bool* any_on, bool* any_off);
+  void restoreBatteryButtonPowerStateFromRelays(
+      bool log_output = true, std::chrono::milliseconds max_age = std::chrono::milliseconds(0));
   static const char* toSpeakerCtlArg(SpeakerMode mode);
 
   std::unique_ptr<Interface> impl_;
   bool initialized_ = false;
   bool started_ = false;
   std::optional<SpeakerMode> applied_speaker_mode_;
+  // 已提交、尚未完成的喇叭 / 继电器命令（Interface::queryAsync），通知线程不等待总线
+  std::future<Status> speaker_command_;
+  std::future<Status> relay_command_;
+  PowerCommand relay_command_target_ = PowerCommand::None;
   bool both_round_robin_active_ = false;
   BothSpeakerStage both_stage_ = BothSpeakerStage::Playing3M;
+  // 最近一次轮播命令发出前的阶段；命令写失败时退回该阶段重发
+  BothSpeakerStage both_retry_stage_ = BothSpeakerStage::GapAfter7M;
   std::chrono::steady_clock::time_point both_stage_deadline_{};
   std::chrono::milliseconds both_play_window_{5000};
   std::chrono::milliseconds both_switch_gap_{200};
   std::chrono::steady_clock::time_point last_push_ts_{};
   std::chrono::steady_clock::time_point next_relay_state_sync_ts_{};
+  // 启动后的首次继电器同步在通知线程里、首次状态推送之后进行
+  bool relay_state_restored_ = false;
   std::vector<int> battery_button_relay_channels_{};
+  std::uint16_t battery_button_relay_mask_ = 0;  // bit0 = 第1路
   ai_safety_common::DeviceStatus last_sent_device_status_{};
   bool has_last_sent_device_status_ = false;
   ai_safety_common::CraneState last_sent_crane_state_{};
@@ -129,7 +149,10 @@ class DevicesManagerClient {
   std::optional<PowerCommand> last_battery_button_cmd_;
   std::optional<PowerCommand> last_received_battery_button_cmd_;
   std::chrono::milliseconds status_push_keepalive_interval_{1000};
+  std::chrono::milliseconds host_signal_poll_interval_{100};
   std::chrono::milliseconds relay_state_sync_interval_{3000};
+  // 主工程信号每轮都做一致性检查，继电器映像在此时限内复用而不重新读取
+  std::chrono::milliseconds relay_image_max_age_{1000};
   std::atomic<bool> notify_stop_{false};
   std::thread notify_thread_;
 };
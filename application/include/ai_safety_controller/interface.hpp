@@ -1,15 +1,29 @@
 #pragma once
 
 #include "ai_safety_common/shared_memory_types.hpp"
+#include "ai_safety_controller/common/bus_executor.hpp"
+#include "ai_safety_controller/common/change_notifier.hpp"
+#include "ai_safety_controller/common/deadline_scheduler.hpp"
+#include "ai_safety_controller/common/gateway_serial.hpp"
+#include "ai_safety_controller/common/json_value.hpp"
+#include "ai_safety_controller/common/query_result.hpp"
+#include "ai_safety_controller/common/sensor_snapshot.hpp"
+#include "ai_safety_controller/common/seqlock_snapshot.hpp"
 #include "ai_safety_controller/common/status.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
 #include "ai_safety_controller/sensor_factory/sensor_factory.hpp"
 
 #include <memory>
 #include <string>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <future>
+#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -41,6 +55,41 @@ using AlertMessage = ai_safety_common::AlertMessage;
 using CraneState = ai_safety_common::CraneState;
 using PowerCommand = ai_safety_common::JoystickControlData::PowerCommand;
 
+// 按字段比较共享内存状态（不比较填充字节；浮点按值比较，-0.0 与 0.0 相等）
+inline bool equalsBatteryInfo(const DeviceStatus::BatteryInfo& lhs, const DeviceStatus::BatteryInfo& rhs) {
+  return lhs.percent == rhs.percent &&
+         lhs.remainingMin == rhs.remainingMin &&
+         lhs.isCharging == rhs.isCharging &&
+         lhs.chargingTimeMin == rhs.chargingTimeMin &&
+         lhs.voltageV == rhs.voltageV &&
+         lhs.currentA == rhs.currentA;
+}
+
+inline bool equalsDeviceStatus(const DeviceStatus& lhs, const DeviceStatus& rhs) {
+  return lhs.solarCharge == rhs.solarCharge &&
+         lhs.trolleyState == rhs.trolleyState &&
+         equalsBatteryInfo(lhs.trolleyBattery, rhs.trolleyBattery) &&
+         lhs.hookState == rhs.hookState &&
+         equalsBatteryInfo(lhs.hookBattery, rhs.hookBattery);
+}
+
+inline bool equalsCraneState(const CraneState& lhs, const CraneState& rhs) {
+  return lhs.hookToTrolleyDistanceM == rhs.hookToTrolleyDistanceM &&
+         lhs.groundToTrolleyDistanceM == rhs.groundToTrolleyDistanceM;
+}
+
+struct DeviceStatusEqual {
+  bool operator()(const DeviceStatus& lhs, const DeviceStatus& rhs) const {
+    return equalsDeviceStatus(lhs, rhs);
+  }
+};
+
+struct CraneStateEqual {
+  bool operator()(const CraneState& lhs, const CraneState& rhs) const {
+    return equalsCraneState(lhs, rhs);
+  }
+};
+
 class DriverAdapter {
  public:
   virtual ~DriverAdapter() = default;
@@ -69,6 +118,7 @@ class Interface {
     int module_slave_id = 3;
     int battery_slave_id = 2;
     bool charge_time_debug = false;
+    int read_gap_tolerance = 4;
     double query_hz = 0.0;
     RetryPolicy retry_policy{};
   };
@@ -81,6 +131,7 @@ class Interface {
     int solar_slave_id = 4;
     double sample_timeout_sec = 5.0;
     int stale_timeout_ms = 2500;
+    int read_gap_tolerance = 4;
     double query_hz = 0.0;
     RetryPolicy retry_policy{};
   };
@@ -118,6 +169,7 @@ class Interface {
     double query_hz = 0.0;
     int both_speaker_play_window_ms = 5000;
     int both_speaker_switch_gap_ms = 200;
+    int read_gap_tolerance = 4;
     RetryPolicy retry_policy{};
   };
 
@@ -136,6 +188,19 @@ class Interface {
     double linear_k = 1.0;
     double linear_b = 0.0;
     double query_hz = 0.0;
+    std::string acquisition_mode = "fixed_rate";  // fixed_rate | on_demand
+    double sample_hz = 50.0;
+    int velocity_window = 20;
+    int velocity_warmup = 5;
+  };
+
+  struct ModbusGatewayDefaults {
+    std::string module_ip = "192.168.1.12";
+    int module_port = 502;
+    bool pipelined = false;
+    int max_in_flight = 4;
+    // 非流水线网关：排队（含正在执行）的请求数达到该值时，后台轮询整轮跳过
+    int background_backlog_limit = 3;
   };
 
   struct SpdLidarInstanceDefaults {
@@ -150,6 +215,17 @@ class Interface {
     double vertical_angle_to_vertical_deg = 0.0;
   };
 
+  /** 单个驱动最近一次拉起（init 探测 / start 启动）的结果 */
+  struct DriverReadiness {
+    std::string name;
+    std::string lane;   // 所在物理总线，同一 lane 上的驱动依次拉起
+    std::string phase;  // "init" | "start"
+    bool finished = false;
+    bool ok = false;
+    std::string message;
+    double elapsed_ms = 0.0;  // 从本阶段开始到完成
+  };
+
   Interface();
   ~Interface();
 
@@ -161,14 +237,60 @@ class Interface {
   const HoistHookDefaults& hoistHookDefaults() const;
   const EncoderDefaults& encoderDefaults() const;
   const std::vector<SpdLidarInstanceDefaults>& spdLidarInstances() const;
+  const std::vector<ModbusGatewayDefaults>& modbusGateways() const;
   double spdLidarQueryHz() const;
 
   Status init();
   Status start();
   Status stop();
+  // 重新读取 loadedConfigPath()，与运行中的配置逐项比较，只应用发生变化的部分。
+  Status reloadConfig();
+  // 用 inotify 监视配置文件，保存或替换后自动 reloadConfig()。
+  Status startConfigWatch();
+  void stopConfigWatch();
   Status query(const std::string& sensor, const std::vector<std::string>& args);
+  /**
+   * 结构化查询：返回寄存器原始值 / 解码后的数值 / 状态与耗时，不写 std::cout，不持有输出锁。
+   * 支持 battery summary|get、solar charge|get、hoist_hook power|get、io_relay read <ch>、
+   * multi_turn_encoder get|status、spd_lidar status。文本展示用 common::formatQueryResult()。
+   */
+  common::QueryResult queryResult(const std::string& sensor, const std::vector<std::string>& args);
+  /**
+   * 每个 sensor 最近一次 queryResult() 的定长记录（首个数值、状态、完成时间、耗时），按 common::SensorSlot 下标。
+   * 轮询线程只做定长拷贝，读取不阻塞写入；文本展示用 common::formatSensorRecord()。
+   */
+  std::array<common::SensorRecord, common::kSensorSlotCount> sensorSnapshot() const;
+  /**
+   * 各端点 / 功能码的收发统计：请求数、失败 / 重试 / 超时次数、收发字节数，
+   * 以及排队、建连、往返、总耗时的延迟分位数。文本展示用 common::formatTransactionMetrics()。
+   */
+  std::vector<common::TransactionSeriesSnapshot> metricsSnapshot() const;
+  /**
+   * 各总线按优先级（control / normal / background）的排队统计：已放行次数、当前排队数、
+   * 排队延迟分位数，以及 background 因总线饱和被跳过的轮询轮数。文本展示用 common::formatBusQueueMetrics()。
+   */
+  std::vector<common::BusQueueSnapshot> busQueueSnapshot() const;
+  /**
+   * init() / start() 按物理总线并行拉起驱动（连接、探测、启动），不同总线互不等待。
+   * 两个阶段合计最多等待 ASC_STARTUP_DEADLINE_MS（默认 800ms），超时未完成的驱动在后台继续，
+   * 完成后更新这里的状态并打日志。按驱动名排序。
+   */
+  std::vector<DriverReadiness> driverReadiness() const;
+  bool driverReady(const std::string& name) const;
   std::vector<std::string> enabledSensors() const;
   Status dispatchCommand(const std::string& sensor, const std::vector<std::string>& args);
+  /**
+   * 异步版 query / queryResult：命令按所在物理总线排队后立即返回，同一总线严格按提交顺序执行，
+   * 不同总线（网关端点 / 串口）互不等待。执行时不持有输出锁，控制类命令建议带 quiet 参数。
+   * stop() 或析构时仍在排队的命令以失败 Status 结束，future 不会悬空。
+   */
+  std::future<Status> queryAsync(const std::string& sensor, const std::vector<std::string>& args);
+  // 回调形式：done 在总线 worker 线程上执行，请勿在回调里同步等待同一总线上的命令。
+  void queryAsync(const std::string& sensor,
+                  const std::vector<std::string>& args,
+                  std::function<void(const Status&)> done);
+  std::future<common::QueryResult> queryResultAsync(const std::string& sensor,
+                                                    const std::vector<std::string>& args);
   std::vector<std::string> availableCommands(const std::string& sensor) const;
   void setDeviceStatus(const DeviceStatus& data);
   DeviceStatus getDeviceStatus() const;
@@ -178,6 +300,8 @@ class Interface {
   std::unordered_map<std::string, std::uint16_t> getLatestLidarRawMm() const;
   AlertMessage getAlertMessage() const;
   std::uint8_t getBatteryButtonSignals() const;
+  // Bumped whenever DeviceStatus or CraneState actually changes.
+  common::ChangeNotifier& stateChanges();
 
 #ifdef ASC_ENABLE_BATTERY
   battery::BatteryCore* battery();
@@ -186,7 +310,12 @@ class Interface {
   hoist_hook::HoistHookCore* hoistHook();
 #endif
 #ifdef ASC_ENABLE_IO_RELAY
+  // 裸指针在 reloadConfig() 重建驱动后失效；其它线程请用下面两个持锁的接口。
   io_relay::IoRelayCore* ioRelay();
+  bool hasIoRelay() const;
+  /** 同 IoRelayCore::getRelayImage()，读取期间持 drivers_mutex_ 共享锁 */
+  bool ioRelayImage(std::uint16_t* image,
+                    std::chrono::milliseconds max_age = std::chrono::milliseconds(0));
 #endif
 #ifdef ASC_ENABLE_MULTI_TURN_ENCODER
   multi_turn_encoder::MultiTurnEncoderCore* multiTurnEncoder();
@@ -204,34 +333,91 @@ class Interface {
   static bool parseDouble(const std::string& text, double* out);
 
   Status loadDefaultConfigIfPresent();
-  static std::string extractObjectBody(const std::string& json_text, const std::string& key);
-  static std::string extractArrayBody(const std::string& json_text, const std::string& key);
-  static std::vector<std::string> splitTopLevelObjects(const std::string& array_body);
-  static bool extractStringValue(const std::string& object_body, const std::string& key, std::string* out);
-  static bool extractIntValue(const std::string& object_body, const std::string& key, int* out);
-  static bool extractIntArrayValue(const std::string& object_body,
+  static bool loadConfigDocument(const std::string& path, common::JsonValue* root, std::string* error);
+  static bool extractStringValue(const common::JsonValue* object, const std::string& key, std::string* out);
+  static bool extractIntValue(const common::JsonValue* object, const std::string& key, int* out);
+  static bool extractIntArrayValue(const common::JsonValue* object,
                                    const std::string& key,
                                    std::vector<int>* out);
-  static bool extractBoolValue(const std::string& object_body, const std::string& key, bool* out);
-  static bool extractDoubleValue(const std::string& object_body, const std::string& key, double* out);
-  void applyBatteryDefaultsFromJson(const std::string& json_text);
-  void applySolarDefaultsFromJson(const std::string& json_text);
-  void applyIoRelayDefaultsFromJson(const std::string& json_text);
-  void applyHoistHookDefaultsFromJson(const std::string& json_text);
-  void applyEncoderDefaultsFromJson(const std::string& json_text);
-  void applySpdLidarDefaultsFromJson(const std::string& json_text);
+  static bool extractBoolValue(const common::JsonValue* object, const std::string& key, bool* out);
+  static bool extractDoubleValue(const common::JsonValue* object, const std::string& key, double* out);
+  // 一份完整的运行配置；reloadConfig() 先解析到局部副本，在独占锁下整体替换成员。
+  struct RuntimeDefaults {
+    BatteryDefaults battery;
+    SolarDefaults solar;
+    IoRelayDefaults io_relay;
+    HoistHookDefaults hoist_hook;
+    EncoderDefaults encoder;
+    double spd_lidar_query_hz = 0.0;
+    std::vector<SpdLidarInstanceDefaults> spd_lidar_instances;
+    std::vector<ModbusGatewayDefaults> modbus_gateways;
+  };
+  // 在 *out 之上套用配置文件；不读写任何成员
+  static Status parseConfig(const std::string& path, RuntimeDefaults* out);
+  RuntimeDefaults currentDefaults() const;
+  void publishDefaults(RuntimeDefaults&& cfg);
+  // 入参均为已解析的 "runtime" 对象，结果写入 out
+  static void applyBatteryDefaultsFromJson(const common::JsonValue& runtime, BatteryDefaults* out);
+  static void applySolarDefaultsFromJson(const common::JsonValue& runtime, SolarDefaults* out);
+  static void applyIoRelayDefaultsFromJson(const common::JsonValue& runtime, IoRelayDefaults* out);
+  static void applyHoistHookDefaultsFromJson(const common::JsonValue& runtime, HoistHookDefaults* out);
+  static void applyEncoderDefaultsFromJson(const common::JsonValue& runtime, EncoderDefaults* out);
+  static void applySpdLidarDefaultsFromJson(const common::JsonValue& runtime,
+                                            double* query_hz_out,
+                                            std::vector<SpdLidarInstanceDefaults>* out);
+  static void applyModbusGatewayDefaultsFromJson(const common::JsonValue& runtime,
+                                                 std::vector<ModbusGatewayDefaults>* out);
   void buildDriverAdapters();
+  struct BringUpStep {
+    std::string name;
+    std::function<Status()> run;  // 为空表示无需访问设备，直接记为就绪
+  };
+  // 按 bringUpLane() 分组投递到 command_executor_，等到 deadline 后打印汇总并返回
+  void runBringUp(const std::string& phase,
+                  const std::vector<BringUpStep>& steps,
+                  std::chrono::steady_clock::time_point deadline);
+  std::string bringUpLane(const std::string& sensor) const;
+#ifdef ASC_ENABLE_BATTERY
+  void createBatteryDriver();
+#endif
+#ifdef ASC_ENABLE_HOIST_HOOK
+  void createHoistHookDriver();
+  Status applyHoistHookSpeakerVolume();
+#endif
+#ifdef ASC_ENABLE_IO_RELAY
+  void createIoRelayDriver();
+#endif
+#ifdef ASC_ENABLE_MULTI_TURN_ENCODER
+  void createEncoderDriver();
+#endif
+#ifdef ASC_ENABLE_SOLAR
+  void createSolarDriver();
+#endif
+#ifdef ASC_ENABLE_SPD_LIDAR
+  std::unique_ptr<spd_lidar::SpdLidarCore> createSpdLidarCore(const SpdLidarInstanceDefaults& cfg);
+#endif
+  void configWatchLoop(const std::string& config_path);
   void startAutoQueryPolling();
   void stopAutoQueryPolling();
-  Status queryWithCapturedOutput(const std::string& sensor,
-                                 const std::vector<std::string>& args,
-                                 std::string* captured_output);
+  // 传感器名 -> 所在总线的执行 lane。lane 表随 publishDefaults() 整体替换，
+  // queryAsync() 等调用方不持 drivers_mutex_ 也能安全读取。
+  struct BusLanes {
+    std::unordered_map<std::string, std::string> by_sensor;
+    std::string encoder_port;  // 编码器自身的串口 / 端点，仅用于拉起
+  };
+  static std::shared_ptr<const BusLanes> buildBusLanes(const RuntimeDefaults& cfg);
+  std::string busLane(const std::string& sensor) const;
+  Status fillQueryResult(const std::string& sensor,
+                         const std::vector<std::string>& args,
+                         common::QueryResult* out);
   void startSnapshotPrinter();
   void stopSnapshotPrinter();
   void printSnapshotTick();
   void updateTrolleyStateFromDrivers();
   void updateHookStateFromDriver();
+  void mergeDeviceStatus(const std::function<void(DeviceStatus*)>& apply);
   void setCraneState(const CraneState& data);
+  void mergeCraneState(const std::function<void(CraneState*)>& apply);
   void updateCraneStateFromEncoder(double turns_value);
   void updateCraneStateFromLidarMeasurement(const std::string& id,
                                             std::uint16_t raw_mm,
@@ -265,7 +451,12 @@ class Interface {
                         const std::vector<uint8_t>& request,
                         std::vector<uint8_t>* response,
                         std::string* error);
-  void spdLidarAcceptLoop(const std::string& endpoint_key);
+  bool spdLidarServerSend(const SpdLidarInstanceDefaults& cfg,
+                          const std::vector<uint8_t>& request,
+                          std::string* error);
+  void spdLidarReactorLoop();
+  void spdLidarAcceptPending(const std::string& endpoint_key, int listen_fd);
+  void spdLidarReadConnection(const std::string& instance_id, int fd, uint32_t events);
   std::string matchSpdLidarServerInstance(const std::string& endpoint_key,
                                           const std::string& peer_ip,
                                           int peer_port) const;
@@ -284,26 +475,38 @@ class Interface {
   HoistHookDefaults hoist_hook_defaults_;
   EncoderDefaults encoder_defaults_;
   std::vector<SpdLidarInstanceDefaults> spd_lidar_instances_;
+  std::vector<ModbusGatewayDefaults> modbus_gateways_;
+  std::shared_ptr<const BusLanes> bus_lanes_;  // 用 std::atomic_load / atomic_store 访问
   SensorFactory factory_;
   std::unordered_map<std::string, std::unique_ptr<DriverAdapter>> drivers_;
-  std::atomic<bool> auto_query_running_;
+  // query() 持共享锁；reloadConfig() 替换驱动实例时持独占锁。
+  mutable std::shared_mutex drivers_mutex_;
+  std::mutex reload_mutex_;
+  std::thread config_watch_thread_;
+  std::atomic<bool> config_watch_running_{false};
+  int config_watch_wake_fd_ = -1;
   std::atomic<bool> snapshot_printer_running_;
-  std::vector<std::thread> auto_query_threads_;
+  common::DeadlineScheduler auto_query_scheduler_;
+  // queryAsync() / queryResultAsync() 的按总线命令队列
+  common::BusExecutor command_executor_;
+  // 驱动拉起状态；后台完成的步骤也写这里
+  mutable std::mutex readiness_mutex_;
+  std::condition_variable readiness_cv_;
+  std::map<std::string, DriverReadiness> readiness_;
+  std::chrono::steady_clock::time_point startup_deadline_{};
   std::thread snapshot_printer_thread_;
-  std::unordered_map<std::string, std::string> latest_query_output_;
-  std::unordered_map<std::string, Status> latest_query_status_;
-  std::unordered_map<std::string, std::chrono::system_clock::time_point> latest_query_time_;
-  DeviceStatus latest_device_status_;
-  CraneState latest_crane_state_;
+  common::SensorSnapshotTable sensor_snapshot_;
+  // Readers never block; writers go through set*/merge* (atomic RMW).
+  common::SeqlockSnapshot<DeviceStatus, DeviceStatusEqual> device_status_;
+  common::SeqlockSnapshot<CraneState, CraneStateEqual> crane_state_;
+  common::ChangeNotifier state_changes_;
   AlertMessage latest_alert_message_;
   std::uint8_t latest_battery_button_signals_ = 0;
   std::unordered_map<std::string, double> latest_lidar_projected_distance_m_;
   std::unordered_map<std::string, std::uint16_t> latest_lidar_raw_mm_;
   std::atomic<std::uint8_t> latest_power_command_{
       static_cast<std::uint8_t>(PowerCommand::None)};
-  mutable std::mutex snapshot_mutex_;
-  mutable std::mutex device_status_mutex_;
-  mutable std::mutex crane_state_mutex_;
+  mutable std::mutex lidar_measurement_mutex_;
   mutable std::mutex alert_message_mutex_;
   mutable std::mutex battery_button_signals_mutex_;
   mutable std::mutex output_mutex_;
@@ -330,12 +533,14 @@ class Interface {
     int bind_port = 0;
     int listen_fd = -1;
     std::vector<std::string> instance_ids;
-    std::thread accept_thread;
   };
   struct SpdLidarServerConnectionState {
     int conn_fd = -1;
     std::string peer_ip;
     int peer_port = 0;
+    bool awaiting_response = false;
+    std::chrono::steady_clock::time_point request_sent_at{};
+    std::uint8_t request_code = 0;
   };
   std::unordered_map<std::string, std::unique_ptr<spd_lidar::SpdLidarCore>> spd_lidar_instances_core_;
   std::unordered_set<std::string> spd_lidar_wait_logged_;
@@ -344,6 +549,10 @@ class Interface {
   std::unordered_map<std::string, SpdLidarServerConnectionState> spd_lidar_server_connections_;
   std::atomic<bool> spd_lidar_server_running_{false};
   mutable std::mutex spd_lidar_server_mutex_;
+  // 单个 epoll reactor 线程持有全部监听与连接 fd。
+  int spd_lidar_epoll_fd_ = -1;
+  int spd_lidar_wake_fd_ = -1;
+  std::thread spd_lidar_reactor_thread_;
 #endif
 
 #ifdef ASC_ENABLE_SPD_LIDAR
@@ -1,4 +1,5 @@
 #include "ai_safety_controller/devices_manager_client.hpp"
+#include "ai_safety_controller/common/async_log.hpp"
 #include "ai_safety_controller/interface.hpp"
 
 #include <algorithm>
@@ -8,35 +9,6 @@
 
 namespace ai_safety_controller {
 
-namespace {
-
-bool equalsBatteryInfo(const ai_safety_common::DeviceStatus::BatteryInfo& lhs,
-                       const ai_safety_common::DeviceStatus::BatteryInfo& rhs) {
-  return lhs.percent == rhs.percent &&
-         lhs.remainingMin == rhs.remainingMin &&
-         lhs.isCharging == rhs.isCharging &&
-         lhs.chargingTimeMin == rhs.chargingTimeMin &&
-         lhs.voltageV == rhs.voltageV &&
-         lhs.currentA == rhs.currentA;
-}
-
-bool equalsDeviceStatus(const ai_safety_common::DeviceStatus& lhs,
-                        const ai_safety_common::DeviceStatus& rhs) {
-  return lhs.solarCharge == rhs.solarCharge &&
-         lhs.trolleyState == rhs.trolleyState &&
-         equalsBatteryInfo(lhs.trolleyBattery, rhs.trolleyBattery) &&
-         lhs.hookState == rhs.hookState &&
-         equalsBatteryInfo(lhs.hookBattery, rhs.hookBattery);
-}
-
-bool equalsCraneState(const ai_safety_common::CraneState& lhs,
-                      const ai_safety_common::CraneState& rhs) {
-  return lhs.hookToTrolleyDistanceM == rhs.hookToTrolleyDistanceM &&
-         lhs.groundToTrolleyDistanceM == rhs.groundToTrolleyDistanceM;
-}
-
-}  // namespace
-
 DevicesManagerClient::DevicesManagerClient() : impl_(std::make_unique<Interface>()) {}
 
 DevicesManagerClient::~DevicesManagerClient() {
@@ -61,17 +33,32 @@ const char* DevicesManagerClient::toSpeakerCtlArg(SpeakerMode mode) {
 
 bool DevicesManagerClient::applySpeakerMode(SpeakerMode mode, bool quiet) {
   if (!impl_) return false;
+  collectSpeakerCommand();
   if (applied_speaker_mode_.has_value() && applied_speaker_mode_.value() == mode) return true;
+  // 上一条喇叭命令还在吊钩总线上：按失败处理，调用方稍后重试
+  if (speaker_command_.valid()) return false;
   std::vector<std::string> args{"speaker_ctl", toSpeakerCtlArg(mode)};
   if (quiet) args.push_back("quiet");
-  const Status ctl = impl_->dispatchCommand("hoist_hook", args);
-  if (ctl.ok) {
-    applied_speaker_mode_ = (mode == SpeakerMode::Off7MOnly || mode == SpeakerMode::Off3MOnly)
-                                ? SpeakerMode::Off
-                                : mode;
-    return true;
+  speaker_command_ = impl_->queryAsync("hoist_hook", args);
+  // 先按已生效记账，写失败时由 collectSpeakerCommand() 撤销，下一轮重发
+  applied_speaker_mode_ = (mode == SpeakerMode::Off7MOnly || mode == SpeakerMode::Off3MOnly)
+                              ? SpeakerMode::Off
+                              : mode;
+  return true;
+}
+
+void DevicesManagerClient::collectSpeakerCommand() {
+  if (!speaker_command_.valid()) return;
+  if (speaker_command_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+  const Status ctl = speaker_command_.get();
+  if (ctl.ok) return;
+  applied_speaker_mode_.reset();
+  // 双路轮播已按成功切到下一段：退回发命令前的阶段，200ms 内重发，不必等满整个播放窗口
+  if (both_round_robin_active_) {
+    both_stage_ = both_retry_stage_;
+    both_stage_deadline_ = std::min(both_stage_deadline_,
+                                    std::chrono::steady_clock::now() + std::chrono::milliseconds(200));
   }
-  return false;
 }
 
 void DevicesManagerClient::applySpeakerControlByAlert(const ai_safety_common::AlertMessage& alert) {
@@ -86,9 +73,11 @@ void DevicesManagerClient::applySpeakerControlByAlert(const ai_safety_common::Al
     if (!both_round_robin_active_) {
       both_round_robin_active_ = true;
       both_stage_ = BothSpeakerStage::Playing3M;
+      both_retry_stage_ = BothSpeakerStage::GapAfter7M;
       if (applySpeakerMode(SpeakerMode::M3, true)) {
         both_stage_deadline_ = now + both_play_window_;
       } else {
+        both_stage_ = BothSpeakerStage::GapAfter7M;
         both_stage_deadline_ = now + std::chrono::milliseconds(200);
       }
       return;
@@ -97,6 +86,7 @@ void DevicesManagerClient::applySpeakerControlByAlert(const ai_safety_common::Al
       return;
     }
 
+    both_retry_stage_ = both_stage_;
     switch (both_stage_) {
       case BothSpeakerStage::Playing3M:
         if (applySpeakerMode(SpeakerMode::Off, true)) {
@@ -168,18 +158,31 @@ void DevicesManagerClient::applyBatteryButtonControl(std::uint8_t raw_cmd, bool
 
   if (battery_button_relay_channels_.empty()) return;
 
-  bool all_ok = true;
+  if (!collectBatteryButtonCommand()) {
+    // 上一组继电器命令未完成；指令若已改变，清掉接收记录让下一轮重新下发
+    if (relay_command_target_ != cmd) last_received_battery_button_cmd_.reset();
+    return;
+  }
+  relay_command_target_ = cmd;
+  // 所有通道合成一条命令（"1,2,5"），由 io_relay 以 FC0F 批量写入并一次回读校验
+  std::string channels;
   for (size_t i = 0; i < battery_button_relay_channels_.size(); ++i) {
-    const std::vector<std::string> args{
-        (cmd == PowerCommand::PowerOn) ? "on" : "off",
-        std::to_string(battery_button_relay_channels_[i])};
-    const Status ctl = impl_->dispatchCommand("io_relay", args);
-    if (!ctl.ok) all_ok = false;
+    if (i > 0) channels += ",";
+    channels += std::to_string(battery_button_relay_channels_[i]);
   }
-  if (all_ok) {
-    impl_->setPowerCommand(cmd);
-    last_battery_button_cmd_ = cmd;
+  relay_command_ = impl_->queryAsync(
+      "io_relay", {(cmd == PowerCommand::PowerOn) ? "on" : "off", channels});
+}
+
+// 返回 true 表示没有未完成的继电器命令；完成时按结果更新电源指令。
+bool DevicesManagerClient::collectBatteryButtonCommand() {
+  if (!relay_command_.valid()) return true;
+  if (relay_command_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+  if (relay_command_.get().ok) {
+    impl_->setPowerCommand(relay_command_target_);
+    last_battery_button_cmd_ = relay_command_target_;
   }
+  return true;
 }
 
 bool DevicesManagerClient::isBatteryButtonCommandOutOfSync(PowerCommand expected_cmd) {
@@ -189,63 +192,67 @@ bool DevicesManagerClient::isBatteryButtonCommandOutOfSync(PowerCommand expected
   }
 
 #ifdef ASC_ENABLE_IO_RELAY
-  if (!battery_button_relay_channels_.empty()) {
-    io_relay::IoRelayCore* relay = impl_->ioRelay();
-    if (relay) {
-      bool any_on = false;
-      bool any_off = false;
-      for (size_t i = 0; i < battery_button_relay_channels_.size(); ++i) {
-        bool on = false;
-        if (!relay->getRelayState(battery_button_relay_channels_[i], &on)) {
-          return impl_->getPowerCommand() != expected_cmd;
-        }
-        any_on = any_on || on;
-        any_off = any_off || !on;
-      }
+  if (!battery_button_relay_channels_.empty() && impl_->hasIoRelay()) {
+    bool any_on = false;
+    bool any_off = false;
+    if (!readBatteryButtonRelays(relay_image_max_age_, &any_on, &any_off)) {
+      return impl_->getPowerCommand() != expected_cmd;
+    }
 
-      const PowerCommand actual_cmd = any_on ? PowerCommand::PowerOn : PowerCommand::PowerOff;
-      const bool mismatch = (actual_cmd != expected_cmd);
-      if (mismatch) {
-        const PowerCommand previous_cmd = impl_->getPowerCommand();
-        impl_->setPowerCommand(actual_cmd);
-        last_battery_button_cmd_ = actual_cmd;
-        if (previous_cmd != actual_cmd) {
-          std::cout << "[runtime] detect power state mismatch from relays: expected="
-                    << (expected_cmd == PowerCommand::PowerOn ? "on" : "off")
-                    << " actual=" << (actual_cmd == PowerCommand::PowerOn ? "on" : "off");
-          if (any_on && any_off) {
-            std::cout << " (partial relay state)";
-          }
-          std::cout << "\n";
-        }
+    const PowerCommand actual_cmd = any_on ? PowerCommand::PowerOn : PowerCommand::PowerOff;
+    const bool mismatch = (actual_cmd != expected_cmd);
+    if (mismatch) {
+      const PowerCommand previous_cmd = impl_->getPowerCommand();
+      impl_->setPowerCommand(actual_cmd);
+      last_battery_button_cmd_ = actual_cmd;
+      if (previous_cmd != actual_cmd) {
+        common::LogLine(common::LogLevel::Info, "runtime")
+            << "detect power state mismatch from relays: expected="
+            << (expected_cmd == PowerCommand::PowerOn ? "on" : "off")
+            << " actual=" << (actual_cmd == PowerCommand::PowerOn ? "on" : "off")
+            << ((any_on && any_off) ? " (partial relay state)" : "");
       }
-      return mismatch;
     }
+    return mismatch;
   }
 #endif
 
   return impl_->getPowerCommand() != expected_cmd;
 }
 
-void DevicesManagerClient::restoreBatteryButtonPowerStateFromRelays(bool log_output) {
+// 一次 FC01 读出 16 路输出映像，再按电池按钮通道 mask 判断；max_age 内复用缓存映像。
+bool DevicesManagerClient::readBatteryButtonRelays(std::chrono::milliseconds max_age,
+                                                   bool* any_on,
+                                                   bool* any_off) {
+#ifdef ASC_ENABLE_IO_RELAY
+  if (!impl_ || battery_button_relay_mask_ == 0) return false;
+  std::uint16_t image = 0;
+  if (!impl_->ioRelayImage(&image, max_age)) return false;
+  const std::uint16_t on_bits = static_cast<std::uint16_t>(image & battery_button_relay_mask_);
+  *any_on = on_bits != 0;
+  *any_off = on_bits != battery_button_relay_mask_;
+  return true;
+#else
+  (void)max_age;
+  (void)any_on;
+  (void)any_off;
+  return false;
+#endif
+}
+
+void DevicesManagerClient::restoreBatteryButtonPowerStateFromRelays(bool log_output,
+                                                                    std::chrono::milliseconds max_age) {
   if (!impl_ || battery_button_relay_channels_.empty()) return;
 #ifdef ASC_ENABLE_IO_RELAY
-  io_relay::IoRelayCore* relay = impl_->ioRelay();
-  if (!relay) return;
+  if (!impl_->hasIoRelay()) return;
 
   bool any_on = false;
   bool any_off = false;
-  for (size_t i = 0; i < battery_button_relay_channels_.size(); ++i) {
-    bool on = false;
-    const int ch = battery_button_relay_channels_[i];
-    if (!relay->getRelayState(ch, &on)) {
-      if (log_output) {
-        std::cout << "[startup] restore power state skipped: failed to read io_relay channel " << ch << "\n";
-      }
-      return;
+  if (!readBatteryButtonRelays(max_age, &any_on, &any_off)) {
+    if (log_output) {
+      std::cout << "[startup] restore power state skipped: failed to read io_relay channels\n";
     }
-    any_on = any_on || on;
-    any_off = any_off || !on;
+    return;
   }
 
   PowerCommand restored_cmd = PowerCommand::None;
@@ -273,19 +280,33 @@ void DevicesManagerClient::restoreBatteryButtonPowerStateFromRelays(bool log_out
     last_battery_button_cmd_.reset();
   }
   if (!log_output && previous_cmd != restored_cmd) {
-    std::cout << "[runtime] sync power state from relays: "
-              << (restored_cmd == PowerCommand::PowerOn ? "on" : "off") << "\n";
+    common::LogLine(common::LogLevel::Info, "runtime")
+        << "sync power state from relays: "
+        << (restored_cmd == PowerCommand::PowerOn ? "on" : "off");
   }
 #else
+  (void)max_age;
   impl_->setPowerCommand(PowerCommand::None);
 #endif
 }
 
 void DevicesManagerClient::notifyThreadFunc() {
+  if (!impl_) return;
+  common::ChangeNotifier& changes = impl_->stateChanges();
+  std::uint64_t seen_generation = changes.generation();
+  auto next_host_poll_ts = std::chrono::steady_clock::now();
   while (!notify_stop_) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // 阻塞等待状态变化；仅在轮询主工程信号、继电器同步或保活推送到期时定时唤醒。
+    const bool poll_host = !SignalGetAlertMessage.empty() || !SignalGetBatteryButtonSignals.empty();
+    auto wake_ts = std::min(next_relay_state_sync_ts_, last_push_ts_ + status_push_keepalive_interval_);
+    if (poll_host) wake_ts = std::min(wake_ts, next_host_poll_ts);
+    seen_generation = changes.waitUntil(seen_generation, wake_ts);
     if (notify_stop_) break;
-    if (impl_) {
+    collectSpeakerCommand();
+    (void)collectBatteryButtonCommand();
+
+    if (poll_host && std::chrono::steady_clock::now() >= next_host_poll_ts) {
+      next_host_poll_ts = std::chrono::steady_clock::now() + host_signal_poll_interval_;
       if (!SignalGetAlertMessage.empty()) {
         ai_safety_common::AlertMessage alert{};
         SignalGetAlertMessage(alert);
@@ -306,34 +327,39 @@ void DevicesManagerClient::notifyThreadFunc() {
           }
         }
       }
-      const auto now = std::chrono::steady_clock::now();
-      if (now >= next_relay_state_sync_ts_) {
-        restoreBatteryButtonPowerStateFromRelays(false);
-        next_relay_state_sync_ts_ = now + relay_state_sync_interval_;
-      }
-      const ai_safety_common::DeviceStatus device_status = getDeviceStatus();
-      const ai_safety_common::CraneState crane_state = getCraneState();
-      const bool device_status_changed =
-          !has_last_sent_device_status_ ||
-          !equalsDeviceStatus(last_sent_device_status_, device_status);
-      const bool crane_state_changed =
-          !has_last_sent_crane_state_ ||
-          !equalsCraneState(last_sent_crane_state_, crane_state);
-      const bool keepalive_due = (now - last_push_ts_) >= status_push_keepalive_interval_;
-
-      if (device_status_changed || keepalive_due) {
-        SignalSendDeviceStatus(device_status);
-        last_sent_device_status_ = device_status;
-        has_last_sent_device_status_ = true;
-      }
-      if (crane_state_changed || keepalive_due) {
-        SignalSendCraneState(crane_state);
-        last_sent_crane_state_ = crane_state;
-        has_last_sent_crane_state_ = true;
-      }
-      if (device_status_changed || crane_state_changed || keepalive_due) {
-        last_push_ts_ = now;
-      }
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const ai_safety_common::DeviceStatus device_status = getDeviceStatus();
+    const ai_safety_common::CraneState crane_state = getCraneState();
+    const bool device_status_changed =
+        !has_last_sent_device_status_ ||
+        !equalsDeviceStatus(last_sent_device_status_, device_status);
+    const bool crane_state_changed =
+        !has_last_sent_crane_state_ ||
+        !equalsCraneState(last_sent_crane_state_, crane_state);
+    const bool keepalive_due = (now - last_push_ts_) >= status_push_keepalive_interval_;
+
+    if (device_status_changed || keepalive_due) {
+      SignalSendDeviceStatus(device_status);
+      last_sent_device_status_ = device_status;
+      has_last_sent_device_status_ = true;
+    }
+    if (crane_state_changed || keepalive_due) {
+      SignalSendCraneState(crane_state);
+      last_sent_crane_state_ = crane_state;
+      has_last_sent_crane_state_ = true;
+    }
+    if (device_status_changed || crane_state_changed || keepalive_due) {
+      last_push_ts_ = now;
+    }
+    // 放在推送之后：继电器读取（首轮还可能等上电稳定窗口）不推迟状态推送。
+    // 首轮复用 Interface::init() 探测时读到的继电器映像。
+    if (now >= next_relay_state_sync_ts_) {
+      restoreBatteryButtonPowerStateFromRelays(
+          !relay_state_restored_,
+          relay_state_restored_ ? std::chrono::milliseconds(0) : relay_image_max_age_);
+      relay_state_restored_ = true;
+      next_relay_state_sync_ts_ = std::chrono::steady_clock::now() + relay_state_sync_interval_;
     }
   }
 }
@@ -356,8 +382,12 @@ Status DevicesManagerClient::start() {
   if (!s.ok) return s;
   started_ = true;
   applied_speaker_mode_.reset();
+  speaker_command_ = std::future<Status>();
+  relay_command_ = std::future<Status>();
+  relay_command_target_ = PowerCommand::None;
   both_round_robin_active_ = false;
   both_stage_ = BothSpeakerStage::Playing3M;
+  both_retry_stage_ = BothSpeakerStage::GapAfter7M;
   both_stage_deadline_ = std::chrono::steady_clock::now();
   // Clamp to sane bounds for reliable RTU/TCP device command pacing.
   const int play_window_ms = impl_->hoistHookDefaults().both_speaker_play_window_ms;
@@ -374,13 +404,18 @@ Status DevicesManagerClient::start() {
   battery_button_relay_channels_.erase(
       std::unique(battery_button_relay_channels_.begin(), battery_button_relay_channels_.end()),
       battery_button_relay_channels_.end());
+  battery_button_relay_mask_ = 0;
+  for (size_t i = 0; i < battery_button_relay_channels_.size(); ++i) {
+    battery_button_relay_mask_ =
+        static_cast<std::uint16_t>(battery_button_relay_mask_ | (1u << (battery_button_relay_channels_[i] - 1)));
+  }
   has_last_sent_device_status_ = false;
   has_last_sent_crane_state_ = false;
   last_battery_button_cmd_.reset();
   last_received_battery_button_cmd_.reset();
-  restoreBatteryButtonPowerStateFromRelays();
+  relay_state_restored_ = false;
   last_push_ts_ = std::chrono::steady_clock::now() - status_push_keepalive_interval_;
-  next_relay_state_sync_ts_ = std::chrono::steady_clock::now() + relay_state_sync_interval_;
+  next_relay_state_sync_ts_ = std::chrono::steady_clock::now();
   notify_stop_ = false;
   notify_thread_ = std::thread(&DevicesManagerClient::notifyThreadFunc, this);
   return s;
@@ -389,6 +424,7 @@ Status DevicesManagerClient::start() {
 Status DevicesManagerClient::stop() {
   if (!impl_) return Status{false, "no interface"};
   notify_stop_ = true;
+  impl_->stateChanges().notify();
   if (notify_thread_.joinable())
     notify_thread_.join();
   Status s = impl_->stop();
@@ -411,6 +447,16 @@ std::unordered_map<std::string, std::uint16_t> DevicesManagerClient::getLatestLi
   return impl_->getLatestLidarRawMm();
 }
 
+std::vector<common::TransactionSeriesSnapshot> DevicesManagerClient::getMetricsSnapshot() const {
+  if (!impl_) return {};
+  return impl_->metricsSnapshot();
+}
+
+std::vector<common::BusQueueSnapshot> DevicesManagerClient::getBusQueueSnapshot() const {
+  if (!impl_) return {};
+  return impl_->busQueueSnapshot();
+}
+
 bool DevicesManagerClient::isInitialized() const { return initialized_; }
 
 bool DevicesManagerClient::isStarted() const { return started_; }
@@ -1,10 +1,13 @@
 #include "ai_safety_controller/interface.hpp"
+#include "ai_safety_controller/common/async_log.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pipeline.hpp"
+#include "ai_safety_controller/common/query_result_format.hpp"
 
+#include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <regex>
 #include <sstream>
 #include <string>
 #include <algorithm>
@@ -12,6 +15,8 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <limits>
+#include <shared_mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -19,7 +24,15 @@
 #include <cstring>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -28,6 +41,83 @@ namespace ai_safety_controller {
 namespace {
 const char* kSpdLidarVerticalAngleToVerticalKey = "vertical_angle_to_vertical_deg";
 
+// 配置二进制缓存：魔数 + 源文件 size/mtime + JsonValue::serialize() 的结果。
+// 源文件大小或修改时间变化即视为失效，重新解析 JSON 并覆盖缓存。
+constexpr char kConfigCacheMagic[8] = {'A', 'S', 'C', 'C', 'F', 'G', '0', '1'};
+
+struct ConfigSourceStamp {
+  std::uint64_t size = 0;
+  std::int64_t mtime_ns = 0;
+};
+
+bool statConfigSource(const std::string& path, ConfigSourceStamp* stamp) {
+  struct stat st {};
+  if (::stat(path.c_str(), &st) != 0) return false;
+  stamp->size = static_cast<std::uint64_t>(st.st_size);
+  stamp->mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+  return true;
+}
+
+// init() 与 start() 合计等待驱动拉起的时限；未完成的驱动在后台继续。
+std::chrono::milliseconds startupBudget() {
+  const char* env = std::getenv("ASC_STARTUP_DEADLINE_MS");
+  if (!env || env[0] == '\0') return std::chrono::milliseconds(800);
+  char* end = nullptr;
+  const long ms = std::strtol(env, &end, 10);
+  if (!end || *end != '\0' || ms < 0) return std::chrono::milliseconds(800);
+  return std::chrono::milliseconds(ms);
+}
+
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point started) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                               started);
+}
+
+// start() 在 init() 已用完时限后仍给启动步骤的最短等待，够本地线程 / 监听端口就绪。
+constexpr std::chrono::milliseconds kStartupGrace(100);
+
+std::string configCachePath(const std::string& config_path) {
+  const char* env = std::getenv("ASC_CONFIG_CACHE");
+  if (!env || env[0] == '\0' || std::string(env) == "0") return "";
+  if (std::string(env) == "1") return config_path + ".cache";
+  return env;
+}
+
+bool readConfigCache(const std::string& cache_path,
+                     const ConfigSourceStamp& stamp,
+                     common::JsonValue* root) {
+  std::ifstream ifs(cache_path, std::ios::binary);
+  if (!ifs.is_open()) return false;
+  const std::string blob((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  const size_t header_size = sizeof(kConfigCacheMagic) + sizeof(stamp.size) + sizeof(stamp.mtime_ns);
+  if (blob.size() < header_size) return false;
+  if (std::memcmp(blob.data(), kConfigCacheMagic, sizeof(kConfigCacheMagic)) != 0) return false;
+  ConfigSourceStamp cached;
+  std::memcpy(&cached.size, blob.data() + sizeof(kConfigCacheMagic), sizeof(cached.size));
+  std::memcpy(&cached.mtime_ns, blob.data() + sizeof(kConfigCacheMagic) + sizeof(cached.size),
+              sizeof(cached.mtime_ns));
+  if (cached.size != stamp.size || cached.mtime_ns != stamp.mtime_ns) return false;
+  return common::JsonValue::deserialize(blob.data() + header_size, blob.size() - header_size, root);
+}
+
+void writeConfigCache(const std::string& cache_path,
+                      const ConfigSourceStamp& stamp,
+                      const common::JsonValue& root) {
+  std::string blob(kConfigCacheMagic, sizeof(kConfigCacheMagic));
+  blob.append(reinterpret_cast<const char*>(&stamp.size), sizeof(stamp.size));
+  blob.append(reinterpret_cast<const char*>(&stamp.mtime_ns), sizeof(stamp.mtime_ns));
+  root.serialize(&blob);
+  // 先写临时文件再 rename，避免并发启动读到半截缓存。
+  const std::string tmp_path = cache_path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) return;
+    ofs.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    if (!ofs) return;
+  }
+  if (std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) std::remove(tmp_path.c_str());
+}
+
 std::string joinArgs(const std::vector<std::string>& args, size_t start) {
   std::ostringstream oss;
   for (size_t i = start; i < args.size(); ++i) {
@@ -59,10 +149,21 @@ std::string formatHexBytes(const std::vector<uint8_t>& data) {
   return oss.str();
 }
 
+// Lidar frames are 55 AA <cmd> ...; the command byte plays the role of the
+// Modbus function code in the metrics registry.
+std::uint8_t spdLidarCommandCode(const std::vector<uint8_t>& request) {
+  return request.size() > 2 ? request[2] : 0;
+}
+
+std::string spdLidarMetricsEndpoint(const std::string& id) {
+  return "spd_lidar:" + id;
+}
+
 bool spdLidarExchangeOnConnectedFd(int fd,
                                    const std::vector<uint8_t>& request,
                                    std::vector<uint8_t>* response,
-                                   std::string* error) {
+                                   std::string* error,
+                                   common::TransactionProbe* probe) {
   if (!response) return false;
   response->clear();
 
@@ -72,6 +173,7 @@ bool spdLidarExchangeOnConnectedFd(int fd,
   ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
   ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 
+  probe->beginExchange();
   const ssize_t sent = ::send(fd, request.data(), request.size(), 0);
   if (sent < 0 || static_cast<size_t>(sent) != request.size()) {
     if (error) *error = std::string("send failed: ") + std::strerror(errno);
@@ -81,13 +183,22 @@ bool spdLidarExchangeOnConnectedFd(int fd,
   uint8_t buf[256];
   const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
   if (n <= 0) {
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) probe->timeout();
+    probe->sent(request.size());
     if (error) *error = std::string("recv failed: ") + std::strerror(errno);
     return false;
   }
   response->assign(buf, buf + n);
+  probe->endExchange(request.size(), static_cast<size_t>(n));
   return true;
 }
 
+bool setFdNonBlocking(int fd) {
+  const int flags = ::fcntl(fd, F_GETFL, 0);
+  if (flags < 0) return false;
+  return ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
 std::string sockaddrIp(const sockaddr_in& addr) {
   char buf[INET_ADDRSTRLEN] = {0};
   if (::inet_ntop(AF_INET, &addr.sin_addr, buf, sizeof(buf)) == nullptr) {
@@ -96,6 +207,29 @@ std::string sockaddrIp(const sockaddr_in& addr) {
   return std::string(buf);
 }
 
+template <typename DriverRetryPolicy>
+DriverRetryPolicy toDriverRetryPolicy(const Interface::RetryPolicy& policy) {
+  return DriverRetryPolicy{policy.max_retries,
+                           policy.base_backoff_ms,
+                           policy.max_backoff_ms,
+                           policy.jitter_ms,
+                           policy.log_enabled};
+}
+
+bool sameRetryPolicy(const Interface::RetryPolicy& a, const Interface::RetryPolicy& b) {
+  return a.max_retries == b.max_retries && a.base_backoff_ms == b.base_backoff_ms &&
+         a.max_backoff_ms == b.max_backoff_ms && a.jitter_ms == b.jitter_ms &&
+         a.log_enabled == b.log_enabled;
+}
+
+bool sameSpdLidarInstance(const Interface::SpdLidarInstanceDefaults& a,
+                          const Interface::SpdLidarInstanceDefaults& b) {
+  return a.id == b.id && a.enable == b.enable && a.mode == b.mode && a.local_ip == b.local_ip &&
+         a.local_port == b.local_port && a.device_ip == b.device_ip &&
+         a.device_port == b.device_port && a.role == b.role &&
+         a.vertical_angle_to_vertical_deg == b.vertical_angle_to_vertical_deg;
+}
+
 int createSpdLidarListenSocket(const std::string& bind_ip,
                                int bind_port,
                                std::string* actual_bind_ip,
@@ -131,8 +265,9 @@ int createSpdLidarListenSocket(const std::string& bind_ip,
         return -1;
       }
       if (actual_bind_ip) *actual_bind_ip = "0.0.0.0";
-      std::cout << "[spd_lidar] warning: local_ip " << bind_ip
-                << " not present on host, fallback bind 0.0.0.0:" << bind_port << "\n";
+      common::LogLine(common::LogLevel::Warn, "spd_lidar")
+          << "warning: local_ip " << bind_ip
+          << " not present on host, fallback bind 0.0.0.0:" << bind_port;
     } else {
       if (error) *error = std::string("bind failed: ") + std::strerror(errno);
       ::close(listen_fd);
@@ -150,6 +285,16 @@ int createSpdLidarListenSocket(const std::string& bind_ip,
   return listen_fd;
 }
 
+// "modbus:<ip>:<port>" / "serial:<device>" lane -> GatewayScheduler key; other lanes are not buses.
+std::string busSchedulerKey(const std::string& lane) {
+  static const char* const kPrefixes[] = {"modbus:", "serial:"};
+  for (const char* prefix : kPrefixes) {
+    const std::string p(prefix);
+    if (lane.compare(0, p.size(), p) == 0) return lane.substr(p.size());
+  }
+  return std::string();
+}
+
 class FunctionDriverAdapter : public DriverAdapter {
  public:
   using StatusFn = std::function<Status()>;
@@ -196,15 +341,18 @@ Interface::Interface()
       started_(false),
       config_loaded_(false),
       spd_lidar_query_hz_(0.0),
-      auto_query_running_(false),
       snapshot_printer_running_(false)
 #ifdef ASC_ENABLE_SPD_LIDAR
       ,
       trolley_lidar_has_valid_frame_(false)
 #endif
-{}
+{
+  bus_lanes_ = buildBusLanes(currentDefaults());
+}
 
 Interface::~Interface() {
+  command_executor_.stop();
+  stopConfigWatch();
   stopAutoQueryPolling();
   stopSnapshotPrinter();
   if (started_) {
@@ -279,18 +427,24 @@ const std::vector<Interface::SpdLidarInstanceDefaults>& Interface::spdLidarInsta
   return spd_lidar_instances_;
 }
 
+const std::vector<Interface::ModbusGatewayDefaults>& Interface::modbusGateways() const {
+  return modbus_gateways_;
+}
+
 double Interface::spdLidarQueryHz() const {
   return spd_lidar_query_hz_;
 }
 
 void Interface::setDeviceStatus(const DeviceStatus& data) {
-  std::lock_guard<std::mutex> lock(device_status_mutex_);
-  latest_device_status_ = data;
+  if (device_status_.store(data)) state_changes_.notify();
+}
+
+void Interface::mergeDeviceStatus(const std::function<void(DeviceStatus*)>& apply) {
+  if (device_status_.update(apply)) state_changes_.notify();
 }
 
 DeviceStatus Interface::getDeviceStatus() const {
-  std::lock_guard<std::mutex> lock(device_status_mutex_);
-  return latest_device_status_;
+  return device_status_.load();
 }
 
 void Interface::setPowerCommand(PowerCommand cmd) {
@@ -306,32 +460,38 @@ PowerCommand Interface::getPowerCommand() const {
 }
 
 CraneState Interface::getCraneState() const {
-  std::lock_guard<std::mutex> lock(crane_state_mutex_);
-  return latest_crane_state_;
+  return crane_state_.load();
 }
 
 std::unordered_map<std::string, std::uint16_t> Interface::getLatestLidarRawMm() const {
-  std::lock_guard<std::mutex> lock(crane_state_mutex_);
+  std::lock_guard<std::mutex> lock(lidar_measurement_mutex_);
   return latest_lidar_raw_mm_;
 }
 
 void Interface::setCraneState(const CraneState& data) {
-  std::lock_guard<std::mutex> lock(crane_state_mutex_);
-  latest_crane_state_ = data;
+  if (crane_state_.store(data)) state_changes_.notify();
+}
+
+void Interface::mergeCraneState(const std::function<void(CraneState*)>& apply) {
+  if (crane_state_.update(apply)) state_changes_.notify();
+}
+
+common::ChangeNotifier& Interface::stateChanges() {
+  return state_changes_;
 }
 
 void Interface::updateCraneStateFromEncoder(double turns_value) {
   // Normalized value placeholder: current integration maps encoder turns 1:1 to meters.
   const double normalized_m = std::max(0.0, turns_value);
-  CraneState crane = getCraneState();
-  crane.hookToTrolleyDistanceM = static_cast<float>(normalized_m);
-  setCraneState(crane);
+  mergeCraneState([&](CraneState* crane) {
+    crane->hookToTrolleyDistanceM = static_cast<float>(normalized_m);
+  });
 }
 
 void Interface::updateCraneStateFromLidarMeasurement(const std::string& id,
                                                      std::uint16_t raw_mm,
                                                      double projected_distance_m) {
-  std::lock_guard<std::mutex> lock(crane_state_mutex_);
+  std::lock_guard<std::mutex> lock(lidar_measurement_mutex_);
   latest_lidar_raw_mm_[id] = raw_mm;
   latest_lidar_projected_distance_m_[id] = std::max(0.0, projected_distance_m);
   if (latest_lidar_projected_distance_m_.empty()) return;
@@ -341,7 +501,9 @@ void Interface::updateCraneStateFromLidarMeasurement(const std::string& id,
     sum += kv.second;
   }
   const double avg = sum / static_cast<double>(latest_lidar_projected_distance_m_.size());
-  latest_crane_state_.groundToTrolleyDistanceM = static_cast<float>(avg);
+  mergeCraneState([&](CraneState* crane) {
+    crane->groundToTrolleyDistanceM = static_cast<float>(avg);
+  });
 }
 
 AlertMessage Interface::getAlertMessage() const {
@@ -354,216 +516,176 @@ std::uint8_t Interface::getBatteryButtonSignals() const {
   return latest_battery_button_signals_;
 }
 
-std::string Interface::extractObjectBody(const std::string& json_text, const std::string& key) {
-  const std::string marker = "\"" + key + "\"";
-  const size_t key_pos = json_text.find(marker);
-  if (key_pos == std::string::npos) return "";
-
-  const size_t brace_pos = json_text.find('{', key_pos);
-  if (brace_pos == std::string::npos) return "";
-
-  int depth = 0;
-  for (size_t i = brace_pos; i < json_text.size(); ++i) {
-    if (json_text[i] == '{') ++depth;
-    else if (json_text[i] == '}') --depth;
-    if (depth == 0) {
-      return json_text.substr(brace_pos + 1, i - brace_pos - 1);
-    }
-  }
-  return "";
+bool Interface::extractStringValue(const common::JsonValue* object, const std::string& key, std::string* out) {
+  if (!object || !out) return false;
+  const common::JsonValue* v = object->find(key);
+  if (!v || !v->isString()) return false;
+  *out = v->asString();
+  return true;
 }
 
-std::string Interface::extractArrayBody(const std::string& json_text, const std::string& key) {
-  const std::string marker = "\"" + key + "\"";
-  const size_t key_pos = json_text.find(marker);
-  if (key_pos == std::string::npos) return "";
-
-  const size_t bracket_pos = json_text.find('[', key_pos);
-  if (bracket_pos == std::string::npos) return "";
-
-  int depth = 0;
-  for (size_t i = bracket_pos; i < json_text.size(); ++i) {
-    if (json_text[i] == '[') ++depth;
-    else if (json_text[i] == ']') --depth;
-    if (depth == 0) {
-      return json_text.substr(bracket_pos + 1, i - bracket_pos - 1);
-    }
+bool Interface::extractIntValue(const common::JsonValue* object, const std::string& key, int* out) {
+  if (!object || !out) return false;
+  const common::JsonValue* v = object->find(key);
+  if (!v || !v->isNumber()) return false;
+  const double n = v->asNumber();
+  if (n < static_cast<double>(std::numeric_limits<int>::min()) ||
+      n > static_cast<double>(std::numeric_limits<int>::max())) {
+    return false;
   }
-  return "";
-}
-
-std::vector<std::string> Interface::splitTopLevelObjects(const std::string& array_body) {
-  std::vector<std::string> out;
-  int depth = 0;
-  size_t start = std::string::npos;
-  for (size_t i = 0; i < array_body.size(); ++i) {
-    const char ch = array_body[i];
-    if (ch == '{') {
-      if (depth == 0) start = i;
-      ++depth;
-    } else if (ch == '}') {
-      --depth;
-      if (depth == 0 && start != std::string::npos) {
-        out.push_back(array_body.substr(start + 1, i - start - 1));
-        start = std::string::npos;
-      }
-    }
+  // 整数字段写成小数时不截断，按未配置处理
+  if (n != std::trunc(n)) {
+    common::LogLine(common::LogLevel::Warn, "config") << "⚠️ " << key << " 不是整数，忽略: " << n;
+    return false;
   }
-  return out;
-}
-
-bool Interface::extractStringValue(const std::string& object_body, const std::string& key, std::string* out) {
-  if (!out) return false;
-  const std::regex re("\"" + key + "\"\\s*:\\s*\"([^\"]*)\"");
-  std::smatch m;
-  if (!std::regex_search(object_body, m, re)) return false;
-  *out = m[1].str();
+  *out = static_cast<int>(n);
   return true;
 }
 
-bool Interface::extractIntValue(const std::string& object_body, const std::string& key, int* out) {
-  if (!out) return false;
-  const std::regex re("\"" + key + "\"\\s*:\\s*(-?[0-9]+)");
-  std::smatch m;
-  if (!std::regex_search(object_body, m, re)) return false;
-  return parseInt(m[1].str(), out);
-}
-
-bool Interface::extractIntArrayValue(const std::string& object_body,
+bool Interface::extractIntArrayValue(const common::JsonValue* object,
                                      const std::string& key,
                                      std::vector<int>* out) {
-  if (!out) return false;
-  const std::regex re("\"" + key + "\"\\s*:\\s*\\[([^\\]]*)\\]");
-  std::smatch m;
-  if (!std::regex_search(object_body, m, re)) return false;
+  if (!object || !out) return false;
+  const common::JsonValue* arr = object->findArray(key);
+  if (!arr) return false;
   out->clear();
-  const std::string items = m[1].str();
-  const std::regex item_re("-?[0-9]+");
-  for (std::sregex_iterator it(items.begin(), items.end(), item_re), end; it != end; ++it) {
-    int value = 0;
-    if (parseInt(it->str(), &value)) out->push_back(value);
+  for (size_t i = 0; i < arr->size(); ++i) {
+    const common::JsonValue& item = arr->at(i);
+    if (item.isNumber() && item.asNumber() == std::trunc(item.asNumber())) {
+      out->push_back(static_cast<int>(item.asNumber()));
+    }
   }
   return true;
 }
 
-bool Interface::extractBoolValue(const std::string& object_body, const std::string& key, bool* out) {
-  if (!out) return false;
-  const std::regex re("\"" + key + "\"\\s*:\\s*(true|false|1|0)");
-  std::smatch m;
-  if (!std::regex_search(object_body, m, re)) return false;
-  return parseBool(m[1].str(), out);
+bool Interface::extractBoolValue(const common::JsonValue* object, const std::string& key, bool* out) {
+  if (!object || !out) return false;
+  const common::JsonValue* v = object->find(key);
+  if (!v) return false;
+  if (v->isBool()) {
+    *out = v->asBool();
+    return true;
+  }
+  // 兼容旧配置里的 0 / 1
+  if (v->isNumber() && (v->asNumber() == 0.0 || v->asNumber() == 1.0)) {
+    *out = v->asNumber() != 0.0;
+    return true;
+  }
+  return false;
 }
 
-bool Interface::extractDoubleValue(const std::string& object_body, const std::string& key, double* out) {
-  if (!out) return false;
-  const std::regex re("\"" + key + "\"\\s*:\\s*(-?(?:[0-9]+(?:\\.[0-9]+)?|\\.[0-9]+))");
-  std::smatch m;
-  if (!std::regex_search(object_body, m, re)) return false;
-  return parseDouble(m[1].str(), out);
+bool Interface::extractDoubleValue(const common::JsonValue* object, const std::string& key, double* out) {
+  if (!object || !out) return false;
+  const common::JsonValue* v = object->find(key);
+  if (!v || !v->isNumber()) return false;
+  *out = v->asNumber();
+  return true;
 }
 
-void Interface::applyBatteryDefaultsFromJson(const std::string& json_text) {
-  const std::string runtime_body = extractObjectBody(json_text, "runtime");
-  if (runtime_body.empty()) return;
-  const std::string body = extractObjectBody(runtime_body, "battery");
-  if (body.empty()) return;
+void Interface::applyBatteryDefaultsFromJson(const common::JsonValue& runtime, BatteryDefaults* out) {
+  const common::JsonValue* body = runtime.findObject("battery");
+  if (!body) return;
 
   bool enable = true;
-  if (extractBoolValue(body, "enable", &enable)) battery_defaults_.enable = enable;
+  if (extractBoolValue(body, "enable", &enable)) out->enable = enable;
   std::string module_ip;
-  if (extractStringValue(body, "module_ip", &module_ip)) battery_defaults_.module_ip = module_ip;
+  if (extractStringValue(body, "module_ip", &module_ip)) out->module_ip = module_ip;
   int module_port = 0;
-  if (extractIntValue(body, "module_port", &module_port)) battery_defaults_.module_port = module_port;
+  if (extractIntValue(body, "module_port", &module_port)) out->module_port = module_port;
   int module_slave_id = 0;
-  if (extractIntValue(body, "module_slave_id", &module_slave_id)) battery_defaults_.module_slave_id = module_slave_id;
+  if (extractIntValue(body, "module_slave_id", &module_slave_id)) out->module_slave_id = module_slave_id;
   int battery_slave_id = 0;
-  if (extractIntValue(body, "battery_slave_id", &battery_slave_id)) battery_defaults_.battery_slave_id = battery_slave_id;
+  if (extractIntValue(body, "battery_slave_id", &battery_slave_id)) out->battery_slave_id = battery_slave_id;
   bool charge_time_debug = false;
   if (extractBoolValue(body, "charge_time_debug", &charge_time_debug)) {
-    battery_defaults_.charge_time_debug = charge_time_debug;
+    out->charge_time_debug = charge_time_debug;
+  }
+  int battery_read_gap_tolerance = 0;
+  if (extractIntValue(body, "read_gap_tolerance", &battery_read_gap_tolerance)) {
+    out->read_gap_tolerance = std::min(std::max(battery_read_gap_tolerance, 0), 64);
   }
   double query_hz = 0.0;
-  if (extractDoubleValue(body, "query_hz", &query_hz)) battery_defaults_.query_hz = query_hz;
-  const std::string retry_body = extractObjectBody(body, "retry");
-  if (!retry_body.empty()) {
+  if (extractDoubleValue(body, "query_hz", &query_hz)) out->query_hz = query_hz;
+  const common::JsonValue* retry_body = body->findObject("retry");
+  if (retry_body) {
     int max_retries = 0;
     if (extractIntValue(retry_body, "max_retries", &max_retries))
-      battery_defaults_.retry_policy.max_retries = std::max(0, max_retries);
+      out->retry_policy.max_retries = std::max(0, max_retries);
     int base_backoff_ms = 0;
     if (extractIntValue(retry_body, "base_backoff_ms", &base_backoff_ms))
-      battery_defaults_.retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
+      out->retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
     int max_backoff_ms = 0;
     if (extractIntValue(retry_body, "max_backoff_ms", &max_backoff_ms))
-      battery_defaults_.retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
+      out->retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
     int jitter_ms = 0;
     if (extractIntValue(retry_body, "jitter_ms", &jitter_ms))
-      battery_defaults_.retry_policy.jitter_ms = std::max(0, jitter_ms);
+      out->retry_policy.jitter_ms = std::max(0, jitter_ms);
     bool retry_log_enabled = true;
     if (extractBoolValue(retry_body, "log_enabled", &retry_log_enabled))
-      battery_defaults_.retry_policy.log_enabled = retry_log_enabled;
+      out->retry_policy.log_enabled = retry_log_enabled;
   }
 }
 
-void Interface::applySolarDefaultsFromJson(const std::string& json_text) {
-  const std::string runtime_body = extractObjectBody(json_text, "runtime");
-  if (runtime_body.empty()) return;
-  const std::string body = extractObjectBody(runtime_body, "solar");
-  if (body.empty()) return;
+void Interface::applySolarDefaultsFromJson(const common::JsonValue& runtime, SolarDefaults* out) {
+  const common::JsonValue* body = runtime.findObject("solar");
+  if (!body) return;
 
   bool enable = true;
-  if (extractBoolValue(body, "enable", &enable)) solar_defaults_.enable = enable;
+  if (extractBoolValue(body, "enable", &enable)) out->enable = enable;
   std::string module_ip;
-  if (extractStringValue(body, "module_ip", &module_ip)) solar_defaults_.module_ip = module_ip;
+  if (extractStringValue(body, "module_ip", &module_ip)) out->module_ip = module_ip;
   int module_port = 0;
-  if (extractIntValue(body, "module_port", &module_port)) solar_defaults_.module_port = module_port;
+  if (extractIntValue(body, "module_port", &module_port)) out->module_port = module_port;
   int module_slave_id = 0;
-  if (extractIntValue(body, "module_slave_id", &module_slave_id)) solar_defaults_.module_slave_id = module_slave_id;
+  if (extractIntValue(body, "module_slave_id", &module_slave_id)) out->module_slave_id = module_slave_id;
   int solar_slave_id = 0;
-  if (extractIntValue(body, "solar_slave_id", &solar_slave_id)) solar_defaults_.solar_slave_id = solar_slave_id;
+  if (extractIntValue(body, "solar_slave_id", &solar_slave_id)) out->solar_slave_id = solar_slave_id;
   double sample_timeout_sec = 0.0;
   if (extractDoubleValue(body, "sample_timeout_sec", &sample_timeout_sec)) {
-    solar_defaults_.sample_timeout_sec = std::min(std::max(sample_timeout_sec, 0.1), 10.0);
+    out->sample_timeout_sec = std::min(std::max(sample_timeout_sec, 0.1), 10.0);
   }
   int stale_timeout_ms = 0;
   if (extractIntValue(body, "stale_timeout_ms", &stale_timeout_ms)) {
-    solar_defaults_.stale_timeout_ms = std::max(100, stale_timeout_ms);
+    out->stale_timeout_ms = std::max(100, stale_timeout_ms);
+  }
+  int solar_read_gap_tolerance = 0;
+  if (extractIntValue(body, "read_gap_tolerance", &solar_read_gap_tolerance)) {
+    out->read_gap_tolerance = std::min(std::max(solar_read_gap_tolerance, 0), 64);
   }
   double query_hz = 0.0;
-  if (extractDoubleValue(body, "query_hz", &query_hz)) solar_defaults_.query_hz = query_hz;
-  const std::string retry_body = extractObjectBody(body, "retry");
-  if (!retry_body.empty()) {
+  if (extractDoubleValue(body, "query_hz", &query_hz)) out->query_hz = query_hz;
+  const common::JsonValue* retry_body = body->findObject("retry");
+  if (retry_body) {
     int max_retries = 0;
     if (extractIntValue(retry_body, "max_retries", &max_retries))
-      solar_defaults_.retry_policy.max_retries = std::max(0, max_retries);
+      out->retry_policy.max_retries = std::max(0, max_retries);
     int base_backoff_ms = 0;
     if (extractIntValue(retry_body, "base_backoff_ms", &base_backoff_ms))
-      solar_defaults_.retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
+      out->retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
     int max_backoff_ms = 0;
     if (extractIntValue(retry_body, "max_backoff_ms", &max_backoff_ms))
-      solar_defaults_.retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
+      out->retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
     int jitter_ms = 0;
     if (extractIntValue(retry_body, "jitter_ms", &jitter_ms))
-      solar_defaults_.retry_policy.jitter_ms = std::max(0, jitter_ms);
+      out->retry_policy.jitter_ms = std::max(0, jitter_ms);
     bool retry_log_enabled = true;
     if (extractBoolValue(retry_body, "log_enabled", &retry_log_enabled))
-      solar_defaults_.retry_policy.log_enabled = retry_log_enabled;
+      out->retry_policy.log_enabled = retry_log_enabled;
   }
 }
 
-void Interface::applyIoRelayDefaultsFromJson(const std::string& json_text) {
-  const std::string runtime_body = extractObjectBody(json_text, "runtime");
-  if (runtime_body.empty()) return;
-  const std::string body = extractObjectBody(runtime_body, "io_relay");
-  if (body.empty()) return;
+void Interface::applyIoRelayDefaultsFromJson(const common::JsonValue& runtime, IoRelayDefaults* out) {
+  const common::JsonValue* body = runtime.findObject("io_relay");
+  if (!body) return;
 
   bool enable = true;
-  if (extractBoolValue(body, "enable", &enable)) io_relay_defaults_.enable = enable;
+  if (extractBoolValue(body, "enable", &enable)) out->enable = enable;
   std::string module_ip;
-  if (extractStringValue(body, "module_ip", &module_ip)) io_relay_defaults_.module_ip = module_ip;
+  if (extractStringValue(body, "module_ip", &module_ip)) out->module_ip = module_ip;
   int module_port = 0;
-  if (extractIntValue(body, "module_port", &module_port)) io_relay_defaults_.module_port = module_port;
+  if (extractIntValue(body, "module_port", &module_port)) out->module_port = module_port;
   int module_slave_id = 0;
-  if (extractIntValue(body, "module_slave_id", &module_slave_id)) io_relay_defaults_.module_slave_id = module_slave_id;
+  if (extractIntValue(body, "module_slave_id", &module_slave_id)) out->module_slave_id = module_slave_id;
   std::vector<int> battery_button_relay_channels;
   if (extractIntArrayValue(body, "battery_button_relay_channels", &battery_button_relay_channels)) {
     std::vector<int> channels_filtered;
@@ -575,206 +697,228 @@ void Interface::applyIoRelayDefaultsFromJson(const std::string& json_text) {
     std::sort(channels_filtered.begin(), channels_filtered.end());
     channels_filtered.erase(std::unique(channels_filtered.begin(), channels_filtered.end()),
                            channels_filtered.end());
-    io_relay_defaults_.battery_button_relay_channels = channels_filtered;
+    out->battery_button_relay_channels = channels_filtered;
   }
   double query_hz = 0.0;
-  if (extractDoubleValue(body, "query_hz", &query_hz)) io_relay_defaults_.query_hz = query_hz;
-  const std::string retry_body = extractObjectBody(body, "retry");
-  if (!retry_body.empty()) {
+  if (extractDoubleValue(body, "query_hz", &query_hz)) out->query_hz = query_hz;
+  const common::JsonValue* retry_body = body->findObject("retry");
+  if (retry_body) {
     int max_retries = 0;
     if (extractIntValue(retry_body, "max_retries", &max_retries))
-      io_relay_defaults_.retry_policy.max_retries = std::max(0, max_retries);
+      out->retry_policy.max_retries = std::max(0, max_retries);
     int base_backoff_ms = 0;
     if (extractIntValue(retry_body, "base_backoff_ms", &base_backoff_ms))
-      io_relay_defaults_.retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
+      out->retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
     int max_backoff_ms = 0;
     if (extractIntValue(retry_body, "max_backoff_ms", &max_backoff_ms))
-      io_relay_defaults_.retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
+      out->retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
     int jitter_ms = 0;
     if (extractIntValue(retry_body, "jitter_ms", &jitter_ms))
-      io_relay_defaults_.retry_policy.jitter_ms = std::max(0, jitter_ms);
+      out->retry_policy.jitter_ms = std::max(0, jitter_ms);
     bool retry_log_enabled = true;
     if (extractBoolValue(retry_body, "log_enabled", &retry_log_enabled))
-      io_relay_defaults_.retry_policy.log_enabled = retry_log_enabled;
+      out->retry_policy.log_enabled = retry_log_enabled;
   }
 }
 
-void Interface::applyHoistHookDefaultsFromJson(const std::string& json_text) {
-  const std::string runtime_body = extractObjectBody(json_text, "runtime");
-  if (runtime_body.empty()) return;
-  const std::string body = extractObjectBody(runtime_body, "hoist_hook");
-  if (body.empty()) return;
+void Interface::applyHoistHookDefaultsFromJson(const common::JsonValue& runtime, HoistHookDefaults* out) {
+  const common::JsonValue* body = runtime.findObject("hoist_hook");
+  if (!body) return;
 
   bool enable = true;
-  if (extractBoolValue(body, "enable", &enable)) hoist_hook_defaults_.enable = enable;
+  if (extractBoolValue(body, "enable", &enable)) out->enable = enable;
   std::string transport;
-  if (extractStringValue(body, "transport", &transport)) hoist_hook_defaults_.transport = transport;
+  if (extractStringValue(body, "transport", &transport)) out->transport = transport;
   std::string module_ip;
-  if (extractStringValue(body, "module_ip", &module_ip)) hoist_hook_defaults_.module_ip = module_ip;
+  if (extractStringValue(body, "module_ip", &module_ip)) out->module_ip = module_ip;
   int module_port = 0;
-  if (extractIntValue(body, "module_port", &module_port)) hoist_hook_defaults_.module_port = module_port;
+  if (extractIntValue(body, "module_port", &module_port)) out->module_port = module_port;
   std::string device;
-  if (extractStringValue(body, "device", &device)) hoist_hook_defaults_.device = device;
+  if (extractStringValue(body, "device", &device)) out->device = device;
   int baud = 0;
-  if (extractIntValue(body, "baud", &baud)) hoist_hook_defaults_.baud = baud;
+  if (extractIntValue(body, "baud", &baud)) out->baud = baud;
   std::string parity_str;
   if (extractStringValue(body, "parity", &parity_str) && !parity_str.empty())
-    hoist_hook_defaults_.parity = parity_str[0];
+    out->parity = parity_str[0];
   int data_bit = 0;
-  if (extractIntValue(body, "data_bit", &data_bit)) hoist_hook_defaults_.data_bit = data_bit;
+  if (extractIntValue(body, "data_bit", &data_bit)) out->data_bit = data_bit;
   int stop_bit = 0;
-  if (extractIntValue(body, "stop_bit", &stop_bit)) hoist_hook_defaults_.stop_bit = stop_bit;
+  if (extractIntValue(body, "stop_bit", &stop_bit)) out->stop_bit = stop_bit;
   int hook_slave_id = 0;
-  if (extractIntValue(body, "hook_slave_id", &hook_slave_id)) hoist_hook_defaults_.hook_slave_id = hook_slave_id;
+  if (extractIntValue(body, "hook_slave_id", &hook_slave_id)) out->hook_slave_id = hook_slave_id;
   int power_slave_id = 0;
-  if (extractIntValue(body, "power_slave_id", &power_slave_id)) hoist_hook_defaults_.power_slave_id = power_slave_id;
+  if (extractIntValue(body, "power_slave_id", &power_slave_id)) out->power_slave_id = power_slave_id;
   bool heartbeat_enable = false;
   if (extractBoolValue(body, "heartbeat_enable", &heartbeat_enable)) {
-    hoist_hook_defaults_.heartbeat_enable = heartbeat_enable;
+    out->heartbeat_enable = heartbeat_enable;
   }
   int heartbeat_period_ms = 0;
   if (extractIntValue(body, "heartbeat_period_ms", &heartbeat_period_ms) && heartbeat_period_ms > 0) {
-    hoist_hook_defaults_.heartbeat_period_ms = heartbeat_period_ms;
+    out->heartbeat_period_ms = heartbeat_period_ms;
   }
   int heartbeat_start_value = 0;
   if (extractIntValue(body, "heartbeat_start_value", &heartbeat_start_value) &&
       heartbeat_start_value >= 0 && heartbeat_start_value <= 65535) {
-    hoist_hook_defaults_.heartbeat_start_value = heartbeat_start_value;
+    out->heartbeat_start_value = heartbeat_start_value;
   }
   bool heartbeat_log_enabled = false;
   if (extractBoolValue(body, "heartbeat_log_enabled", &heartbeat_log_enabled)) {
-    hoist_hook_defaults_.heartbeat_log_enabled = heartbeat_log_enabled;
+    out->heartbeat_log_enabled = heartbeat_log_enabled;
   }
   bool time_sync_enable = false;
   if (extractBoolValue(body, "time_sync_enable", &time_sync_enable)) {
-    hoist_hook_defaults_.time_sync_enable = time_sync_enable;
+    out->time_sync_enable = time_sync_enable;
   }
   int time_sync_period_ms = 0;
   if (extractIntValue(body, "time_sync_period_ms", &time_sync_period_ms) && time_sync_period_ms > 0) {
-    hoist_hook_defaults_.time_sync_period_ms = time_sync_period_ms;
+    out->time_sync_period_ms = time_sync_period_ms;
   }
   bool time_sync_log_enabled = false;
   if (extractBoolValue(body, "time_sync_log_enabled", &time_sync_log_enabled)) {
-    hoist_hook_defaults_.time_sync_log_enabled = time_sync_log_enabled;
+    out->time_sync_log_enabled = time_sync_log_enabled;
   }
   int speaker_volume = -1;
   if (extractIntValue(body, "speaker_volume", &speaker_volume)) {
     if (speaker_volume >= 0 && speaker_volume <= 30) {
-      hoist_hook_defaults_.speaker_volume = speaker_volume;
+      out->speaker_volume = speaker_volume;
     }
   }
   double query_hz = 0.0;
-  if (extractDoubleValue(body, "query_hz", &query_hz)) hoist_hook_defaults_.query_hz = query_hz;
+  if (extractDoubleValue(body, "query_hz", &query_hz)) out->query_hz = query_hz;
   int both_speaker_play_window_ms = 0;
   if (extractIntValue(body, "both_speaker_play_window_ms", &both_speaker_play_window_ms) &&
       both_speaker_play_window_ms > 0) {
-    hoist_hook_defaults_.both_speaker_play_window_ms = both_speaker_play_window_ms;
+    out->both_speaker_play_window_ms = both_speaker_play_window_ms;
   }
   int both_speaker_switch_gap_ms = 0;
   if (extractIntValue(body, "both_speaker_switch_gap_ms", &both_speaker_switch_gap_ms) &&
       both_speaker_switch_gap_ms > 0) {
-    hoist_hook_defaults_.both_speaker_switch_gap_ms = both_speaker_switch_gap_ms;
+    out->both_speaker_switch_gap_ms = both_speaker_switch_gap_ms;
   }
   // Backward compatibility for old single-interval config.
   int both_speaker_switch_interval_ms = 0;
   if (extractIntValue(body, "both_speaker_switch_interval_ms", &both_speaker_switch_interval_ms) &&
       both_speaker_switch_interval_ms > 0) {
-    hoist_hook_defaults_.both_speaker_play_window_ms = both_speaker_switch_interval_ms;
+    out->both_speaker_play_window_ms = both_speaker_switch_interval_ms;
+  }
+  int hook_read_gap_tolerance = 0;
+  if (extractIntValue(body, "read_gap_tolerance", &hook_read_gap_tolerance)) {
+    out->read_gap_tolerance = std::min(std::max(hook_read_gap_tolerance, 0), 64);
   }
-  const std::string retry_body = extractObjectBody(body, "retry");
-  if (!retry_body.empty()) {
+  const common::JsonValue* retry_body = body->findObject("retry");
+  if (retry_body) {
     int max_retries = 0;
     if (extractIntValue(retry_body, "max_retries", &max_retries))
-      hoist_hook_defaults_.retry_policy.max_retries = std::max(0, max_retries);
+      out->retry_policy.max_retries = std::max(0, max_retries);
     int base_backoff_ms = 0;
     if (extractIntValue(retry_body, "base_backoff_ms", &base_backoff_ms))
-      hoist_hook_defaults_.retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
+      out->retry_policy.base_backoff_ms = std::max(0, base_backoff_ms);
     int max_backoff_ms = 0;
     if (extractIntValue(retry_body, "max_backoff_ms", &max_backoff_ms))
-      hoist_hook_defaults_.retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
+      out->retry_policy.max_backoff_ms = std::max(0, max_backoff_ms);
     int jitter_ms = 0;
     if (extractIntValue(retry_body, "jitter_ms", &jitter_ms))
-      hoist_hook_defaults_.retry_policy.jitter_ms = std::max(0, jitter_ms);
+      out->retry_policy.jitter_ms = std::max(0, jitter_ms);
     bool retry_log_enabled = true;
     if (extractBoolValue(retry_body, "log_enabled", &retry_log_enabled))
-      hoist_hook_defaults_.retry_policy.log_enabled = retry_log_enabled;
+      out->retry_policy.log_enabled = retry_log_enabled;
   }
 }
 
-void Interface::applyEncoderDefaultsFromJson(const std::string& json_text) {
-  const std::string runtime_body = extractObjectBody(json_text, "runtime");
-  if (runtime_body.empty()) return;
-  const std::string body = extractObjectBody(runtime_body, "multi_turn_encoder");
-  if (body.empty()) return;
+void Interface::applyEncoderDefaultsFromJson(const common::JsonValue& runtime, EncoderDefaults* out) {
+  const common::JsonValue* body = runtime.findObject("multi_turn_encoder");
+  if (!body) return;
 
   bool enable = true;
-  if (extractBoolValue(body, "enable", &enable)) encoder_defaults_.enable = enable;
+  if (extractBoolValue(body, "enable", &enable)) out->enable = enable;
   std::string transport;
-  if (extractStringValue(body, "transport", &transport)) encoder_defaults_.transport = transport;
+  if (extractStringValue(body, "transport", &transport)) out->transport = transport;
   std::string device;
-  if (extractStringValue(body, "device", &device)) encoder_defaults_.device = device;
+  if (extractStringValue(body, "device", &device)) out->device = device;
   int baud = 0;
-  if (extractIntValue(body, "baud", &baud)) encoder_defaults_.baud = baud;
+  if (extractIntValue(body, "baud", &baud)) out->baud = baud;
   std::string parity;
-  if (extractStringValue(body, "parity", &parity) && !parity.empty()) encoder_defaults_.parity = parity[0];
+  if (extractStringValue(body, "parity", &parity) && !parity.empty()) out->parity = parity[0];
   int data_bit = 0;
-  if (extractIntValue(body, "data_bit", &data_bit)) encoder_defaults_.data_bit = data_bit;
+  if (extractIntValue(body, "data_bit", &data_bit)) out->data_bit = data_bit;
   int stop_bit = 0;
-  if (extractIntValue(body, "stop_bit", &stop_bit)) encoder_defaults_.stop_bit = stop_bit;
+  if (extractIntValue(body, "stop_bit", &stop_bit)) out->stop_bit = stop_bit;
   int slave = 0;
-  if (extractIntValue(body, "slave", &slave)) encoder_defaults_.slave = slave;
+  if (extractIntValue(body, "slave", &slave)) out->slave = slave;
   std::string ip;
-  if (extractStringValue(body, "ip", &ip)) encoder_defaults_.ip = ip;
+  if (extractStringValue(body, "ip", &ip)) out->ip = ip;
   int port = 0;
-  if (extractIntValue(body, "port", &port)) encoder_defaults_.port = port;
+  if (extractIntValue(body, "port", &port)) out->port = port;
   bool linear_enable = false;
-  if (extractBoolValue(body, "linear_enable", &linear_enable)) encoder_defaults_.linear_enable = linear_enable;
+  if (extractBoolValue(body, "linear_enable", &linear_enable)) out->linear_enable = linear_enable;
   double linear_k = 0.0;
-  if (extractDoubleValue(body, "linear_k", &linear_k)) encoder_defaults_.linear_k = linear_k;
+  if (extractDoubleValue(body, "linear_k", &linear_k)) out->linear_k = linear_k;
   double linear_b = 0.0;
-  if (extractDoubleValue(body, "linear_b", &linear_b)) encoder_defaults_.linear_b = linear_b;
+  if (extractDoubleValue(body, "linear_b", &linear_b)) out->linear_b = linear_b;
   double query_hz = 0.0;
-  if (extractDoubleValue(body, "query_hz", &query_hz)) encoder_defaults_.query_hz = query_hz;
+  if (extractDoubleValue(body, "query_hz", &query_hz)) out->query_hz = query_hz;
+  std::string acquisition_mode;
+  if (extractStringValue(body, "acquisition_mode", &acquisition_mode)) {
+    if (acquisition_mode == "fixed_rate" || acquisition_mode == "on_demand") {
+      out->acquisition_mode = acquisition_mode;
+    } else {
+      std::cout << "[multi_turn_encoder] ⚠️ 未知 acquisition_mode=" << acquisition_mode
+                << "，使用 " << out->acquisition_mode << std::endl;
+    }
+  }
+  double sample_hz = 0.0;
+  if (extractDoubleValue(body, "sample_hz", &sample_hz) && sample_hz > 0.0) {
+    out->sample_hz = std::min(sample_hz, 200.0);
+  }
+  int velocity_window = 0;
+  if (extractIntValue(body, "velocity_window", &velocity_window)) {
+    out->velocity_window = std::min(std::max(velocity_window, 2), 100);
+  }
+  int velocity_warmup = 0;
+  if (extractIntValue(body, "velocity_warmup", &velocity_warmup)) {
+    out->velocity_warmup = std::max(velocity_warmup, 2);
+  }
 }
 
-void Interface::applySpdLidarDefaultsFromJson(const std::string& json_text) {
-  spd_lidar_query_hz_ = 0.0;
-  const std::string runtime_body = extractObjectBody(json_text, "runtime");
-  if (runtime_body.empty()) return;
-  const std::string body = extractObjectBody(runtime_body, "spd_lidar");
-  if (body.empty()) return;
+void Interface::applySpdLidarDefaultsFromJson(const common::JsonValue& runtime,
+                                             double* query_hz_out,
+                                             std::vector<SpdLidarInstanceDefaults>* out) {
+  *query_hz_out = 0.0;
+  const common::JsonValue* body = runtime.findObject("spd_lidar");
+  if (!body) return;
   double query_hz = 0.0;
-  if (extractDoubleValue(body, "query_hz", &query_hz)) spd_lidar_query_hz_ = query_hz;
+  if (extractDoubleValue(body, "query_hz", &query_hz)) *query_hz_out = query_hz;
 
-  spd_lidar_instances_.clear();
-  const std::string instances_body = extractArrayBody(body, "instances");
-  if (!instances_body.empty()) {
-    const std::vector<std::string> object_bodies = splitTopLevelObjects(instances_body);
-    for (size_t i = 0; i < object_bodies.size(); ++i) {
+  out->clear();
+  const common::JsonValue* instances = body->findArray("instances");
+  if (instances && instances->size() > 0) {
+    for (size_t i = 0; i < instances->size(); ++i) {
+      const common::JsonValue* item = &instances->at(i);
+      if (!item->isObject()) continue;
       SpdLidarInstanceDefaults one;
       std::string id;
-      if (extractStringValue(object_bodies[i], "id", &id) && !id.empty()) one.id = id;
+      if (extractStringValue(item, "id", &id) && !id.empty()) one.id = id;
       bool enable = true;
-      if (extractBoolValue(object_bodies[i], "enable", &enable)) one.enable = enable;
+      if (extractBoolValue(item, "enable", &enable)) one.enable = enable;
       std::string mode;
-      if (extractStringValue(object_bodies[i], "mode", &mode)) one.mode = mode;
+      if (extractStringValue(item, "mode", &mode)) one.mode = mode;
       std::string local_ip;
-      if (extractStringValue(object_bodies[i], "local_ip", &local_ip)) one.local_ip = local_ip;
+      if (extractStringValue(item, "local_ip", &local_ip)) one.local_ip = local_ip;
       int local_port = 0;
-      if (extractIntValue(object_bodies[i], "local_port", &local_port)) one.local_port = local_port;
+      if (extractIntValue(item, "local_port", &local_port)) one.local_port = local_port;
       std::string device_ip;
-      if (extractStringValue(object_bodies[i], "device_ip", &device_ip)) one.device_ip = device_ip;
+      if (extractStringValue(item, "device_ip", &device_ip)) one.device_ip = device_ip;
       int device_port = 0;
-      if (extractIntValue(object_bodies[i], "device_port", &device_port)) one.device_port = device_port;
+      if (extractIntValue(item, "device_port", &device_port)) one.device_port = device_port;
       std::string role;
-      if (extractStringValue(object_bodies[i], "role", &role)) one.role = role;
+      if (extractStringValue(item, "role", &role)) one.role = role;
       double vertical_angle_to_vertical_deg = 0.0;
-      if (extractDoubleValue(object_bodies[i],
+      if (extractDoubleValue(item,
                              kSpdLidarVerticalAngleToVerticalKey,
                              &vertical_angle_to_vertical_deg)) {
         one.vertical_angle_to_vertical_deg = vertical_angle_to_vertical_deg;
       }
-      spd_lidar_instances_.push_back(one);
+      out->push_back(one);
     }
     return;
   }
@@ -795,25 +939,111 @@ void Interface::applySpdLidarDefaultsFromJson(const std::string& json_text) {
   if (extractDoubleValue(body, kSpdLidarVerticalAngleToVerticalKey, &vertical_angle_to_vertical_deg)) {
     one.vertical_angle_to_vertical_deg = vertical_angle_to_vertical_deg;
   }
-  spd_lidar_instances_.push_back(one);
+  out->push_back(one);
 }
 
-Status Interface::loadConfig(const std::string& path) {
+void Interface::applyModbusGatewayDefaultsFromJson(const common::JsonValue& runtime,
+                                                  std::vector<ModbusGatewayDefaults>* out) {
+  out->clear();
+  const common::JsonValue* gateways = runtime.findArray("modbus_gateways");
+  if (!gateways) return;
+  for (size_t i = 0; i < gateways->size(); ++i) {
+    const common::JsonValue* item = &gateways->at(i);
+    if (!item->isObject()) continue;
+    ModbusGatewayDefaults one;
+    std::string module_ip;
+    if (extractStringValue(item, "module_ip", &module_ip)) one.module_ip = module_ip;
+    int module_port = 0;
+    if (extractIntValue(item, "module_port", &module_port)) one.module_port = module_port;
+    bool pipelined = false;
+    if (extractBoolValue(item, "pipelined", &pipelined)) one.pipelined = pipelined;
+    int max_in_flight = 0;
+    if (extractIntValue(item, "max_in_flight", &max_in_flight)) {
+      one.max_in_flight = std::min(std::max(max_in_flight, 1), 16);
+    }
+    int background_backlog_limit = 0;
+    if (extractIntValue(item, "background_backlog_limit", &background_backlog_limit)) {
+      one.background_backlog_limit = std::min(std::max(background_backlog_limit, 1), 64);
+    }
+    out->push_back(one);
+  }
+}
+
+bool Interface::loadConfigDocument(const std::string& path, common::JsonValue* root, std::string* error) {
+  ConfigSourceStamp stamp;
+  const bool have_stamp = statConfigSource(path, &stamp);
+  const std::string cache_path = have_stamp ? configCachePath(path) : std::string();
+  if (!cache_path.empty() && readConfigCache(cache_path, stamp, root)) return true;
+
   std::ifstream ifs(path);
   if (!ifs.is_open()) {
-    return Status{false, "failed to open config file: " + path};
+    if (error) *error = "failed to open config file: " + path;
+    return false;
   }
   std::ostringstream ss;
   ss << ifs.rdbuf();
-  const std::string json_text = ss.str();
+  std::string parse_error;
+  if (!common::JsonValue::parse(ss.str(), root, &parse_error)) {
+    if (error) *error = "invalid config " + path + ": " + parse_error;
+    return false;
+  }
+  if (!cache_path.empty()) writeConfigCache(cache_path, stamp, *root);
+  return true;
+}
 
-  applyBatteryDefaultsFromJson(json_text);
-  applySolarDefaultsFromJson(json_text);
-  applyIoRelayDefaultsFromJson(json_text);
-  applyHoistHookDefaultsFromJson(json_text);
-  applyEncoderDefaultsFromJson(json_text);
-  applySpdLidarDefaultsFromJson(json_text);
+Status Interface::parseConfig(const std::string& path, RuntimeDefaults* out) {
+  // 整个文件只解析一次，各 apply 函数直接在 DOM 上按 key 取值。
+  common::JsonValue root;
+  std::string error;
+  if (!loadConfigDocument(path, &root, &error)) {
+    return Status{false, error};
+  }
+  static const common::JsonValue kNoRuntime;
+  const common::JsonValue* runtime_obj = root.findObject("runtime");
+  const common::JsonValue& runtime = runtime_obj ? *runtime_obj : kNoRuntime;
+
+  applyBatteryDefaultsFromJson(runtime, &out->battery);
+  applySolarDefaultsFromJson(runtime, &out->solar);
+  applyIoRelayDefaultsFromJson(runtime, &out->io_relay);
+  applyHoistHookDefaultsFromJson(runtime, &out->hoist_hook);
+  applyEncoderDefaultsFromJson(runtime, &out->encoder);
+  applySpdLidarDefaultsFromJson(runtime, &out->spd_lidar_query_hz, &out->spd_lidar_instances);
+  applyModbusGatewayDefaultsFromJson(runtime, &out->modbus_gateways);
+  return Status{true, "config parsed: " + path};
+}
+
+Interface::RuntimeDefaults Interface::currentDefaults() const {
+  RuntimeDefaults cfg;
+  cfg.battery = battery_defaults_;
+  cfg.solar = solar_defaults_;
+  cfg.io_relay = io_relay_defaults_;
+  cfg.hoist_hook = hoist_hook_defaults_;
+  cfg.encoder = encoder_defaults_;
+  cfg.spd_lidar_query_hz = spd_lidar_query_hz_;
+  cfg.spd_lidar_instances = spd_lidar_instances_;
+  cfg.modbus_gateways = modbus_gateways_;
+  return cfg;
+}
+
+void Interface::publishDefaults(RuntimeDefaults&& cfg) {
+  // queryAsync() 不持锁读 lane，先换上新的 lane 表，再替换默认值。
+  std::atomic_store(&bus_lanes_, buildBusLanes(cfg));
+  battery_defaults_ = std::move(cfg.battery);
+  solar_defaults_ = std::move(cfg.solar);
+  io_relay_defaults_ = std::move(cfg.io_relay);
+  hoist_hook_defaults_ = std::move(cfg.hoist_hook);
+  encoder_defaults_ = std::move(cfg.encoder);
+  spd_lidar_query_hz_ = cfg.spd_lidar_query_hz;
+  spd_lidar_instances_ = std::move(cfg.spd_lidar_instances);
+  modbus_gateways_ = std::move(cfg.modbus_gateways);
+}
 
+Status Interface::loadConfig(const std::string& path) {
+  // 未出现的 key 保留当前值；解析失败时不改动任何成员。
+  RuntimeDefaults cfg = currentDefaults();
+  const Status status = parseConfig(path, &cfg);
+  if (!status.ok) return status;
+  publishDefaults(std::move(cfg));
   config_loaded_ = true;
   loaded_config_path_ = path;
   return Status{true, "config loaded: " + path};
@@ -917,7 +1147,8 @@ void Interface::buildDriverAdapters() {
         "multi_turn_encoder",
         []() { return Status{true, "ok"}; },
         [this]() {
-          const bool ok = multi_turn_encoder_->connect();
+          // init() 阶段通常已连上，这里只在未连接时重连
+          const bool ok = multi_turn_encoder_->isConnected() || multi_turn_encoder_->connect();
           if (!ok) return Status{false, "encoder connect failed"};
           multi_turn_encoder_->run();
           return Status{true, "encoder started"};
@@ -989,121 +1220,326 @@ void Interface::buildDriverAdapters() {
       []() { return std::vector<std::string>{"status"}; });
 }
 
+std::shared_ptr<const Interface::BusLanes> Interface::buildBusLanes(const RuntimeDefaults& cfg) {
+  std::shared_ptr<BusLanes> lanes = std::make_shared<BusLanes>();
+  const auto modbus = [](const std::string& ip, int port) {
+    return "modbus:" + common::ModbusTcpConnectionPool::endpointKey(ip, static_cast<std::uint16_t>(port));
+  };
+  // Trolley refreshes (battery / encoder / lidar cadence) all end up reading the
+  // trolley battery, so they share the battery bus lane.
+  const std::string battery = modbus(cfg.battery.module_ip, cfg.battery.module_port);
+  lanes->by_sensor["battery"] = battery;
+  lanes->by_sensor["multi_turn_encoder"] = battery;
+  lanes->by_sensor["spd_lidar.trolley"] = battery;
+  lanes->by_sensor["solar"] = modbus(cfg.solar.module_ip, cfg.solar.module_port);
+  lanes->by_sensor["hoist_hook"] = cfg.hoist_hook.transport == "rtu"
+                                       ? "serial:" + cfg.hoist_hook.device
+                                       : modbus(cfg.hoist_hook.module_ip, cfg.hoist_hook.module_port);
+  lanes->by_sensor["io_relay"] = modbus(cfg.io_relay.module_ip, cfg.io_relay.module_port);
+  lanes->encoder_port =
+      cfg.encoder.transport == "tcp"
+          ? "tcp:" + common::ModbusTcpConnectionPool::endpointKey(
+                         cfg.encoder.ip, static_cast<std::uint16_t>(cfg.encoder.port))
+          : "serial:" + cfg.encoder.device;
+  return lanes;
+}
+
+std::string Interface::busLane(const std::string& sensor) const {
+  const std::shared_ptr<const BusLanes> lanes = std::atomic_load(&bus_lanes_);
+  const auto it = lanes->by_sensor.find(sensor);
+  return it == lanes->by_sensor.end() ? sensor : it->second;
+}
+
 void Interface::startAutoQueryPolling() {
   stopAutoQueryPolling();
-  auto_query_running_ = true;
-  struct PollTask {
-    std::string sensor;
-    std::chrono::steady_clock::duration period;
-    std::chrono::steady_clock::time_point next_due;
-  };
-  std::vector<PollTask> tasks;
-  const auto now = std::chrono::steady_clock::now();
+  auto_query_scheduler_.clear();
 
+  // 任务在此预先绑定回调，并按物理总线分 lane：同一总线串行，不同总线并行。
+  // 轮询读按 Background 优先级排队，控制写可越过；sheddable 的任务在总线饱和时整轮跳过。
   const auto add_task = [&](const std::string& sensor,
-                            double hz) {
+                            const std::string& name,
+                            double hz,
+                            std::function<void()> fn,
+                            bool sheddable = true) {
     if (hz <= 0.0) return;
     if (drivers_.find(sensor) == drivers_.end()) return;
     const double safe_hz = std::min(std::max(hz, 0.1), 50.0);
-    PollTask t;
-    t.sensor = sensor;
-    t.period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
         std::chrono::duration<double>(1.0 / safe_hz));
-    t.next_due = now;
-    tasks.push_back(t);
+    const std::string lane = busLane(name);
+    const std::string bus_key = sheddable ? busSchedulerKey(lane) : std::string();
+    auto_query_scheduler_.addTask(lane, name, period, [fn, bus_key]() {
+      if (!bus_key.empty() && !common::GatewayScheduler::instance().admitBackground(bus_key)) return;
+      common::BusPriorityScope scope(common::BusPriority::Background);
+      fn();
+    });
   };
 
+  // 静默轮询，仅更新 DeviceStatus，不在终端打印
 #ifdef ASC_ENABLE_BATTERY
-  add_task("battery", battery_defaults_.query_hz);
+  add_task("battery", "battery", battery_defaults_.query_hz,
+           [this]() { updateTrolleyStateFromDrivers(); });
 #endif
 #ifdef ASC_ENABLE_SOLAR
-  add_task("solar", solar_defaults_.query_hz);
+  add_task("solar", "solar", solar_defaults_.query_hz,
+           [this]() { updateSolarChargeStateFromDriver(); });
 #endif
 #ifdef ASC_ENABLE_HOIST_HOOK
-  add_task("hoist_hook", hoist_hook_defaults_.query_hz);
+  add_task("hoist_hook", "hoist_hook", hoist_hook_defaults_.query_hz,
+           [this]() { updateHookStateFromDriver(); });
 #endif
 #ifdef ASC_ENABLE_MULTI_TURN_ENCODER
-  add_task("multi_turn_encoder", encoder_defaults_.query_hz);
+  // Encoder polling tick should also drive aggregated trolley state update.
+  // Never shed: it also carries the encoder-driven crane distance.
+  add_task("multi_turn_encoder", "multi_turn_encoder", encoder_defaults_.query_hz,
+           [this]() { updateTrolleyStateFromDrivers(); }, false);
 #endif
 #ifdef ASC_ENABLE_SPD_LIDAR
-  add_task("spd_lidar", spd_lidar_query_hz_);
+  // 单点激光雷达：发送 single 查询触发测距，响应经 on_frame 更新 groundToTrolley
+  add_task("spd_lidar", "spd_lidar", spd_lidar_query_hz_, [this]() {
+    query("spd_lidar", std::vector<std::string>{"send", "all", "single"});
+  });
+  // Keep trolley state refreshed by lidar cadence as well (on the battery lane).
+  add_task("spd_lidar", "spd_lidar.trolley", spd_lidar_query_hz_,
+           [this]() { updateTrolleyStateFromDrivers(); });
 #endif
 
+  const std::vector<common::DeadlineScheduler::TaskInfo> tasks = auto_query_scheduler_.tasks();
   {
     std::lock_guard<std::mutex> lock(output_mutex_);
-    std::cout << "[auto_query] start, task_count=" << tasks.size() << std::endl;
+    std::cout << "[auto_query] start, task_count=" << tasks.size()
+              << ", lane_count=" << auto_query_scheduler_.laneCount() << std::endl;
     for (size_t i = 0; i < tasks.size(); ++i) {
       const auto period_ms =
           std::chrono::duration_cast<std::chrono::milliseconds>(tasks[i].period).count();
-      std::cout << "[auto_query] task[" << i << "] sensor=" << tasks[i].sensor
-                << ", period_ms=" << period_ms << std::endl;
-    }
-  }
-
-  if (!tasks.empty()) {
-    auto_query_threads_.emplace_back([this, tasks]() mutable {
-      while (auto_query_running_) {
-        const auto tick = std::chrono::steady_clock::now();
-        bool ran = false;
-        for (size_t i = 0; i < tasks.size(); ++i) {
-          if (tick < tasks[i].next_due) continue;
-          // 静默轮询，仅更新 DeviceStatus，不在终端打印
-          if (tasks[i].sensor == "battery") {
-            updateTrolleyStateFromDrivers();
-          } else if (tasks[i].sensor == "solar") {
-            updateSolarChargeStateFromDriver();
-          } else if (tasks[i].sensor == "hoist_hook") {
-            updateHookStateFromDriver();
-          } else if (tasks[i].sensor == "multi_turn_encoder") {
-            // Encoder polling tick should also drive aggregated trolley state update.
-            updateTrolleyStateFromDrivers();
-          } else if (tasks[i].sensor == "spd_lidar") {
-            // 单点激光雷达：发送 single 查询触发测距，响应经 on_frame 更新 groundToTrolley
-            query("spd_lidar", std::vector<std::string>{"send", "all", "single"});
-            // Keep trolley state refreshed by lidar cadence as well.
-            updateTrolleyStateFromDrivers();
-          }
-          tasks[i].next_due = std::chrono::steady_clock::now() + tasks[i].period;
-          ran = true;
-          break;  // Strictly serialize all queries.
-        }
-        if (!ran) std::this_thread::sleep_for(std::chrono::milliseconds(20));
-      }
-    });
+      std::cout << "[auto_query] task[" << i << "] sensor=" << tasks[i].name
+                << ", lane=" << tasks[i].lane << ", period_ms=" << period_ms << std::endl;
+    }
   }
+
+  if (!tasks.empty()) auto_query_scheduler_.start();
 }
 
 void Interface::stopAutoQueryPolling() {
-  auto_query_running_ = false;
-  for (size_t i = 0; i < auto_query_threads_.size(); ++i) {
-    if (auto_query_threads_[i].joinable()) auto_query_threads_[i].join();
+  auto_query_scheduler_.stop();
+}
+
+common::QueryResult Interface::queryResult(const std::string& sensor,
+                                           const std::vector<std::string>& args) {
+  common::QueryResult result;
+  result.sensor = sensor;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (i > 0) result.command += ' ';
+    result.command += args[i];
   }
-  auto_query_threads_.clear();
+  const auto started = std::chrono::steady_clock::now();
+  if (!initialized_) {
+    result.status = Status{false, "sdk not initialized"};
+  } else {
+    std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+    result.status = fillQueryResult(sensor, args, &result);
+  }
+  result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - started);
+  result.finished_at = std::chrono::system_clock::now();
+  common::SensorSlot slot;
+  if (common::sensorSlotFor(sensor, &slot)) sensor_snapshot_.record(slot, result);
+  return result;
 }
 
-Status Interface::queryWithCapturedOutput(const std::string& sensor,
-                                          const std::vector<std::string>& args,
-                                          std::string* captured_output) {
-  std::ostringstream oss;
-  std::streambuf* old_cout = nullptr;
-  std::streambuf* old_cerr = nullptr;
-  Status s;
-  {
-    std::lock_guard<std::mutex> lock(output_mutex_);
-    old_cout = std::cout.rdbuf(oss.rdbuf());
-    old_cerr = std::cerr.rdbuf(oss.rdbuf());
-    s = query(sensor, args);
-    std::cout.rdbuf(old_cout);
-    std::cerr.rdbuf(old_cerr);
+std::vector<common::TransactionSeriesSnapshot> Interface::metricsSnapshot() const {
+  return common::TransactionMetrics::instance().snapshot();
+}
+
+std::vector<common::BusQueueSnapshot> Interface::busQueueSnapshot() const {
+  return common::GatewayScheduler::instance().snapshot();
+}
+
+std::array<common::SensorRecord, common::kSensorSlotCount> Interface::sensorSnapshot() const {
+  std::array<common::SensorRecord, common::kSensorSlotCount> out;
+  for (size_t i = 0; i < out.size(); ++i) out[i] = sensor_snapshot_.load(static_cast<common::SensorSlot>(i));
+  return out;
+}
+
+Status Interface::fillQueryResult(const std::string& sensor,
+                                  const std::vector<std::string>& args,
+                                  common::QueryResult* out) {
+  if (args.empty()) return Status{false, "missing command"};
+  const std::string& cmd = args[0];
+
+  // "<sensor> get <addr> [qty] [fc]" 的公共参数解析
+  int addr = 0, qty = 1, fc = -1;
+  const auto parse_get = [&]() -> Status {
+    if (args.size() < 2) return Status{false, "usage: " + sensor + " get <addr> [qty] [fc]"};
+    if (!parseInt(args[1], &addr)) return Status{false, "invalid addr"};
+    if (args.size() >= 3 && !parseInt(args[2], &qty)) return Status{false, "invalid qty"};
+    if (args.size() >= 4 && !parseInt(args[3], &fc)) return Status{false, "invalid fc"};
+    out->start_address = static_cast<std::uint16_t>(addr);
+    return Status{true, "ok"};
+  };
+  const auto read_failed = [](const std::string& error) {
+    return Status{false, error.empty() ? std::string("register read failed") : error};
+  };
+
+#ifdef ASC_ENABLE_BATTERY
+  if (sensor == "battery") {
+    if (!battery_) return Status{false, "battery not enabled"};
+    if (cmd == "summary") {
+      battery::BatteryCore::Summary summary;
+      if (!battery_->readSummary(&summary)) return Status{false, "battery summary read failed"};
+      out->add("soc", summary.soc_percent, "%");
+      out->add("voltage", summary.voltage_v, "V");
+      out->add("current", summary.current_a, "A");
+      out->add("remaining_discharge", summary.remaining_discharge_min, "min");
+      out->add("remaining_charge", summary.remaining_charge_min, "min");
+      if (summary.has_charge_mos) out->add("charge_mos", summary.charge_mos);
+      return Status{true, "ok"};
+    }
+    if (cmd == "get") {
+      const Status s = parse_get();
+      if (!s.ok) return s;
+      out->function_code = static_cast<std::uint8_t>(fc < 0 ? 0x03 : fc);
+      std::string error;
+      if (!battery_->readRegisterValues(static_cast<uint16_t>(addr), static_cast<uint16_t>(qty), fc,
+                                        &out->registers, &error)) {
+        return read_failed(error);
+      }
+      return Status{true, "ok"};
+    }
+    return Status{false, "usage: battery <summary|get>"};
+  }
+#endif
+#ifdef ASC_ENABLE_SOLAR
+  if (sensor == "solar") {
+    if (!solar_) return Status{false, "solar not enabled"};
+    if (cmd == "charge") {
+      solar::SolarCore::ChargeStatusSample sample;
+      if (!solar_->readChargeStatusSample(&sample) || !sample.ok) {
+        return Status{false, "solar charge status read failed"};
+      }
+      out->add("charge_status_word", sample.charge_status_word);
+      out->add("battery_current", sample.battery_current_a, "A");
+      out->add("charge_fault", solar::SolarCore::hasChargeFault(sample.charge_status_word) ? 1.0 : 0.0);
+      return Status{true, "ok"};
+    }
+    if (cmd == "get") {
+      const Status s = parse_get();
+      if (!s.ok) return s;
+      out->function_code = static_cast<std::uint8_t>(fc < 0 ? 0x04 : fc);
+      std::string error;
+      if (!solar_->readRegisterValues(static_cast<uint16_t>(addr), static_cast<uint16_t>(qty), fc,
+                                      &out->registers, &error)) {
+        return read_failed(error);
+      }
+      return Status{true, "ok"};
+    }
+    return Status{false, "usage: solar <charge|get>"};
+  }
+#endif
+#ifdef ASC_ENABLE_HOIST_HOOK
+  if (sensor == "hoist_hook") {
+    if (!hoist_hook_) return Status{false, "hoist_hook not enabled"};
+    if (cmd == "power") {
+      hoist_hook::HoistHookCore::PowerSummary summary;
+      if (!hoist_hook_->readPowerSummary(&summary)) return Status{false, "hook power read failed"};
+      out->add("battery", summary.battery_percent, "%");
+      out->add("voltage", summary.voltage_v, "V");
+      out->add("current", summary.current_a, "A");
+      out->add("charging", summary.is_charging ? 1.0 : 0.0);
+      out->add("remaining_discharge", summary.remaining_discharge_min, "min");
+      out->add("remaining_charge", summary.remaining_charge_min, "min");
+      return Status{true, "ok"};
+    }
+    if (cmd == "get") {
+      const Status s = parse_get();
+      if (!s.ok) return s;
+      out->function_code = static_cast<std::uint8_t>(fc < 0 ? 0x03 : fc);
+      std::string error;
+      if (!hoist_hook_->readRegisterValues(static_cast<uint16_t>(addr), static_cast<uint16_t>(qty), fc,
+                                           &out->registers, &error)) {
+        return read_failed(error);
+      }
+      return Status{true, "ok"};
+    }
+    return Status{false, "usage: hoist_hook <power|get>"};
+  }
+#endif
+#ifdef ASC_ENABLE_IO_RELAY
+  if (sensor == "io_relay") {
+    if (!io_relay_) return Status{false, "io_relay not enabled"};
+    if (cmd != "read") return Status{false, "usage: io_relay read [channel]"};
+    if (args.size() < 2) {
+      // 一次 FC01 读全部 16 路
+      std::uint16_t image = 0;
+      if (!io_relay_->getRelayImage(&image)) return Status{false, "io_relay read failed"};
+      for (int i = 1; i <= 16; ++i) {
+        out->add("relay" + std::to_string(i), ((image >> (i - 1)) & 0x1) ? 1.0 : 0.0);
+      }
+      return Status{true, "ok"};
+    }
+    int ch = 0;
+    if (!parseInt(args[1], &ch) || ch <= 0) return Status{false, "invalid channel"};
+    bool on = false;
+    if (!io_relay_->getRelayState(ch, &on)) return Status{false, "io_relay read failed"};
+    out->add("relay" + std::to_string(ch), on ? 1.0 : 0.0);
+    return Status{true, "ok"};
+  }
+#endif
+#ifdef ASC_ENABLE_MULTI_TURN_ENCODER
+  if (sensor == "multi_turn_encoder") {
+    if (!multi_turn_encoder_) return Status{false, "multi_turn_encoder not enabled"};
+    if (cmd == "status") {
+      out->add("connected", multi_turn_encoder_->isConnected() ? 1.0 : 0.0);
+      out->add("running", multi_turn_encoder_->isRunning() ? 1.0 : 0.0);
+      return Status{true, "ok"};
+    }
+    if (cmd == "get") {
+      const auto data = multi_turn_encoder_->getLatest();
+      out->add("valid", data.valid ? 1.0 : 0.0);
+      out->add("timestamp", data.timestamp, "s");
+      out->add("turns_raw", data.turns_raw);
+      out->add("turns_filtered", data.turns_filtered);
+      out->add("turns_calibrated", data.turns_calibrated);
+      out->add("velocity", data.velocity);
+      return Status{data.valid, data.valid ? "ok" : "no valid encoder sample"};
+    }
+    return Status{false, "usage: multi_turn_encoder <get|status>"};
+  }
+#endif
+#ifdef ASC_ENABLE_SPD_LIDAR
+  if (sensor == "spd_lidar") {
+    if (cmd != "status") return Status{false, "usage: spd_lidar status"};
+    const std::unordered_map<std::string, std::uint16_t> raw_mm = getLatestLidarRawMm();
+    for (size_t i = 0; i < spd_lidar_instances_.size(); ++i) {
+      const SpdLidarInstanceDefaults& cfg = spd_lidar_instances_[i];
+      if (!cfg.enable) continue;
+      std::unordered_map<std::string, std::uint16_t>::const_iterator it = raw_mm.find(cfg.id);
+      if (it != raw_mm.end()) out->add(cfg.id + ".raw", it->second, "mm");
+      if (cfg.mode == "server") {
+        std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+        std::unordered_map<std::string, SpdLidarServerConnectionState>::const_iterator conn_it =
+            spd_lidar_server_connections_.find(cfg.id);
+        const bool connected =
+            conn_it != spd_lidar_server_connections_.end() && conn_it->second.conn_fd >= 0;
+        out->add(cfg.id + ".connected", connected ? 1.0 : 0.0);
+      }
+    }
+    return Status{true, "ok"};
   }
-  if (captured_output) *captured_output = oss.str();
-  return s;
+#endif
+  return Status{false, "sensor not enabled or unknown sensor"};
 }
 
 void Interface::startSnapshotPrinter() {
   stopSnapshotPrinter();
   snapshot_printer_running_ = true;
   snapshot_printer_thread_ = std::thread([this]() {
+    // 纯诊断输出：SCHED_IDLE 只在 CPU 空闲时运行，不与轮询线程争抢。
+    sched_param param{};
+    param.sched_priority = 0;
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+      common::LogLine(common::LogLevel::Debug, "snapshot") << "SCHED_IDLE unavailable, keep default priority";
+    }
     const std::chrono::milliseconds period(1000);
     while (snapshot_printer_running_) {
       printSnapshotTick();
@@ -1114,6 +1550,13 @@ void Interface::startSnapshotPrinter() {
 
 void Interface::updateTrolleyStateFromDrivers() {
   DeviceStatus data = getDeviceStatus();
+  // Auto-query lanes run concurrently; only publish the fields owned here.
+  const auto publish = [&]() {
+    mergeDeviceStatus([&](DeviceStatus* d) {
+      d->trolleyState = data.trolleyState;
+      d->trolleyBattery = data.trolleyBattery;
+    });
+  };
   const DeviceStatus::EquipmentState prev_state = data.trolleyState;
   bool encoder_ok = false;
   bool bypass_battery_power_gate = false;
@@ -1122,9 +1565,14 @@ void Interface::updateTrolleyStateFromDrivers() {
   // Keep crane distance updated from encoder whenever encoder data is valid,
   // even if trolley power/battery state currently maps to Standby/Offline.
   if (multi_turn_encoder_) {
+    const auto read_started = std::chrono::steady_clock::now();
     const multi_turn_encoder::MultiTurnEncoderCore::LatestData latest =
         multi_turn_encoder_->getLatest();
     encoder_ok = latest.valid && latest.connected;
+    sensor_snapshot_.recordPoll(common::SensorSlot::MultiTurnEncoder, encoder_ok, "poll latest",
+                                "turns_calibrated", latest.turns_calibrated,
+                                elapsedSince(read_started),
+                                latest.connected ? "no valid sample" : "disconnected");
     if (encoder_ok) {
       updateCraneStateFromEncoder(latest.turns_calibrated);
     }
@@ -1149,17 +1597,23 @@ void Interface::updateTrolleyStateFromDrivers() {
     } else {
       const bool battery_ok = battery_->isOnline();
       if (!battery_ok) {
+        sensor_snapshot_.recordPoll(common::SensorSlot::Battery, false, "poll summary", "soc", 0.0,
+                                    std::chrono::microseconds(0), "battery offline");
         data.trolleyState = DeviceStatus::EquipmentState::Offline;
         if (prev_state != data.trolleyState) {
-          std::lock_guard<std::mutex> lock(output_mutex_);
-          std::cout << "[trolley_state] write Offline: battery offline" << std::endl;
+          common::LogLine(common::LogLevel::Info, "trolley_state") << "write Offline: battery offline";
         }
-        setDeviceStatus(data);
+        publish();
         return;
       }
 
       battery::BatteryCore::Summary summary;
-      if (battery_->readSummary(&summary)) {
+      const auto read_started = std::chrono::steady_clock::now();
+      const bool summary_ok = battery_->readSummary(&summary);
+      sensor_snapshot_.recordPoll(common::SensorSlot::Battery, summary_ok, "poll summary", "soc",
+                                  summary.soc_percent, elapsedSince(read_started),
+                                  "read summary failed");
+      if (summary_ok) {
         DeviceStatus::BatteryInfo info;
         float soc = summary.soc_percent;
         if (soc < 0.0f) soc = 0.0f;
@@ -1194,11 +1648,10 @@ void Interface::updateTrolleyStateFromDrivers() {
       (power_cmd == PowerCommand::PowerOff || power_cmd == PowerCommand::None)) {
     data.trolleyState = DeviceStatus::EquipmentState::Standby;
     if (prev_state != data.trolleyState) {
-      std::lock_guard<std::mutex> lock(output_mutex_);
-      std::cout << "[trolley_state] write Standby: blocked by power command="
-                << static_cast<int>(power_cmd) << std::endl;
+      common::LogLine(common::LogLevel::Info, "trolley_state")
+          << "write Standby: blocked by power command=" << static_cast<int>(power_cmd);
     }
-    setDeviceStatus(data);
+    publish();
     return;
   }
 
@@ -1211,36 +1664,48 @@ void Interface::updateTrolleyStateFromDrivers() {
   if (encoder_ok && lidar_ok) {
     data.trolleyState = DeviceStatus::EquipmentState::Active;
     if (prev_state != data.trolleyState) {
-      std::lock_guard<std::mutex> lock(output_mutex_);
-      std::cout << "[trolley_state] write Active: encoder_ok=" << (encoder_ok ? "true" : "false")
-                << ", lidar_ok=" << (lidar_ok ? "true" : "false") << std::endl;
+      common::LogLine(common::LogLevel::Info, "trolley_state")
+          << "write Active: encoder_ok=" << (encoder_ok ? "true" : "false")
+          << ", lidar_ok=" << (lidar_ok ? "true" : "false");
     }
   } else {
     data.trolleyState = DeviceStatus::EquipmentState::Standby;
     if (prev_state != data.trolleyState) {
-      std::lock_guard<std::mutex> lock(output_mutex_);
-      std::cout << "[trolley_state] write Standby: encoder_ok=" << (encoder_ok ? "true" : "false")
-                << ", lidar_ok=" << (lidar_ok ? "true" : "false") << std::endl;
+      common::LogLine(common::LogLevel::Info, "trolley_state")
+          << "write Standby: encoder_ok=" << (encoder_ok ? "true" : "false")
+          << ", lidar_ok=" << (lidar_ok ? "true" : "false");
     }
   }
 
-  setDeviceStatus(data);
+  publish();
 }
 
 void Interface::updateHookStateFromDriver() {
   DeviceStatus data = getDeviceStatus();
 
 #ifdef ASC_ENABLE_HOIST_HOOK
+  // Hook fields only; trolley and solar are written by other lanes.
+  const auto publish = [&]() {
+    mergeDeviceStatus([&](DeviceStatus* d) {
+      d->hookState = data.hookState;
+      d->hookBattery = data.hookBattery;
+    });
+  };
   if (!hoist_hook_ || !hoist_hook_defaults_.enable) {
     data.hookState = DeviceStatus::EquipmentState::Unknown;
-    setDeviceStatus(data);
+    publish();
     return;
   }
 
   hoist_hook::HoistHookCore::PowerSummary summary;
-  if (!hoist_hook_->readPowerSummary(&summary)) {
+  const auto read_started = std::chrono::steady_clock::now();
+  const bool summary_ok = hoist_hook_->readPowerSummary(&summary);
+  sensor_snapshot_.recordPoll(common::SensorSlot::HoistHook, summary_ok, "poll power", "battery_percent",
+                              summary.battery_percent, elapsedSince(read_started),
+                              "read power summary failed");
+  if (!summary_ok) {
     data.hookState = DeviceStatus::EquipmentState::Offline;
-    setDeviceStatus(data);
+    publish();
     return;
   }
 
@@ -1260,7 +1725,7 @@ void Interface::updateHookStateFromDriver() {
 
   hook_battery_last_update_ = std::chrono::system_clock::now();
   data.hookState = DeviceStatus::EquipmentState::Active;
-  setDeviceStatus(data);
+  publish();
 #else
   (void)data;
 #endif
@@ -1272,43 +1737,16 @@ void Interface::stopSnapshotPrinter() {
 }
 
 void Interface::printSnapshotTick() {
-  std::unordered_map<std::string, std::string> outputs;
-  std::unordered_map<std::string, Status> statuses;
-  std::unordered_map<std::string, std::chrono::system_clock::time_point> times;
-  {
-    std::lock_guard<std::mutex> lock(snapshot_mutex_);
-    outputs = latest_query_output_;
-    statuses = latest_query_status_;
-    times = latest_query_time_;
-  }
-  if (outputs.empty()) return;
-
-  std::vector<std::string> sensors;
-  sensors.reserve(outputs.size());
-  for (std::unordered_map<std::string, std::string>::const_iterator it = outputs.begin(); it != outputs.end(); ++it) {
-    sensors.push_back(it->first);
-  }
-  std::sort(sensors.begin(), sensors.end());
-
+  // 各槽位按 SensorSlot 顺序读取，不加锁、不排序；格式化在输出锁外完成。
+  const std::array<common::SensorRecord, common::kSensorSlotCount> records = sensorSnapshot();
+  std::string text;
+  for (size_t i = 0; i < records.size(); ++i) {
+    const std::string line = common::formatSensorRecord(static_cast<common::SensorSlot>(i), records[i]);
+    if (!line.empty()) text += "[snapshot] " + line;
+  }
+  if (text.empty()) return;
   std::lock_guard<std::mutex> lock(output_mutex_);
-  for (size_t i = 0; i < sensors.size(); ++i) {
-    const std::string& sensor = sensors[i];
-    const Status& s = statuses[sensor];
-    const std::time_t t = std::chrono::system_clock::to_time_t(times[sensor]);
-    const std::string ts = std::string(std::ctime(&t));
-    std::cout << "[snapshot] " << sensor
-              << " ok=" << (s.ok ? "true" : "false")
-              << " time=" << (ts.empty() ? "" : ts.substr(11, 8)) << "\n";
-    const std::string& out = outputs[sensor];
-    if (!out.empty()) {
-      std::cout << out;
-      if (out.back() != '\n') std::cout << "\n";
-    } else if (!s.ok) {
-      std::cout << "  " << s.message << "\n";
-    } else {
-      std::cout << "  (no output)\n";
-    }
-  }
+  std::cout << text;
 }
 
 Status Interface::start() {
@@ -1337,6 +1775,9 @@ Status Interface::start() {
 #ifdef ASC_ENABLE_MULTI_TURN_ENCODER
     std::cout << "  - multi_turn_encoder: enabled=" << (multi_turn_encoder_ ? "true" : "false")
               << ", query_hz=" << encoder_defaults_.query_hz
+              << ", acquisition_mode=" << encoder_defaults_.acquisition_mode
+              << ", sample_hz=" << encoder_defaults_.sample_hz
+              << ", velocity_window=" << encoder_defaults_.velocity_window
               << ", linear_enable=" << (encoder_defaults_.linear_enable ? "true" : "false")
               << ", linear_k=" << encoder_defaults_.linear_k
               << ", linear_b=" << encoder_defaults_.linear_b << "\n";
@@ -1351,19 +1792,155 @@ Status Interface::start() {
 #endif
   }
 
+  // 各驱动在所属总线的 lane 上启动（排在 init 阶段的探测之后），超过时限的在后台继续；
+  // 启动失败的驱动只记入 driverReadiness()，不再拖住其它驱动和状态推送。
+  std::vector<BringUpStep> steps;
   for (std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::iterator it = drivers_.begin();
        it != drivers_.end(); ++it) {
-    const Status s = it->second->start();
-    if (!s.ok) return Status{false, "start failed on " + it->first + ": " + s.message};
-  }
+    const std::string name = it->first;
+    steps.push_back(BringUpStep{name, [this, name]() {
+                                  std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+                                  const auto found = drivers_.find(name);
+                                  if (found == drivers_.end()) return Status{false, "driver removed"};
+                                  return found->second->start();
+                                }});
+  }
+  runBringUp("start", steps, std::max(startup_deadline_, std::chrono::steady_clock::now() + kStartupGrace));
   startAutoQueryPolling();
   started_ = true;
+  const char* env_snapshot = std::getenv("ASC_SNAPSHOT_PRINT");
+  if (env_snapshot && std::string(env_snapshot) == "1") startSnapshotPrinter();
+  const char* env_watch = std::getenv("ASC_CONFIG_WATCH");
+  if (env_watch && std::string(env_watch) == "1") {
+    const Status watch_status = startConfigWatch();
+    if (!watch_status.ok) {
+      common::LogLine(common::LogLevel::Warn, "config-watch") << watch_status.message;
+    }
+  }
+  size_t not_ready = 0;
+  {
+    std::lock_guard<std::mutex> lock(readiness_mutex_);
+    for (const auto& kv : readiness_) {
+      if (!kv.second.finished || !kv.second.ok) ++not_ready;
+    }
+  }
+  if (not_ready > 0) {
+    return Status{true, "drivers started, " + std::to_string(not_ready) + " not ready yet (see driverReadiness)"};
+  }
   return Status{true, "all drivers started"};
 }
 
+std::string Interface::bringUpLane(const std::string& sensor) const {
+  // 编码器的连接走它自己的串口 / 端点，不占电池总线的 lane。
+  if (sensor == "multi_turn_encoder") return std::atomic_load(&bus_lanes_)->encoder_port;
+  return busLane(sensor);
+}
+
+void Interface::runBringUp(const std::string& phase,
+                           const std::vector<BringUpStep>& steps,
+                           std::chrono::steady_clock::time_point deadline) {
+  const auto begin = std::chrono::steady_clock::now();
+  std::shared_ptr<std::atomic<bool>> reported = std::make_shared<std::atomic<bool>>(false);
+  {
+    std::lock_guard<std::mutex> lock(readiness_mutex_);
+    for (size_t i = 0; i < steps.size(); ++i) {
+      DriverReadiness& r = readiness_[steps[i].name];
+      r = DriverReadiness{};
+      r.name = steps[i].name;
+      r.lane = bringUpLane(steps[i].name);
+      r.phase = phase;
+    }
+  }
+  for (size_t i = 0; i < steps.size(); ++i) {
+    const std::string name = steps[i].name;
+    const auto record = [this, name, phase, begin, reported](const Status& s) {
+      const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+      bool late = false;
+      {
+        std::lock_guard<std::mutex> lock(readiness_mutex_);
+        DriverReadiness& r = readiness_[name];
+        if (r.phase != phase || r.finished) return;  // 已被下一阶段覆盖
+        r.finished = true;
+        r.ok = s.ok;
+        r.message = s.message;
+        r.elapsed_ms = ms;
+        late = reported->load();
+      }
+      readiness_cv_.notify_all();
+      if (late) {
+        common::LogLine(s.ok ? common::LogLevel::Info : common::LogLevel::Error, "startup")
+            << (s.ok ? "✅ " : "❌ ") << name << " " << phase << " 后台完成，耗时"
+            << static_cast<int>(ms) << "ms: " << s.message;
+      }
+    };
+    if (!steps[i].run) {
+      record(Status{true, ""});  // 无需访问设备，不必排进总线 lane
+      continue;
+    }
+    const std::function<Status()> run = steps[i].run;
+    const bool queued = command_executor_.post(
+        bringUpLane(name),
+        [run, record]() { record(run()); },
+        [record]() { record(Status{false, "cancelled: sdk stopping"}); });
+    if (!queued) record(Status{false, "rejected: sdk stopping"});
+  }
+
+  std::vector<DriverReadiness> view;
+  {
+    std::unique_lock<std::mutex> lock(readiness_mutex_);
+    readiness_cv_.wait_until(lock, deadline, [&]() {
+      for (size_t i = 0; i < steps.size(); ++i) {
+        if (!readiness_[steps[i].name].finished) return false;
+      }
+      return true;
+    });
+    // 此后完成的步骤由 record 自己打日志
+    reported->store(true);
+    for (size_t i = 0; i < steps.size(); ++i) view.push_back(readiness_[steps[i].name]);
+  }
+  std::sort(view.begin(), view.end(),
+            [](const DriverReadiness& a, const DriverReadiness& b) { return a.name < b.name; });
+  const double waited_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+  size_t ready = 0;
+  for (size_t i = 0; i < view.size(); ++i) {
+    if (view[i].finished && view[i].ok) ++ready;
+  }
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  std::cout << "[bring-up] " << phase << ": " << ready << "/" << view.size() << " ready after "
+            << static_cast<int>(waited_ms) << "ms\n";
+  for (size_t i = 0; i < view.size(); ++i) {
+    const DriverReadiness& r = view[i];
+    std::cout << "  - " << r.name << ": ";
+    if (!r.finished) {
+      std::cout << "pending (continues in background)";
+    } else {
+      std::cout << (r.ok ? "ready" : "failed") << " in " << static_cast<int>(r.elapsed_ms) << "ms";
+      if (!r.message.empty()) std::cout << " (" << r.message << ")";
+    }
+    std::cout << ", lane=" << r.lane << "\n";
+  }
+}
+
+std::vector<Interface::DriverReadiness> Interface::driverReadiness() const {
+  std::vector<DriverReadiness> out;
+  std::lock_guard<std::mutex> lock(readiness_mutex_);
+  out.reserve(readiness_.size());
+  for (const auto& kv : readiness_) out.push_back(kv.second);
+  return out;
+}
+
+bool Interface::driverReady(const std::string& name) const {
+  std::lock_guard<std::mutex> lock(readiness_mutex_);
+  const auto it = readiness_.find(name);
+  return it != readiness_.end() && it->second.finished && it->second.ok;
+}
+
 Status Interface::stop() {
   if (!initialized_) return Status{false, "sdk not initialized"};
   if (!started_) return Status{true, "all drivers already stopped"};
+  command_executor_.stop();
+  stopConfigWatch();
   stopAutoQueryPolling();
   stopSnapshotPrinter();
   for (std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::iterator it = drivers_.begin();
@@ -1377,148 +1954,317 @@ Status Interface::stop() {
 
 Status Interface::query(const std::string& sensor, const std::vector<std::string>& args) {
   if (!initialized_) return Status{false, "sdk not initialized"};
+  std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
   std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::iterator it = drivers_.find(sensor);
   if (it == drivers_.end()) return Status{false, "sensor not enabled or unknown sensor"};
   return it->second->query(args);
 }
 
+std::future<Status> Interface::queryAsync(const std::string& sensor, const std::vector<std::string>& args) {
+  std::shared_ptr<std::promise<Status>> promise = std::make_shared<std::promise<Status>>();
+  std::future<Status> future = promise->get_future();
+  queryAsync(sensor, args, [promise](const Status& s) { promise->set_value(s); });
+  return future;
+}
 
-Status Interface::init() {
-  if (initialized_) {
-    return Status{true, "ai_safety_controller sdk already initialized"};
+void Interface::queryAsync(const std::string& sensor,
+                           const std::vector<std::string>& args,
+                           std::function<void(const Status&)> done) {
+  if (!done) done = [](const Status&) {};
+  if (!initialized_) {
+    done(Status{false, "sdk not initialized"});
+    return;
+  }
+  std::shared_ptr<std::function<void(const Status&)>> callback =
+      std::make_shared<std::function<void(const Status&)>>(std::move(done));
+  // query() takes the drivers lock itself, so a reload between submission and
+  // execution simply runs the command against the new driver instance.
+  const bool queued = command_executor_.post(
+      busLane(sensor),
+      [this, sensor, args, callback]() { (*callback)(query(sensor, args)); },
+      [callback]() { (*callback)(Status{false, "command cancelled: sdk stopping"}); });
+  if (!queued) (*callback)(Status{false, "command rejected: sdk stopping"});
+}
+
+std::future<common::QueryResult> Interface::queryResultAsync(const std::string& sensor,
+                                                             const std::vector<std::string>& args) {
+  std::shared_ptr<std::promise<common::QueryResult>> promise =
+      std::make_shared<std::promise<common::QueryResult>>();
+  std::future<common::QueryResult> future = promise->get_future();
+  const auto fail = [promise, sensor](const std::string& message) {
+    common::QueryResult result;
+    result.sensor = sensor;
+    result.status = Status{false, message};
+    result.finished_at = std::chrono::system_clock::now();
+    promise->set_value(result);
+  };
+  if (!initialized_) {
+    fail("sdk not initialized");
+    return future;
   }
+  const bool queued = command_executor_.post(
+      busLane(sensor),
+      [this, sensor, args, promise]() { promise->set_value(queryResult(sensor, args)); },
+      [fail]() { fail("command cancelled: sdk stopping"); });
+  if (!queued) fail("command rejected: sdk stopping");
+  return future;
+}
 
-  const Status cfg_status = loadDefaultConfigIfPresent();
-  if (!cfg_status.ok) return cfg_status;
 
 #ifdef ASC_ENABLE_BATTERY
-  if (battery_defaults_.enable) {
-    battery_ = std::make_unique<battery::BatteryCore>(
-        battery_defaults_.module_ip,
-        static_cast<uint16_t>(battery_defaults_.module_port),
-        static_cast<uint8_t>(battery_defaults_.module_slave_id),
-        static_cast<uint8_t>(battery_defaults_.battery_slave_id),
-        battery::BatteryCore::RetryPolicy{
-            battery_defaults_.retry_policy.max_retries,
-            battery_defaults_.retry_policy.base_backoff_ms,
-            battery_defaults_.retry_policy.max_backoff_ms,
-            battery_defaults_.retry_policy.jitter_ms,
-            battery_defaults_.retry_policy.log_enabled});
-    battery_->setChargeTimeDebugEnabled(battery_defaults_.charge_time_debug);
-  }
+void Interface::createBatteryDriver() {
+  battery_.reset();
+  if (!battery_defaults_.enable) return;
+  battery_ = std::make_unique<battery::BatteryCore>(
+      battery_defaults_.module_ip,
+      static_cast<uint16_t>(battery_defaults_.module_port),
+      static_cast<uint8_t>(battery_defaults_.module_slave_id),
+      static_cast<uint8_t>(battery_defaults_.battery_slave_id),
+      battery::BatteryCore::RetryPolicy{
+          battery_defaults_.retry_policy.max_retries,
+          battery_defaults_.retry_policy.base_backoff_ms,
+          battery_defaults_.retry_policy.max_backoff_ms,
+          battery_defaults_.retry_policy.jitter_ms,
+          battery_defaults_.retry_policy.log_enabled});
+  battery_->setChargeTimeDebugEnabled(battery_defaults_.charge_time_debug);
+  battery_->setReadGapTolerance(battery_defaults_.read_gap_tolerance);
+}
 #endif
+
 #ifdef ASC_ENABLE_HOIST_HOOK
-  if (hoist_hook_defaults_.enable) {
-    if (hoist_hook_defaults_.transport == "rtu") {
-      hoist_hook_ = std::make_unique<hoist_hook::HoistHookCore>(
-          hoist_hook_defaults_.device,
-          hoist_hook_defaults_.baud,
-          hoist_hook_defaults_.parity,
-          hoist_hook_defaults_.data_bit,
-          hoist_hook_defaults_.stop_bit,
-          static_cast<uint8_t>(hoist_hook_defaults_.hook_slave_id),
-          static_cast<uint8_t>(hoist_hook_defaults_.power_slave_id),
-          hoist_hook::HoistHookCore::RetryPolicy{
-              hoist_hook_defaults_.retry_policy.max_retries,
-              hoist_hook_defaults_.retry_policy.base_backoff_ms,
-              hoist_hook_defaults_.retry_policy.max_backoff_ms,
-              hoist_hook_defaults_.retry_policy.jitter_ms,
-              hoist_hook_defaults_.retry_policy.log_enabled});
-    } else {
-      hoist_hook_ = std::make_unique<hoist_hook::HoistHookCore>(
-          hoist_hook_defaults_.module_ip,
-          static_cast<uint16_t>(hoist_hook_defaults_.module_port),
-          static_cast<uint8_t>(hoist_hook_defaults_.hook_slave_id),
-          static_cast<uint8_t>(hoist_hook_defaults_.power_slave_id),
-          hoist_hook::HoistHookCore::RetryPolicy{
-              hoist_hook_defaults_.retry_policy.max_retries,
-              hoist_hook_defaults_.retry_policy.base_backoff_ms,
-              hoist_hook_defaults_.retry_policy.max_backoff_ms,
-              hoist_hook_defaults_.retry_policy.jitter_ms,
-              hoist_hook_defaults_.retry_policy.log_enabled});
-    }
-    if (hoist_hook_ && hoist_hook_defaults_.speaker_volume >= 0 &&
-        hoist_hook_defaults_.speaker_volume <= 30) {
-      // Apply startup speaker volume from config on module instantiation.
-      hoist_hook_->genericWrite(static_cast<uint16_t>(0x0067),
-                                static_cast<uint16_t>(hoist_hook_defaults_.speaker_volume),
-                                0x06,
-                                true);
-    }
-    if (hoist_hook_) {
-      hoist_hook_->configureHeartbeat(
-          hoist_hook_defaults_.heartbeat_enable,
-          hoist_hook_defaults_.heartbeat_period_ms,
-          static_cast<std::uint16_t>(hoist_hook_defaults_.heartbeat_start_value),
-          hoist_hook_defaults_.heartbeat_log_enabled);
-      hoist_hook_->configureTimeSync(
-          hoist_hook_defaults_.time_sync_enable,
-          hoist_hook_defaults_.time_sync_period_ms,
-          hoist_hook_defaults_.time_sync_log_enabled);
-    }
+void Interface::createHoistHookDriver() {
+  hoist_hook_.reset();
+  if (!hoist_hook_defaults_.enable) return;
+  if (hoist_hook_defaults_.transport == "rtu") {
+    hoist_hook_ = std::make_unique<hoist_hook::HoistHookCore>(
+        hoist_hook_defaults_.device,
+        hoist_hook_defaults_.baud,
+        hoist_hook_defaults_.parity,
+        hoist_hook_defaults_.data_bit,
+        hoist_hook_defaults_.stop_bit,
+        static_cast<uint8_t>(hoist_hook_defaults_.hook_slave_id),
+        static_cast<uint8_t>(hoist_hook_defaults_.power_slave_id),
+        hoist_hook::HoistHookCore::RetryPolicy{
+            hoist_hook_defaults_.retry_policy.max_retries,
+            hoist_hook_defaults_.retry_policy.base_backoff_ms,
+            hoist_hook_defaults_.retry_policy.max_backoff_ms,
+            hoist_hook_defaults_.retry_policy.jitter_ms,
+            hoist_hook_defaults_.retry_policy.log_enabled});
+  } else {
+    hoist_hook_ = std::make_unique<hoist_hook::HoistHookCore>(
+        hoist_hook_defaults_.module_ip,
+        static_cast<uint16_t>(hoist_hook_defaults_.module_port),
+        static_cast<uint8_t>(hoist_hook_defaults_.hook_slave_id),
+        static_cast<uint8_t>(hoist_hook_defaults_.power_slave_id),
+        hoist_hook::HoistHookCore::RetryPolicy{
+            hoist_hook_defaults_.retry_policy.max_retries,
+            hoist_hook_defaults_.retry_policy.base_backoff_ms,
+            hoist_hook_defaults_.retry_policy.max_backoff_ms,
+            hoist_hook_defaults_.retry_policy.jitter_ms,
+            hoist_hook_defaults_.retry_policy.log_enabled});
+  }
+  if (hoist_hook_) {
+    hoist_hook_->configureHeartbeat(
+        hoist_hook_defaults_.heartbeat_enable,
+        hoist_hook_defaults_.heartbeat_period_ms,
+        static_cast<std::uint16_t>(hoist_hook_defaults_.heartbeat_start_value),
+        hoist_hook_defaults_.heartbeat_log_enabled);
+    hoist_hook_->configureTimeSync(
+        hoist_hook_defaults_.time_sync_enable,
+        hoist_hook_defaults_.time_sync_period_ms,
+        hoist_hook_defaults_.time_sync_log_enabled);
+    hoist_hook_->setReadGapTolerance(hoist_hook_defaults_.read_gap_tolerance);
   }
+}
+
+// Startup speaker volume from config, written once per module instantiation.
+Status Interface::applyHoistHookSpeakerVolume() {
+  if (!hoist_hook_) return Status{false, "hoist_hook not enabled"};
+  const int volume = hoist_hook_defaults_.speaker_volume;
+  if (volume < 0 || volume > 30) return Status{true, "speaker volume: device default"};
+  // genericWrite() logs its own failures.
+  hoist_hook_->genericWrite(static_cast<uint16_t>(0x0067), static_cast<uint16_t>(volume), 0x06, true);
+  return Status{true, "speaker volume=" + std::to_string(volume)};
+}
 #endif
+
 #ifdef ASC_ENABLE_IO_RELAY
-  if (io_relay_defaults_.enable) {
-    io_relay_ = std::make_unique<io_relay::IoRelayCore>(
-        io_relay_defaults_.module_ip,
-        static_cast<uint16_t>(io_relay_defaults_.module_port),
-        static_cast<uint8_t>(io_relay_defaults_.module_slave_id),
-        io_relay::IoRelayCore::RetryPolicy{
-            io_relay_defaults_.retry_policy.max_retries,
-            io_relay_defaults_.retry_policy.base_backoff_ms,
-            io_relay_defaults_.retry_policy.max_backoff_ms,
-            io_relay_defaults_.retry_policy.jitter_ms,
-            io_relay_defaults_.retry_policy.log_enabled});
-    if (io_relay_defaults_.battery_button_relay_channels.empty()) {
-      std::cout << "[io_relay] battery_button_relay_channels is empty, "
-                   "battery button control is disabled\n";
-    } else {
-      std::cout << "[io_relay] battery_button_relay_channels:";
-      for (size_t i = 0; i < io_relay_defaults_.battery_button_relay_channels.size(); ++i) {
-        std::cout << (i == 0 ? " " : ", ")
-                  << io_relay_defaults_.battery_button_relay_channels[i];
-      }
-      std::cout << "\n";
+void Interface::createIoRelayDriver() {
+  io_relay_.reset();
+  if (!io_relay_defaults_.enable) return;
+  io_relay_ = std::make_unique<io_relay::IoRelayCore>(
+      io_relay_defaults_.module_ip,
+      static_cast<uint16_t>(io_relay_defaults_.module_port),
+      static_cast<uint8_t>(io_relay_defaults_.module_slave_id),
+      io_relay::IoRelayCore::RetryPolicy{
+          io_relay_defaults_.retry_policy.max_retries,
+          io_relay_defaults_.retry_policy.base_backoff_ms,
+          io_relay_defaults_.retry_policy.max_backoff_ms,
+          io_relay_defaults_.retry_policy.jitter_ms,
+          io_relay_defaults_.retry_policy.log_enabled});
+  if (io_relay_defaults_.battery_button_relay_channels.empty()) {
+    std::cout << "[io_relay] battery_button_relay_channels is empty, "
+                 "battery button control is disabled\n";
+  } else {
+    std::cout << "[io_relay] battery_button_relay_channels:";
+    for (size_t i = 0; i < io_relay_defaults_.battery_button_relay_channels.size(); ++i) {
+      std::cout << (i == 0 ? " " : ", ")
+                << io_relay_defaults_.battery_button_relay_channels[i];
     }
+    std::cout << "\n";
   }
+}
 #endif
+
 #ifdef ASC_ENABLE_MULTI_TURN_ENCODER
-  if (encoder_defaults_.enable) {
-    if (encoder_defaults_.transport == "tcp") {
-      multi_turn_encoder_ = std::make_unique<multi_turn_encoder::MultiTurnEncoderCore>(
-          encoder_defaults_.ip, encoder_defaults_.port, encoder_defaults_.slave);
+void Interface::createEncoderDriver() {
+  multi_turn_encoder_.reset();
+  if (!encoder_defaults_.enable) return;
+  if (encoder_defaults_.transport == "tcp") {
+    multi_turn_encoder_ = std::make_unique<multi_turn_encoder::MultiTurnEncoderCore>(
+        encoder_defaults_.ip, encoder_defaults_.port, encoder_defaults_.slave);
+  } else {
+    multi_turn_encoder_ = std::make_unique<multi_turn_encoder::MultiTurnEncoderCore>(
+        encoder_defaults_.device,
+        encoder_defaults_.baud,
+        encoder_defaults_.parity,
+        encoder_defaults_.data_bit,
+        encoder_defaults_.stop_bit,
+        encoder_defaults_.slave);
+  }
+  if (multi_turn_encoder_) {
+    multi_turn_encoder_->setLinearTransform(
+        encoder_defaults_.linear_enable, encoder_defaults_.linear_k, encoder_defaults_.linear_b);
+    multi_turn_encoder_->setAcquisition(encoder_defaults_.acquisition_mode == "on_demand",
+                                        encoder_defaults_.sample_hz);
+    multi_turn_encoder_->setVelocityWindow(encoder_defaults_.velocity_window,
+                                           encoder_defaults_.velocity_warmup);
+  }
+}
+#endif
+
+#ifdef ASC_ENABLE_SOLAR
+void Interface::createSolarDriver() {
+  solar_.reset();
+  if (!solar_defaults_.enable) return;
+  solar_ = std::make_unique<solar::SolarCore>(
+      solar_defaults_.module_ip,
+      static_cast<uint16_t>(solar_defaults_.module_port),
+      static_cast<uint8_t>(solar_defaults_.module_slave_id),
+      static_cast<uint8_t>(solar_defaults_.solar_slave_id),
+      solar::SolarCore::RetryPolicy{
+          solar_defaults_.retry_policy.max_retries,
+          solar_defaults_.retry_policy.base_backoff_ms,
+          solar_defaults_.retry_policy.max_backoff_ms,
+          solar_defaults_.retry_policy.jitter_ms,
+          solar_defaults_.retry_policy.log_enabled});
+  solar_->setChargeSampleTimeoutSec(solar_defaults_.sample_timeout_sec);
+  solar_->setReadGapTolerance(solar_defaults_.read_gap_tolerance);
+  solar_charge_last_ok_ms_.store(0, std::memory_order_relaxed);
+}
+#endif
+
+#ifdef ASC_ENABLE_SPD_LIDAR
+std::unique_ptr<spd_lidar::SpdLidarCore> Interface::createSpdLidarCore(const SpdLidarInstanceDefaults& cfg) {
+  std::cout << "[spd_lidar:" << cfg.id << "] instantiate with mode=" << cfg.mode
+            << " local=" << cfg.local_ip << ":" << cfg.local_port
+            << " device=" << cfg.device_ip << ":" << cfg.device_port;
+  if (!cfg.role.empty()) std::cout << " role=" << cfg.role;
+  std::cout << " vertical_angle_to_vertical_deg=" << cfg.vertical_angle_to_vertical_deg << "\n";
+  std::unique_ptr<spd_lidar::SpdLidarCore> lidar = std::make_unique<spd_lidar::SpdLidarCore>();
+  const std::string id = cfg.id;
+  lidar->on_log.connect([](const std::string&) {});  // 静默，避免轮询刷屏
+  lidar->on_frame.connect([this, id, cfg](const spd_lidar::SpdLidarFrame& frame) {
+    const double distance_m = static_cast<double>(frame.data) / 10.0;
+    const bool lidar_value_valid = (frame.data != 65535u);
+    if (frame.valid_header && frame.checksum_ok) {
+      trolley_lidar_has_valid_frame_.store(true, std::memory_order_relaxed);
+    }
+    if (frame.valid_header && frame.checksum_ok && lidar_value_valid) {
+      constexpr double kPi = 3.14159265358979323846;
+      const double angle_rad = cfg.vertical_angle_to_vertical_deg * kPi / 180.0;
+      const double projected_m = distance_m * std::cos(angle_rad);
+      updateCraneStateFromLidarMeasurement(id, frame.data, projected_m);
+    }
+  });
+  spd_lidar::SpdLidarCore* lidar_raw = lidar.get();
+  lidar->on_send.connect([this, cfg, id, lidar_raw](const std::vector<uint8_t>& req) {
+    std::vector<uint8_t> resp;
+    std::string err;
+    // server 模式只负责非阻塞发出请求，应答由 reactor 线程收到后直接喂给 handleRecvBytes，
+    // 因此 send all 时各实例的测距是并发进行的。
+    const bool ok = (cfg.mode == "server") ? spdLidarServerSend(cfg, req, &err)
+                                           : spdLidarExchange(cfg, req, &resp, &err);
+    if (!ok) {
+      if (cfg.mode == "server" && (err == "accept timeout" || err == "client not connected")) {
+        bool should_log = false;
+        {
+          std::lock_guard<std::mutex> lock(spd_lidar_log_mutex_);
+          if (spd_lidar_wait_logged_.insert(id).second) {
+            should_log = true;
+          }
+        }
+        if (should_log) {
+          common::LogLine(common::LogLevel::Info, "spd_lidar")
+              << id << ": waiting client connection at " << cfg.local_ip << ":" << cfg.local_port;
+        }
+      } else {
+        common::LogLine(common::LogLevel::Error, "spd_lidar") << id << ": net error: " << err;
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(spd_lidar_log_mutex_);
+      spd_lidar_wait_logged_.erase(id);
+    }
+    if (cfg.mode == "server") return;
+    if (!resp.empty()) {
+      lidar_raw->handleRecvBytes(resp.data(), resp.size());
     } else {
-      multi_turn_encoder_ = std::make_unique<multi_turn_encoder::MultiTurnEncoderCore>(
-          encoder_defaults_.device,
-          encoder_defaults_.baud,
-          encoder_defaults_.parity,
-          encoder_defaults_.data_bit,
-          encoder_defaults_.stop_bit,
-          encoder_defaults_.slave);
+      common::LogLine(common::LogLevel::Error, "spd_lidar") << id << ": net error: empty response";
     }
-    if (multi_turn_encoder_) {
-      multi_turn_encoder_->setLinearTransform(
-          encoder_defaults_.linear_enable, encoder_defaults_.linear_k, encoder_defaults_.linear_b);
+  });
+  return lidar;
+}
+#endif
+
+Status Interface::init() {
+  if (initialized_) {
+    return Status{true, "ai_safety_controller sdk already initialized"};
+  }
+
+  startup_deadline_ = std::chrono::steady_clock::now() + startupBudget();
+  const Status cfg_status = loadDefaultConfigIfPresent();
+  if (!cfg_status.ok) return cfg_status;
+
+  // Gateway transport mode must be in place before any driver sends a request.
+  for (size_t i = 0; i < modbus_gateways_.size(); ++i) {
+    const ModbusGatewayDefaults& gw = modbus_gateways_[i];
+    common::ModbusTcpPipeline::instance().configure(
+        gw.module_ip, static_cast<uint16_t>(gw.module_port), gw.pipelined, gw.max_in_flight);
+    common::GatewayScheduler::instance().configure(
+        common::ModbusTcpConnectionPool::endpointKey(gw.module_ip, static_cast<uint16_t>(gw.module_port)),
+        static_cast<std::uint32_t>(gw.background_backlog_limit));
+    if (gw.pipelined) {
+      std::cout << "[modbus] gateway " << gw.module_ip << ":" << gw.module_port
+                << " pipelined, max_in_flight=" << gw.max_in_flight << "\n";
     }
   }
+
+#ifdef ASC_ENABLE_BATTERY
+  createBatteryDriver();
+#endif
+#ifdef ASC_ENABLE_HOIST_HOOK
+  createHoistHookDriver();
+#endif
+#ifdef ASC_ENABLE_IO_RELAY
+  createIoRelayDriver();
+#endif
+#ifdef ASC_ENABLE_MULTI_TURN_ENCODER
+  createEncoderDriver();
 #endif
 #ifdef ASC_ENABLE_SOLAR
-  if (solar_defaults_.enable) {
-    solar_ = std::make_unique<solar::SolarCore>(
-        solar_defaults_.module_ip,
-        static_cast<uint16_t>(solar_defaults_.module_port),
-        static_cast<uint8_t>(solar_defaults_.module_slave_id),
-        static_cast<uint8_t>(solar_defaults_.solar_slave_id),
-        solar::SolarCore::RetryPolicy{
-            solar_defaults_.retry_policy.max_retries,
-            solar_defaults_.retry_policy.base_backoff_ms,
-            solar_defaults_.retry_policy.max_backoff_ms,
-            solar_defaults_.retry_policy.jitter_ms,
-            solar_defaults_.retry_policy.log_enabled});
-    solar_->setChargeSampleTimeoutSec(solar_defaults_.sample_timeout_sec);
-    solar_charge_last_ok_ms_.store(0, std::memory_order_relaxed);
-  }
+  createSolarDriver();
 #endif
 #ifdef ASC_ENABLE_SPD_LIDAR
   if (spd_lidar_instances_.empty()) {
@@ -1528,60 +2274,7 @@ Status Interface::init() {
   for (size_t i = 0; i < spd_lidar_instances_.size(); ++i) {
     const SpdLidarInstanceDefaults& cfg = spd_lidar_instances_[i];
     if (!cfg.enable) continue;
-    std::cout << "[spd_lidar:" << cfg.id << "] instantiate with mode=" << cfg.mode
-              << " local=" << cfg.local_ip << ":" << cfg.local_port
-              << " device=" << cfg.device_ip << ":" << cfg.device_port;
-    if (!cfg.role.empty()) std::cout << " role=" << cfg.role;
-    std::cout << " vertical_angle_to_vertical_deg=" << cfg.vertical_angle_to_vertical_deg << "\n";
-    std::unique_ptr<spd_lidar::SpdLidarCore> lidar = std::make_unique<spd_lidar::SpdLidarCore>();
-    const std::string id = cfg.id;
-    lidar->on_log.connect([](const std::string&) {});  // 静默，避免轮询刷屏
-    lidar->on_frame.connect([this, id, cfg](const spd_lidar::SpdLidarFrame& frame) {
-      const double distance_m = static_cast<double>(frame.data) / 10.0;
-      const bool lidar_value_valid = (frame.data != 65535u);
-      if (frame.valid_header && frame.checksum_ok) {
-        trolley_lidar_has_valid_frame_.store(true, std::memory_order_relaxed);
-      }
-      if (frame.valid_header && frame.checksum_ok && lidar_value_valid) {
-        constexpr double kPi = 3.14159265358979323846;
-        const double angle_rad = cfg.vertical_angle_to_vertical_deg * kPi / 180.0;
-        const double projected_m = distance_m * std::cos(angle_rad);
-        updateCraneStateFromLidarMeasurement(id, frame.data, projected_m);
-      }
-    });
-    spd_lidar::SpdLidarCore* lidar_raw = lidar.get();
-    lidar->on_send.connect([this, cfg, id, lidar_raw](const std::vector<uint8_t>& req) {
-      std::vector<uint8_t> resp;
-      std::string err;
-      if (!spdLidarExchange(cfg, req, &resp, &err)) {
-        if (cfg.mode == "server" && (err == "accept timeout" || err == "client not connected")) {
-          bool should_log = false;
-          {
-            std::lock_guard<std::mutex> lock(spd_lidar_log_mutex_);
-            if (spd_lidar_wait_logged_.insert(id).second) {
-              should_log = true;
-            }
-          }
-          if (should_log) {
-            std::cout << "[spd_lidar:" << id << "] waiting client connection at "
-                      << cfg.local_ip << ":" << cfg.local_port << "\n";
-          }
-        } else {
-          std::cout << "[spd_lidar:" << id << "] net error: " << err << "\n";
-        }
-        return;
-      }
-      {
-        std::lock_guard<std::mutex> lock(spd_lidar_log_mutex_);
-        spd_lidar_wait_logged_.erase(id);
-      }
-      if (!resp.empty()) {
-        lidar_raw->handleRecvBytes(resp.data(), resp.size());
-      } else {
-        std::cout << "[spd_lidar:" << id << "] net error: empty response\n";
-      }
-    });
-    spd_lidar_instances_core_[id] = std::move(lidar);
+    spd_lidar_instances_core_[cfg.id] = createSpdLidarCore(cfg);
   }
 #endif
 
@@ -1626,6 +2319,46 @@ Status Interface::init() {
     if (!s.ok) return Status{false, "init failed on " + it->first + ": " + s.message};
   }
 
+  // 需要访问设备的探测（喇叭音量、继电器上电稳定窗口与输出映像、编码器连接）按总线并行，
+  // 同一总线上依次进行；只等到启动时限，剩下的在后台完成。
+  std::vector<BringUpStep> steps;
+  for (std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::iterator it = drivers_.begin();
+       it != drivers_.end(); ++it) {
+    const std::string name = it->first;
+    std::function<Status()> probe;
+#ifdef ASC_ENABLE_HOIST_HOOK
+    if (name == "hoist_hook") probe = [this]() { return applyHoistHookSpeakerVolume(); };
+#endif
+#ifdef ASC_ENABLE_IO_RELAY
+    if (name == "io_relay") {
+      probe = [this]() {
+        std::uint16_t image = 0;
+        if (!io_relay_ || !io_relay_->getRelayImage(&image)) return Status{false, "relay read failed"};
+        char text[32];
+        std::snprintf(text, sizeof(text), "relays=0x%04x", static_cast<unsigned>(image));
+        return Status{true, text};
+      };
+    }
+#endif
+#ifdef ASC_ENABLE_MULTI_TURN_ENCODER
+    if (name == "multi_turn_encoder") {
+      probe = [this]() {
+        if (!multi_turn_encoder_ || !multi_turn_encoder_->connect()) return Status{false, "encoder connect failed"};
+        return Status{true, "connected"};
+      };
+    }
+#endif
+    if (!probe) {
+      steps.push_back(BringUpStep{name, nullptr});
+      continue;
+    }
+    steps.push_back(BringUpStep{name, [this, probe]() {
+                                  std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+                                  return probe();
+                                }});
+  }
+  runBringUp("init", steps, startup_deadline_);
+
   initialized_ = true;
   Status status;
   status.ok = true;
@@ -1636,6 +2369,428 @@ Status Interface::init() {
   return status;
 }
 
+Status Interface::reloadConfig() {
+  std::lock_guard<std::mutex> reload_lock(reload_mutex_);
+  if (loaded_config_path_.empty()) return Status{false, "no config file loaded"};
+  const std::string path = loaded_config_path_;
+
+  // 从内置默认值重新套用配置，这样被删掉的 key 会回到默认值，与冷启动结果一致。
+  // 先解析到局部副本：轮询线程仍在读成员，解析失败时什么都不用恢复。
+  RuntimeDefaults next;
+  const Status parse_status = parseConfig(path, &next);
+  if (!parse_status.ok) {
+    return Status{false, "reload failed, keep running config: " + parse_status.message};
+  }
+  if (next.spd_lidar_instances.empty()) {
+    next.spd_lidar_instances.push_back(SpdLidarInstanceDefaults{});
+  }
+  if (!initialized_) {
+    std::unique_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+    publishDefaults(std::move(next));
+    return Status{true, "config reloaded (sdk not initialized yet)"};
+  }
+
+  std::vector<std::string> changes;
+  // 重建后需要重新 init/start 的 adapter
+  std::vector<std::string> restart;
+  // 需要访问设备的动作（写喇叭音量、重启心跳/对时），放到独占锁外执行
+  std::vector<std::function<void()>> device_io;
+
+  // 轮询任务会调用 query()，先停掉再拿独占锁，避免等待中的任务持有共享锁。
+  stopAutoQueryPolling();
+  {
+    std::unique_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+    const RuntimeDefaults old = currentDefaults();
+    const BatteryDefaults& old_battery = old.battery;
+    const SolarDefaults& old_solar = old.solar;
+    const IoRelayDefaults& old_io_relay = old.io_relay;
+    const HoistHookDefaults& old_hoist_hook = old.hoist_hook;
+    const EncoderDefaults& old_encoder = old.encoder;
+    const std::vector<SpdLidarInstanceDefaults>& old_spd_lidar = old.spd_lidar_instances;
+    const double old_spd_lidar_query_hz = old.spd_lidar_query_hz;
+    const std::vector<ModbusGatewayDefaults>& old_gateways = old.modbus_gateways;
+    publishDefaults(std::move(next));
+
+    const auto stop_adapter = [this](const std::string& name) {
+      std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::iterator it = drivers_.find(name);
+      if (started_ && it != drivers_.end()) it->second->stop();
+    };
+
+    for (size_t i = 0; i < modbus_gateways_.size(); ++i) {
+      const ModbusGatewayDefaults& gw = modbus_gateways_[i];
+      bool same = false;
+      for (size_t j = 0; j < old_gateways.size() && !same; ++j) {
+        const ModbusGatewayDefaults& old = old_gateways[j];
+        same = old.module_ip == gw.module_ip && old.module_port == gw.module_port &&
+               old.pipelined == gw.pipelined && old.max_in_flight == gw.max_in_flight &&
+               old.background_backlog_limit == gw.background_backlog_limit;
+      }
+      if (same) continue;
+      common::ModbusTcpPipeline::instance().configure(
+          gw.module_ip, static_cast<uint16_t>(gw.module_port), gw.pipelined, gw.max_in_flight);
+      common::GatewayScheduler::instance().configure(
+          common::ModbusTcpConnectionPool::endpointKey(gw.module_ip, static_cast<uint16_t>(gw.module_port)),
+          static_cast<std::uint32_t>(gw.background_backlog_limit));
+      changes.push_back("modbus gateway " + gw.module_ip + ":" + std::to_string(gw.module_port));
+    }
+    for (size_t j = 0; j < old_gateways.size(); ++j) {
+      const ModbusGatewayDefaults& old = old_gateways[j];
+      bool still_listed = false;
+      for (size_t i = 0; i < modbus_gateways_.size() && !still_listed; ++i) {
+        still_listed = modbus_gateways_[i].module_ip == old.module_ip &&
+                       modbus_gateways_[i].module_port == old.module_port;
+      }
+      if (still_listed) continue;
+      common::ModbusTcpPipeline::instance().configure(
+          old.module_ip, static_cast<uint16_t>(old.module_port), false, old.max_in_flight);
+      changes.push_back("modbus gateway " + old.module_ip + ":" + std::to_string(old.module_port) +
+                        " removed");
+    }
+
+#ifdef ASC_ENABLE_BATTERY
+    {
+      const BatteryDefaults& cur = battery_defaults_;
+      if (cur.enable != old_battery.enable || cur.module_ip != old_battery.module_ip ||
+          cur.module_port != old_battery.module_port ||
+          cur.module_slave_id != old_battery.module_slave_id ||
+          cur.battery_slave_id != old_battery.battery_slave_id) {
+        stop_adapter("battery");
+        createBatteryDriver();
+        restart.push_back("battery");
+        changes.push_back(battery_ ? "battery: recreated" : "battery: removed");
+      } else if (battery_) {
+        if (!sameRetryPolicy(cur.retry_policy, old_battery.retry_policy)) {
+          battery_->setRetryPolicy(toDriverRetryPolicy<battery::BatteryCore::RetryPolicy>(cur.retry_policy));
+          changes.push_back("battery: retry_policy");
+        }
+        if (cur.charge_time_debug != old_battery.charge_time_debug) {
+          battery_->setChargeTimeDebugEnabled(cur.charge_time_debug);
+          changes.push_back("battery: charge_time_debug");
+        }
+        if (cur.read_gap_tolerance != old_battery.read_gap_tolerance) {
+          battery_->setReadGapTolerance(cur.read_gap_tolerance);
+          changes.push_back("battery: read_gap_tolerance");
+        }
+      }
+      if (cur.query_hz != old_battery.query_hz) changes.push_back("battery: query_hz");
+    }
+#endif
+#ifdef ASC_ENABLE_SOLAR
+    {
+      const SolarDefaults& cur = solar_defaults_;
+      if (cur.enable != old_solar.enable || cur.module_ip != old_solar.module_ip ||
+          cur.module_port != old_solar.module_port ||
+          cur.module_slave_id != old_solar.module_slave_id ||
+          cur.solar_slave_id != old_solar.solar_slave_id) {
+        stop_adapter("solar");
+        createSolarDriver();
+        restart.push_back("solar");
+        changes.push_back(solar_ ? "solar: recreated" : "solar: removed");
+      } else if (solar_) {
+        if (!sameRetryPolicy(cur.retry_policy, old_solar.retry_policy)) {
+          solar_->setRetryPolicy(toDriverRetryPolicy<solar::SolarCore::RetryPolicy>(cur.retry_policy));
+          changes.push_back("solar: retry_policy");
+        }
+        if (cur.sample_timeout_sec != old_solar.sample_timeout_sec) {
+          solar_->setChargeSampleTimeoutSec(cur.sample_timeout_sec);
+          changes.push_back("solar: sample_timeout_sec");
+        }
+        if (cur.read_gap_tolerance != old_solar.read_gap_tolerance) {
+          solar_->setReadGapTolerance(cur.read_gap_tolerance);
+          changes.push_back("solar: read_gap_tolerance");
+        }
+      }
+      if (cur.query_hz != old_solar.query_hz) changes.push_back("solar: query_hz");
+    }
+#endif
+#ifdef ASC_ENABLE_IO_RELAY
+    {
+      const IoRelayDefaults& cur = io_relay_defaults_;
+      if (cur.enable != old_io_relay.enable || cur.module_ip != old_io_relay.module_ip ||
+          cur.module_port != old_io_relay.module_port ||
+          cur.module_slave_id != old_io_relay.module_slave_id) {
+        stop_adapter("io_relay");
+        createIoRelayDriver();
+        restart.push_back("io_relay");
+        changes.push_back(io_relay_ ? "io_relay: recreated" : "io_relay: removed");
+      } else if (io_relay_) {
+        if (!sameRetryPolicy(cur.retry_policy, old_io_relay.retry_policy)) {
+          io_relay_->setRetryPolicy(
+              toDriverRetryPolicy<io_relay::IoRelayCore::RetryPolicy>(cur.retry_policy));
+          changes.push_back("io_relay: retry_policy");
+        }
+      }
+      // 通道列表由 DevicesManagerClient 在初始化时缓存，这里只记录变化，重启 client 后生效。
+      if (cur.battery_button_relay_channels != old_io_relay.battery_button_relay_channels) {
+        changes.push_back("io_relay: battery_button_relay_channels");
+      }
+    }
+#endif
+#ifdef ASC_ENABLE_HOIST_HOOK
+    {
+      const HoistHookDefaults& cur = hoist_hook_defaults_;
+      const HoistHookDefaults& old = old_hoist_hook;
+      const bool link_changed =
+          cur.transport != old.transport ||
+          (cur.transport == "rtu"
+               ? (cur.device != old.device || cur.baud != old.baud || cur.parity != old.parity ||
+                  cur.data_bit != old.data_bit || cur.stop_bit != old.stop_bit)
+               : (cur.module_ip != old.module_ip || cur.module_port != old.module_port));
+      if (cur.enable != old.enable || link_changed || cur.hook_slave_id != old.hook_slave_id ||
+          cur.power_slave_id != old.power_slave_id) {
+        stop_adapter("hoist_hook");
+        createHoistHookDriver();
+        if (hoist_hook_) device_io.push_back([this]() { (void)applyHoistHookSpeakerVolume(); });
+        restart.push_back("hoist_hook");
+        changes.push_back(hoist_hook_ ? "hoist_hook: recreated" : "hoist_hook: removed");
+      } else if (hoist_hook_) {
+        if (!sameRetryPolicy(cur.retry_policy, old.retry_policy)) {
+          hoist_hook_->setRetryPolicy(
+              toDriverRetryPolicy<hoist_hook::HoistHookCore::RetryPolicy>(cur.retry_policy));
+          changes.push_back("hoist_hook: retry_policy");
+        }
+        if (cur.read_gap_tolerance != old.read_gap_tolerance) {
+          hoist_hook_->setReadGapTolerance(cur.read_gap_tolerance);
+          changes.push_back("hoist_hook: read_gap_tolerance");
+        }
+        if (cur.speaker_volume != old.speaker_volume && cur.speaker_volume >= 0 &&
+            cur.speaker_volume <= 30) {
+          device_io.push_back([this]() { (void)applyHoistHookSpeakerVolume(); });
+          changes.push_back("hoist_hook: speaker_volume");
+        }
+        const bool heartbeat_changed =
+            cur.heartbeat_enable != old.heartbeat_enable ||
+            cur.heartbeat_period_ms != old.heartbeat_period_ms ||
+            cur.heartbeat_start_value != old.heartbeat_start_value ||
+            cur.heartbeat_log_enabled != old.heartbeat_log_enabled;
+        if (heartbeat_changed) {
+          // stopHeartbeat() 要等正在进行的写完成
+          device_io.push_back([this, cur]() {
+            hoist_hook_->stopHeartbeat();
+            hoist_hook_->configureHeartbeat(cur.heartbeat_enable,
+                                            cur.heartbeat_period_ms,
+                                            static_cast<std::uint16_t>(cur.heartbeat_start_value),
+                                            cur.heartbeat_log_enabled);
+            if (started_) hoist_hook_->startHeartbeat();
+          });
+          changes.push_back("hoist_hook: heartbeat");
+        }
+        const bool time_sync_changed = cur.time_sync_enable != old.time_sync_enable ||
+                                       cur.time_sync_period_ms != old.time_sync_period_ms ||
+                                       cur.time_sync_log_enabled != old.time_sync_log_enabled;
+        if (time_sync_changed) {
+          device_io.push_back([this, cur]() {
+            hoist_hook_->stopTimeSync();
+            hoist_hook_->configureTimeSync(
+                cur.time_sync_enable, cur.time_sync_period_ms, cur.time_sync_log_enabled);
+            if (started_) hoist_hook_->startTimeSync();
+          });
+          changes.push_back("hoist_hook: time_sync");
+        }
+      }
+      if (cur.query_hz != old.query_hz) changes.push_back("hoist_hook: query_hz");
+    }
+#endif
+#ifdef ASC_ENABLE_MULTI_TURN_ENCODER
+    {
+      const EncoderDefaults& cur = encoder_defaults_;
+      const EncoderDefaults& old = old_encoder;
+      const bool link_changed =
+          cur.transport != old.transport ||
+          (cur.transport == "tcp"
+               ? (cur.ip != old.ip || cur.port != old.port)
+               : (cur.device != old.device || cur.baud != old.baud || cur.parity != old.parity ||
+                  cur.data_bit != old.data_bit || cur.stop_bit != old.stop_bit));
+      if (cur.enable != old.enable || link_changed || cur.slave != old.slave) {
+        stop_adapter("multi_turn_encoder");
+        createEncoderDriver();
+        restart.push_back("multi_turn_encoder");
+        changes.push_back(multi_turn_encoder_ ? "multi_turn_encoder: recreated"
+                                              : "multi_turn_encoder: removed");
+      } else if (multi_turn_encoder_) {
+        if (cur.linear_enable != old.linear_enable || cur.linear_k != old.linear_k ||
+            cur.linear_b != old.linear_b) {
+          multi_turn_encoder_->setLinearTransform(cur.linear_enable, cur.linear_k, cur.linear_b);
+          changes.push_back("multi_turn_encoder: linear");
+        }
+        const bool acquisition_changed =
+            cur.acquisition_mode != old.acquisition_mode || cur.sample_hz != old.sample_hz;
+        const bool velocity_changed = cur.velocity_window != old.velocity_window ||
+                                      cur.velocity_warmup != old.velocity_warmup;
+        if (acquisition_changed || velocity_changed) {
+          // 采样策略与速度窗口都要求在 run() 之前设置；串口保持打开，只重启采样线程。
+          const bool was_running = multi_turn_encoder_->isRunning();
+          multi_turn_encoder_->stop();
+          if (acquisition_changed) {
+            multi_turn_encoder_->setAcquisition(cur.acquisition_mode == "on_demand", cur.sample_hz);
+            changes.push_back("multi_turn_encoder: acquisition");
+          }
+          if (velocity_changed) {
+            multi_turn_encoder_->setVelocityWindow(cur.velocity_window, cur.velocity_warmup);
+            changes.push_back("multi_turn_encoder: velocity_window");
+          }
+          if (was_running) multi_turn_encoder_->run();
+        }
+      }
+      if (cur.query_hz != old.query_hz) changes.push_back("multi_turn_encoder: query_hz");
+    }
+#endif
+#ifdef ASC_ENABLE_SPD_LIDAR
+    {
+      std::vector<std::string> changed_ids;
+      std::unordered_set<std::string> live_ids;
+      for (size_t i = 0; i < spd_lidar_instances_.size(); ++i) {
+        const SpdLidarInstanceDefaults& cfg = spd_lidar_instances_[i];
+        if (cfg.enable) live_ids.insert(cfg.id);
+        bool same = false;
+        for (size_t j = 0; j < old_spd_lidar.size() && !same; ++j) {
+          same = sameSpdLidarInstance(cfg, old_spd_lidar[j]);
+        }
+        if (!same) changed_ids.push_back(cfg.id);
+      }
+      for (size_t j = 0; j < old_spd_lidar.size(); ++j) {
+        if (old_spd_lidar[j].enable && live_ids.find(old_spd_lidar[j].id) == live_ids.end()) {
+          changed_ids.push_back(old_spd_lidar[j].id);
+        }
+      }
+      if (!changed_ids.empty()) {
+        // 监听端点由同一个 reactor 管理，实例集合变化时整体重启 reactor；
+        // 未变化的实例保留原 SpdLidarCore 及其解析状态。
+        if (started_) stopSpdLidarServers();
+        std::unordered_set<std::string> changed(changed_ids.begin(), changed_ids.end());
+        for (std::unordered_map<std::string, std::unique_ptr<spd_lidar::SpdLidarCore>>::iterator it =
+                 spd_lidar_instances_core_.begin();
+             it != spd_lidar_instances_core_.end();) {
+          if (changed.count(it->first) != 0 || live_ids.count(it->first) == 0) {
+            it = spd_lidar_instances_core_.erase(it);
+          } else {
+            ++it;
+          }
+        }
+        for (size_t i = 0; i < spd_lidar_instances_.size(); ++i) {
+          const SpdLidarInstanceDefaults& cfg = spd_lidar_instances_[i];
+          if (!cfg.enable || spd_lidar_instances_core_.count(cfg.id) != 0) continue;
+          spd_lidar_instances_core_[cfg.id] = createSpdLidarCore(cfg);
+        }
+        {
+          std::lock_guard<std::mutex> lock(spd_lidar_log_mutex_);
+          spd_lidar_wait_logged_.clear();
+        }
+        restart.push_back("spd_lidar");
+        for (size_t i = 0; i < changed_ids.size(); ++i) {
+          changes.push_back("spd_lidar:" + changed_ids[i]);
+        }
+      }
+      if (spd_lidar_query_hz_ != old_spd_lidar_query_hz) changes.push_back("spd_lidar: query_hz");
+    }
+#endif
+
+    buildDriverAdapters();
+  }
+
+  // 驱动集合已经发布；重建的驱动连接设备和上面收集的设备写都只持共享锁，
+  // 不阻塞 query()。drivers_ 只由 reloadConfig() 改动，reload_mutex_ 保证这期间不变。
+  {
+    std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+    for (size_t i = 0; i < restart.size(); ++i) {
+      std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::iterator it = drivers_.find(restart[i]);
+      if (it == drivers_.end()) continue;
+      Status s = it->second->init();
+      if (s.ok && started_) s = it->second->start();
+      if (!s.ok) changes.push_back(restart[i] + ": restart failed: " + s.message);
+    }
+    for (size_t i = 0; i < device_io.size(); ++i) device_io[i]();
+  }
+
+  // 按新的 query_hz / 驱动集合重新排期
+  if (started_) startAutoQueryPolling();
+
+  common::LogLine(common::LogLevel::Info, "config-reload")
+      << path << ", change_count=" << changes.size();
+  for (size_t i = 0; i < changes.size(); ++i) {
+    common::LogLine(common::LogLevel::Info, "config-reload") << "  - " << changes[i];
+  }
+  return Status{true, "config reloaded: " + std::to_string(changes.size()) + " change(s)"};
+}
+
+Status Interface::startConfigWatch() {
+  if (loaded_config_path_.empty()) return Status{false, "no config file loaded"};
+  if (config_watch_running_.load()) return Status{true, "config watch already running"};
+  config_watch_wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (config_watch_wake_fd_ < 0) {
+    return Status{false, std::string("config watch eventfd failed: ") + std::strerror(errno)};
+  }
+  config_watch_running_.store(true);
+  config_watch_thread_ = std::thread(&Interface::configWatchLoop, this, loaded_config_path_);
+  return Status{true, "config watch started: " + loaded_config_path_};
+}
+
+void Interface::stopConfigWatch() {
+  if (!config_watch_running_.exchange(false)) return;
+  const std::uint64_t one = 1;
+  (void)!::write(config_watch_wake_fd_, &one, sizeof(one));
+  if (config_watch_thread_.joinable()) config_watch_thread_.join();
+  ::close(config_watch_wake_fd_);
+  config_watch_wake_fd_ = -1;
+}
+
+void Interface::configWatchLoop(const std::string& config_path) {
+  // 监视所在目录而不是文件本身：编辑器常用“写临时文件再 rename”的方式保存，
+  // 直接监视文件会在第一次替换后丢失 watch。
+  const std::filesystem::path file(config_path);
+  const std::string dir = file.has_parent_path() ? file.parent_path().string() : std::string(".");
+  const std::string name = file.filename().string();
+
+  const int inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd < 0 ||
+      ::inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+    common::LogLine(common::LogLevel::Error, "config-watch")
+        << "inotify on " << dir << " failed: " << std::strerror(errno);
+    if (inotify_fd >= 0) ::close(inotify_fd);
+    return;
+  }
+  common::LogLine(common::LogLevel::Info, "config-watch") << "watching " << config_path;
+
+  // 一次保存可能触发多个事件，静默 200ms 后再 reload 一次。
+  const std::chrono::milliseconds kDebounce(200);
+  bool pending = false;
+  std::chrono::steady_clock::time_point due{};
+  alignas(inotify_event) char buf[4096];
+
+  while (config_watch_running_.load()) {
+    int timeout_ms = -1;
+    if (pending) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          due - std::chrono::steady_clock::now());
+      timeout_ms = static_cast<int>(std::max<std::int64_t>(0, left.count()));
+    }
+    pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {config_watch_wake_fd_, POLLIN, 0}};
+    const int n = ::poll(fds, 2, timeout_ms);
+    if (n < 0 && errno != EINTR) break;
+    if (!config_watch_running_.load()) break;
+
+    if (n > 0 && (fds[0].revents & POLLIN)) {
+      ssize_t len = 0;
+      while ((len = ::read(inotify_fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t off = 0; off < len;) {
+          const inotify_event* ev = reinterpret_cast<const inotify_event*>(buf + off);
+          if (ev->len > 0 && name == ev->name) {
+            pending = true;
+            due = std::chrono::steady_clock::now() + kDebounce;
+          }
+          off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+        }
+      }
+    }
+    if (pending && std::chrono::steady_clock::now() >= due) {
+      pending = false;
+      const Status s = reloadConfig();
+      if (!s.ok) common::LogLine(common::LogLevel::Warn, "config-watch") << s.message;
+    }
+  }
+  ::close(inotify_fd);
+}
+
 std::vector<std::string> Interface::enabledSensors() const {
   std::vector<std::string> out;
   for (std::unordered_map<std::string, std::unique_ptr<DriverAdapter>>::const_iterator it = drivers_.begin();
@@ -1701,23 +2856,34 @@ void Interface::updateSolarChargeStateFromDriver() {
   const std::int64_t stale_timeout_ms = static_cast<std::int64_t>(
       std::max(100, solar_defaults_.stale_timeout_ms));
   DeviceStatus data = getDeviceStatus();
+  // The solar lane owns solarCharge only.
+  const auto publish = [&]() {
+    mergeDeviceStatus([&](DeviceStatus* d) {
+      d->solarCharge = data.solarCharge;
+    });
+  };
   if (!solar_) {
     if (solar_defaults_.enable) {
       data.solarCharge = DeviceStatus::SolarChargeState::Fault;
     }
-    setDeviceStatus(data);
+    publish();
     return;
   }
 
   // Rule 1: if trolley battery is already offline, solar state is considered faulted.
   if (data.trolleyState == DeviceStatus::EquipmentState::Offline) {
     data.solarCharge = DeviceStatus::SolarChargeState::Fault;
-    setDeviceStatus(data);
+    publish();
     return;
   }
 
   solar::SolarCore::ChargeStatusSample sample;
-  if (!solar_->readChargeStatusSample(&sample) || !sample.ok) {
+  const auto read_started = std::chrono::steady_clock::now();
+  const bool sample_ok = solar_->readChargeStatusSample(&sample) && sample.ok;
+  sensor_snapshot_.recordPoll(common::SensorSlot::Solar, sample_ok, "poll charge", "battery_current_a",
+                              sample.battery_current_a, elapsedSince(read_started),
+                              "read charge status failed");
+  if (!sample_ok) {
     const std::int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                                     std::chrono::steady_clock::now().time_since_epoch())
                                     .count();
@@ -1726,7 +2892,7 @@ void Interface::updateSolarChargeStateFromDriver() {
     if (stale) {
       data.solarCharge = DeviceStatus::SolarChargeState::Fault;
     }
-    setDeviceStatus(data);
+    publish();
     return;
   }
 
@@ -1742,7 +2908,7 @@ void Interface::updateSolarChargeStateFromDriver() {
   } else {
     data.solarCharge = DeviceStatus::SolarChargeState::NotCharging;
   }
-  setDeviceStatus(data);
+  publish();
 }
 
 Status Interface::querySolar(const std::vector<std::string>& args) {
@@ -1847,7 +3013,16 @@ Status Interface::queryIoRelay(const std::vector<std::string>& args) {
   if (args.empty()) return Status{false, "missing command"};
   const std::string& cmd = args[0];
   if (cmd == "on" || cmd == "off") {
-    if (args.size() < 2) return Status{false, "usage: io_relay on|off <channel>"};
+    if (args.size() < 2) return Status{false, "usage: io_relay on|off <channel>[,<channel>...]"};
+    if (args[1].find(',') != std::string::npos) {
+      // 多路一起切换：FC0F 批量写 + 一次 FC01 回读
+      std::uint16_t mask = 0;
+      if (!io_relay::IoRelayCore::parseRelayMask(args[1], &mask)) return Status{false, "invalid channel"};
+      if (!io_relay_->controlRelays(mask, cmd == "on")) {
+        return Status{false, "io_relay control failed"};
+      }
+      return Status{true, "ok"};
+    }
     int ch = 0;
     if (!parseInt(args[1], &ch)) return Status{false, "invalid channel"};
     if (!io_relay_->controlRelay(ch, cmd)) {
@@ -1953,9 +3128,27 @@ Status Interface::startSpdLidarServers() {
     }
   }
 
+  // 所有监听 / 连接 fd 由同一个 epoll reactor 线程管理，eventfd 用于 stop 时唤醒。
+  const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) {
+    return Status{false, std::string("spd_lidar epoll_create1 failed: ") + std::strerror(errno)};
+  }
+  const int wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd < 0) {
+    const std::string reason = std::strerror(errno);
+    ::close(epoll_fd);
+    return Status{false, "spd_lidar eventfd failed: " + reason};
+  }
+  epoll_event wake_ev{};
+  wake_ev.events = EPOLLIN;
+  wake_ev.data.fd = wake_fd;
+  ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &wake_ev);
+
   std::vector<std::string> endpoint_keys;
   {
     std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+    spd_lidar_epoll_fd_ = epoll_fd;
+    spd_lidar_wake_fd_ = wake_fd;
     spd_lidar_server_running_ = true;
     for (std::unordered_map<std::string, SpdLidarServerEndpointState>::iterator it =
              spd_lidar_server_endpoints_.begin();
@@ -1984,6 +3177,7 @@ Status Interface::startSpdLidarServers() {
       stopSpdLidarServers();
       return Status{false, "spd_lidar listen failed on " + key + ": " + error};
     }
+    setFdNonBlocking(listen_fd);
 
     {
       std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
@@ -1993,47 +3187,68 @@ Status Interface::startSpdLidarServers() {
         ::close(listen_fd);
         continue;
       }
-      it->second.listen_fd = listen_fd;
-      if (!actual_bind_ip.empty()) it->second.bind_ip = actual_bind_ip;
-      it->second.accept_thread = std::thread([this, key]() { spdLidarAcceptLoop(key); });
-      std::cout << "[spd_lidar] listening at " << it->second.bind_ip << ":" << it->second.bind_port
-                << " for " << it->second.instance_ids.size() << " instance(s)\n";
+      epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.fd = listen_fd;
+      if (::epoll_ctl(spd_lidar_epoll_fd_, EPOLL_CTL_ADD, listen_fd, &ev) != 0) {
+        error = std::string("epoll_ctl failed: ") + std::strerror(errno);
+        ::close(listen_fd);
+      } else {
+        it->second.listen_fd = listen_fd;
+        if (!actual_bind_ip.empty()) it->second.bind_ip = actual_bind_ip;
+        std::cout << "[spd_lidar] listening at " << it->second.bind_ip << ":" << it->second.bind_port
+                  << " for " << it->second.instance_ids.size() << " instance(s)\n";
+      }
+    }
+    if (!error.empty()) {
+      stopSpdLidarServers();
+      return Status{false, "spd_lidar listen failed on " + key + ": " + error};
     }
   }
 
+  spd_lidar_reactor_thread_ = std::thread([this]() { spdLidarReactorLoop(); });
   return Status{true, "spd_lidar listeners started"};
 }
 
 Status Interface::stopSpdLidarServers() {
-  std::vector<std::thread> threads;
   {
     std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
     spd_lidar_server_running_ = false;
-    for (std::unordered_map<std::string, SpdLidarServerEndpointState>::iterator it =
-             spd_lidar_server_endpoints_.begin();
-         it != spd_lidar_server_endpoints_.end(); ++it) {
-      if (it->second.listen_fd >= 0) {
-        ::close(it->second.listen_fd);
-        it->second.listen_fd = -1;
-      }
-      if (it->second.accept_thread.joinable()) {
-        threads.push_back(std::move(it->second.accept_thread));
-      }
+    if (spd_lidar_wake_fd_ >= 0) {
+      const uint64_t one = 1;
+      const ssize_t n = ::write(spd_lidar_wake_fd_, &one, sizeof(one));
+      (void)n;
     }
-    for (std::unordered_map<std::string, SpdLidarServerConnectionState>::iterator it =
-             spd_lidar_server_connections_.begin();
-         it != spd_lidar_server_connections_.end(); ++it) {
-      if (it->second.conn_fd >= 0) {
-        ::close(it->second.conn_fd);
-        it->second.conn_fd = -1;
-      }
-    }
-    spd_lidar_server_connections_.clear();
-    spd_lidar_server_endpoints_.clear();
   }
+  if (spd_lidar_reactor_thread_.joinable()) spd_lidar_reactor_thread_.join();
 
-  for (size_t i = 0; i < threads.size(); ++i) {
-    if (threads[i].joinable()) threads[i].join();
+  // reactor 已退出，此后关闭 fd 不会与 epoll_wait 竞争。
+  std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+  for (std::unordered_map<std::string, SpdLidarServerEndpointState>::iterator it =
+           spd_lidar_server_endpoints_.begin();
+       it != spd_lidar_server_endpoints_.end(); ++it) {
+    if (it->second.listen_fd >= 0) {
+      ::close(it->second.listen_fd);
+      it->second.listen_fd = -1;
+    }
+  }
+  for (std::unordered_map<std::string, SpdLidarServerConnectionState>::iterator it =
+           spd_lidar_server_connections_.begin();
+       it != spd_lidar_server_connections_.end(); ++it) {
+    if (it->second.conn_fd >= 0) {
+      ::close(it->second.conn_fd);
+      it->second.conn_fd = -1;
+    }
+  }
+  spd_lidar_server_connections_.clear();
+  spd_lidar_server_endpoints_.clear();
+  if (spd_lidar_wake_fd_ >= 0) {
+    ::close(spd_lidar_wake_fd_);
+    spd_lidar_wake_fd_ = -1;
+  }
+  if (spd_lidar_epoll_fd_ >= 0) {
+    ::close(spd_lidar_epoll_fd_);
+    spd_lidar_epoll_fd_ = -1;
   }
   return Status{true, "spd_lidar listeners stopped"};
 }
@@ -2055,114 +3270,188 @@ std::string Interface::matchSpdLidarServerInstance(const std::string& endpoint_k
   return fallback_match;
 }
 
-void Interface::spdLidarAcceptLoop(const std::string& endpoint_key) {
+void Interface::spdLidarReactorLoop() {
+  int epoll_fd = -1;
+  int wake_fd = -1;
+  {
+    std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+    epoll_fd = spd_lidar_epoll_fd_;
+    wake_fd = spd_lidar_wake_fd_;
+  }
+  if (epoll_fd < 0) return;
+
+  epoll_event events[16];
   while (spd_lidar_server_running_) {
-    int listen_fd = -1;
-    {
-      std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
-      std::unordered_map<std::string, SpdLidarServerEndpointState>::iterator it =
-          spd_lidar_server_endpoints_.find(endpoint_key);
-      if (it == spd_lidar_server_endpoints_.end()) return;
-      listen_fd = it->second.listen_fd;
-    }
-    if (listen_fd < 0) return;
-
-    fd_set read_fds;
-    FD_ZERO(&read_fds);
-    FD_SET(listen_fd, &read_fds);
-    timeval accept_tv{};
-    accept_tv.tv_sec = 1;
-    accept_tv.tv_usec = 0;
-    const int ready = ::select(listen_fd + 1, &read_fds, nullptr, nullptr, &accept_tv);
-    if (!spd_lidar_server_running_) break;
-    if (ready == 0) continue;
+    const int ready = ::epoll_wait(epoll_fd, events, 16, -1);
     if (ready < 0) {
-      if (errno == EINTR || errno == EBADF) continue;
-      std::cout << "[spd_lidar] accept loop error on " << endpoint_key
-                << ": " << std::strerror(errno) << "\n";
-      continue;
+      if (errno == EINTR) continue;
+      common::LogLine(common::LogLevel::Error, "spd_lidar")
+          << "reactor epoll_wait error: " << std::strerror(errno);
+      break;
     }
+    for (int i = 0; i < ready && spd_lidar_server_running_; ++i) {
+      const int fd = events[i].data.fd;
+      if (fd == wake_fd) {
+        uint64_t drained = 0;
+        const ssize_t n = ::read(wake_fd, &drained, sizeof(drained));
+        (void)n;
+        continue;
+      }
 
+      std::string endpoint_key;
+      std::string instance_id;
+      {
+        std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+        for (std::unordered_map<std::string, SpdLidarServerEndpointState>::const_iterator it =
+                 spd_lidar_server_endpoints_.begin();
+             it != spd_lidar_server_endpoints_.end(); ++it) {
+          if (it->second.listen_fd == fd) {
+            endpoint_key = it->first;
+            break;
+          }
+        }
+        if (endpoint_key.empty()) {
+          for (std::unordered_map<std::string, SpdLidarServerConnectionState>::const_iterator it =
+                   spd_lidar_server_connections_.begin();
+               it != spd_lidar_server_connections_.end(); ++it) {
+            if (it->second.conn_fd == fd) {
+              instance_id = it->first;
+              break;
+            }
+          }
+        }
+      }
+
+      if (!endpoint_key.empty()) {
+        spdLidarAcceptPending(endpoint_key, fd);
+      } else if (!instance_id.empty()) {
+        spdLidarReadConnection(instance_id, fd, events[i].events);
+      } else {
+        // 已被替换的旧连接，从 epoll 中移除即可。
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+      }
+    }
+  }
+}
+
+void Interface::spdLidarAcceptPending(const std::string& endpoint_key, int listen_fd) {
+  for (;;) {
     sockaddr_in peer_addr{};
     socklen_t peer_len = sizeof(peer_addr);
     const int conn_fd = ::accept(listen_fd, reinterpret_cast<sockaddr*>(&peer_addr), &peer_len);
     if (conn_fd < 0) {
-      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
-      if (spd_lidar_server_running_) {
-        std::cout << "[spd_lidar] accept failed on " << endpoint_key
-                  << ": " << std::strerror(errno) << "\n";
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK && spd_lidar_server_running_) {
+        common::LogLine(common::LogLevel::Error, "spd_lidar")
+            << "accept failed on " << endpoint_key << ": " << std::strerror(errno);
       }
-      continue;
+      return;
     }
 
     const std::string peer_ip = sockaddrIp(peer_addr);
     const int peer_port = static_cast<int>(ntohs(peer_addr.sin_port));
     const std::string instance_id = matchSpdLidarServerInstance(endpoint_key, peer_ip, peer_port);
     if (instance_id.empty()) {
-      std::cout << "[spd_lidar] reject unknown client " << peer_ip << ":" << peer_port
-                << " on " << endpoint_key << "\n";
+      common::LogLine(common::LogLevel::Warn, "spd_lidar")
+          << "reject unknown client " << peer_ip << ":" << peer_port << " on " << endpoint_key;
       ::close(conn_fd);
       continue;
     }
+    setFdNonBlocking(conn_fd);
 
     {
       std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
       if (!spd_lidar_server_running_) {
         ::close(conn_fd);
-        break;
+        return;
       }
       closeSpdLidarServerConnectionLocked(instance_id);
+      epoll_event ev{};
+      ev.events = EPOLLIN | EPOLLRDHUP;
+      ev.data.fd = conn_fd;
+      if (::epoll_ctl(spd_lidar_epoll_fd_, EPOLL_CTL_ADD, conn_fd, &ev) != 0) {
+        common::LogLine(common::LogLevel::Error, "spd_lidar")
+            << instance_id << ": epoll_ctl failed: " << std::strerror(errno);
+        ::close(conn_fd);
+        continue;
+      }
       SpdLidarServerConnectionState& conn = spd_lidar_server_connections_[instance_id];
       conn.conn_fd = conn_fd;
       conn.peer_ip = peer_ip;
       conn.peer_port = peer_port;
+      conn.awaiting_response = false;
     }
     {
       std::lock_guard<std::mutex> lock(spd_lidar_log_mutex_);
       spd_lidar_wait_logged_.erase(instance_id);
     }
-    std::cout << "[spd_lidar:" << instance_id << "] client connected from "
-              << peer_ip << ":" << peer_port << "\n";
+    spd_lidar::SpdLidarCore* core = findSpdLidarById(instance_id);
+    if (core) core->reset();
+    common::LogLine(common::LogLevel::Info, "spd_lidar")
+        << instance_id << ": client connected from " << peer_ip << ":" << peer_port;
   }
 }
 
-bool Interface::spdLidarExchange(const SpdLidarInstanceDefaults& cfg,
-                                 const std::vector<uint8_t>& request,
-                                 std::vector<uint8_t>* response,
-                                 std::string* error) {
-  if (cfg.mode != "server") {
-    if (!response) return false;
-    response->clear();
-    if (cfg.device_ip.empty() || cfg.device_port <= 0) {
-      if (error) *error = "invalid spd_lidar device endpoint";
-      return false;
-    }
-
-    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
-    if (fd < 0) {
-      if (error) *error = std::string("socket failed: ") + std::strerror(errno);
-      return false;
-    }
+void Interface::spdLidarReadConnection(const std::string& instance_id, int fd, uint32_t events) {
+  spd_lidar::SpdLidarCore* core = findSpdLidarById(instance_id);
+  bool closed = (events & (EPOLLERR | EPOLLHUP)) != 0;
+  std::string reason = closed ? "connection error" : "";
 
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(static_cast<uint16_t>(cfg.device_port));
-    if (::inet_pton(AF_INET, cfg.device_ip.c_str(), &addr.sin_addr) != 1) {
-      if (error) *error = "invalid ip: " + cfg.device_ip;
-      ::close(fd);
-      return false;
+  // 边读边喂给解析器，帧何时完整由 SpdLidarCore 自己判断。
+  uint8_t buf[256];
+  while (!closed) {
+    const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n > 0) {
+      {
+        std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+        std::unordered_map<std::string, SpdLidarServerConnectionState>::iterator it =
+            spd_lidar_server_connections_.find(instance_id);
+        if (it != spd_lidar_server_connections_.end()) {
+          // server 模式没有同步 exchange：第一段应答字节到达即记为一次往返。
+          SpdLidarServerConnectionState& conn = it->second;
+          common::TransactionSeries& series = common::TransactionMetrics::instance().series(
+              spdLidarMetricsEndpoint(instance_id), conn.request_code);
+          series.bytes_in.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+          if (conn.awaiting_response) {
+            const std::chrono::steady_clock::duration rtt =
+                std::chrono::steady_clock::now() - conn.request_sent_at;
+            series.round_trip.record(rtt);
+            series.total.record(rtt);
+            series.requests.fetch_add(1, std::memory_order_relaxed);
+          }
+          conn.awaiting_response = false;
+        }
+      }
+      if (core) core->handleRecvBytes(buf, static_cast<size_t>(n));
+      continue;
     }
-    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
-      if (error) *error = std::string("connect failed: ") + std::strerror(errno);
-      ::close(fd);
-      return false;
+    if (n == 0) {
+      closed = true;
+      reason = "peer closed";
+      break;
     }
+    if (errno == EINTR) continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+    closed = true;
+    reason = std::string("recv failed: ") + std::strerror(errno);
+  }
+  if (!closed) return;
 
-    const bool ok = spdLidarExchangeOnConnectedFd(fd, request, response, error);
-    ::close(fd);
-    return ok;
+  {
+    std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
+    std::unordered_map<std::string, SpdLidarServerConnectionState>::iterator it =
+        spd_lidar_server_connections_.find(instance_id);
+    if (it == spd_lidar_server_connections_.end() || it->second.conn_fd != fd) return;
+    closeSpdLidarServerConnectionLocked(instance_id);
   }
+  if (core) core->reset();
+  common::LogLine(common::LogLevel::Info, "spd_lidar")
+      << instance_id << ": client disconnected: " << reason;
+}
 
+bool Interface::spdLidarServerSend(const SpdLidarInstanceDefaults& cfg,
+                                   const std::vector<uint8_t>& request,
+                                   std::string* error) {
   std::lock_guard<std::mutex> lock(spd_lidar_server_mutex_);
   std::unordered_map<std::string, SpdLidarServerConnectionState>::iterator it =
       spd_lidar_server_connections_.find(cfg.id);
@@ -2171,11 +3460,81 @@ bool Interface::spdLidarExchange(const SpdLidarInstanceDefaults& cfg,
     return false;
   }
 
-  const int fd = it->second.conn_fd;
-  const bool ok = spdLidarExchangeOnConnectedFd(fd, request, response, error);
-  if (!ok) {
-    closeSpdLidarServerConnectionLocked(cfg.id);
+  // 上一次请求超过 1s 仍无应答，视同旧版 SO_RCVTIMEO 超时：断开等待重连。
+  // 只 shutdown，不 close，fd 的回收统一交给 reactor 线程。
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  SpdLidarServerConnectionState& conn = it->second;
+  if (conn.awaiting_response && now - conn.request_sent_at > std::chrono::seconds(1)) {
+    common::TransactionSeries& series =
+        common::TransactionMetrics::instance().series(spdLidarMetricsEndpoint(cfg.id), conn.request_code);
+    series.timeouts.fetch_add(1, std::memory_order_relaxed);
+    series.failures.fetch_add(1, std::memory_order_relaxed);
+    series.requests.fetch_add(1, std::memory_order_relaxed);
+    series.total.record(now - conn.request_sent_at);
+    ::shutdown(conn.conn_fd, SHUT_RDWR);
+    if (error) *error = "recv timeout";
+    return false;
+  }
+
+  const ssize_t sent = ::send(conn.conn_fd, request.data(), request.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (sent < 0 || static_cast<size_t>(sent) != request.size()) {
+    if (error) {
+      *error = sent < 0 ? std::string("send failed: ") + std::strerror(errno)
+                        : std::string("send failed: short write");
+    }
+    ::shutdown(conn.conn_fd, SHUT_RDWR);
+    return false;
+  }
+  if (!conn.awaiting_response) {
+    conn.request_sent_at = now;
+    conn.request_code = spdLidarCommandCode(request);
+  }
+  conn.awaiting_response = true;
+  common::TransactionMetrics::instance()
+      .series(spdLidarMetricsEndpoint(cfg.id), spdLidarCommandCode(request))
+      .bytes_out.fetch_add(request.size(), std::memory_order_relaxed);
+  return true;
+}
+
+bool Interface::spdLidarExchange(const SpdLidarInstanceDefaults& cfg,
+                                 const std::vector<uint8_t>& request,
+                                 std::vector<uint8_t>* response,
+                                 std::string* error) {
+  if (!response) return false;
+  response->clear();
+  if (cfg.device_ip.empty() || cfg.device_port <= 0) {
+    if (error) *error = "invalid spd_lidar device endpoint";
+    return false;
+  }
+
+  common::TransactionProbe probe(spdLidarMetricsEndpoint(cfg.id), spdLidarCommandCode(request));
+  probe.acquired();
+  probe.beginConnect();
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    if (error) *error = std::string("socket failed: ") + std::strerror(errno);
+    return false;
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(cfg.device_port));
+  if (::inet_pton(AF_INET, cfg.device_ip.c_str(), &addr.sin_addr) != 1) {
+    if (error) *error = "invalid ip: " + cfg.device_ip;
+    ::close(fd);
+    return false;
   }
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    if (error) *error = std::string("connect failed: ") + std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+
+  probe.endConnect();
+
+  const bool ok = spdLidarExchangeOnConnectedFd(fd, request, response, error, &probe);
+  ::close(fd);
+  probe.finish(ok);
   return ok;
 }
 #endif
@@ -2259,6 +3618,17 @@ hoist_hook::HoistHookCore* Interface::hoistHook() {
 io_relay::IoRelayCore* Interface::ioRelay() {
   return io_relay_.get();
 }
+
+bool Interface::hasIoRelay() const {
+  std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+  return io_relay_ != nullptr;
+}
+
+bool Interface::ioRelayImage(std::uint16_t* image, std::chrono::milliseconds max_age) {
+  // reloadConfig() 可能在独占锁下重建 io_relay_，整个读取期间持共享锁。
+  std::shared_lock<std::shared_mutex> drivers_lock(drivers_mutex_);
+  return io_relay_ && io_relay_->getRelayImage(image, max_age);
+}
 #endif
 
 #ifdef ASC_ENABLE_MULTI_TURN_ENCODER
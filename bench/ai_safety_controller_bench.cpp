@@ -0,0 +1,460 @@
+/**
+ * ai_safety_controller_bench: 进程内模拟器驱动的端到端基准。
+ * - 模拟器：Modbus TCP 网关（电池 / 太阳能 / 继电器）、pty 上的 Modbus RTU 吊钩、SPD 激光 TCP 端点，
+ *   均可注入固定延迟、均匀抖动与丢包（--seed 固定随机序列，结果可复现）。
+ * - 阶段 1：Interface::queryResult 背靠背调用，统计各命令吞吐与延迟分位数。
+ * - 阶段 2：DevicesManagerClient 运行时修改模拟器数值，统计 DeviceStatus 推送 / 激光原始值的端到端更新延迟。
+ * - 阶段 3：空载轮询窗口，统计每个轮询周期的 CPU（扣除模拟器线程自身的 CPU）。
+ * 结果打印到终端，--json 另存一份；--max-* 阈值超出时退出码为 2，便于 CI 捕获性能回退。
+ */
+
+#include "ai_safety_controller/devices_manager_client.hpp"
+#include "ai_safety_controller/interface.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+#include "ai_safety_controller/common/transaction_metrics_format.hpp"
+
+#include "bench_device_sims.hpp"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using ai_safety_controller::common::LatencyHistogram;
+using ai_safety_controller::common::LatencySummary;
+using Clock = std::chrono::steady_clock;
+
+constexpr std::uint8_t kModuleUid = 3;
+constexpr std::uint8_t kBatteryUid = 2;
+constexpr std::uint8_t kSolarUid = 4;
+constexpr std::uint8_t kHookUid = 3;
+constexpr std::uint8_t kHookPowerUid = 4;
+constexpr const char* kLidarId = "bench";
+
+struct Options {
+  asc_bench::FaultProfile faults;
+  std::uint32_t seed = 1;
+  int iterations = 100;
+  int updates = 20;
+  double poll_hz = 5.0;
+  double window_sec = 10.0;
+  bool pipelined = false;
+  std::string json_path;
+  double max_status_p99_ms = 0.0;
+  double max_cpu_ms_per_cycle = 0.0;
+};
+
+void printUsage() {
+  std::cout << "usage: ai_safety_controller_bench [options]\n"
+            << "  --latency-ms <ms>            simulated device reply latency (default 2)\n"
+            << "  --jitter-ms <ms>             uniform jitter around the latency (default 1)\n"
+            << "  --loss <0..1>                reply loss probability (default 0)\n"
+            << "  --seed <n>                   RNG seed for jitter / loss / update timing (default 1)\n"
+            << "  --iterations <n>             queryResult calls per command in phase 1 (default 100)\n"
+            << "  --updates <n>                value changes per source in phase 2 (default 20)\n"
+            << "  --poll-hz <hz>               query_hz for every driver (default 5)\n"
+            << "  --window-sec <s>             idle polling window for the CPU figure (default 10)\n"
+            << "  --pipelined                  enable pipelined mode on the simulated gateway\n"
+            << "  --json <path>                also write the results as JSON\n"
+            << "  --max-status-p99-ms <ms>     fail (exit 2) when DeviceStatus p99 exceeds this\n"
+            << "  --max-cpu-ms-per-cycle <ms>  fail (exit 2) when CPU per poll cycle exceeds this\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options* opt) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string key = argv[i];
+    if (key == "--help" || key == "-h") return false;
+    if (key == "--pipelined") {
+      opt->pipelined = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "missing value for " << key << "\n";
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (key == "--latency-ms") opt->faults.latency_ms = std::atof(value.c_str());
+    else if (key == "--jitter-ms") opt->faults.jitter_ms = std::atof(value.c_str());
+    else if (key == "--loss") opt->faults.loss = std::atof(value.c_str());
+    else if (key == "--seed") opt->seed = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (key == "--iterations") opt->iterations = std::max(1, std::atoi(value.c_str()));
+    else if (key == "--updates") opt->updates = std::max(1, std::atoi(value.c_str()));
+    else if (key == "--poll-hz") opt->poll_hz = std::max(0.1, std::atof(value.c_str()));
+    else if (key == "--window-sec") opt->window_sec = std::max(1.0, std::atof(value.c_str()));
+    else if (key == "--json") opt->json_path = value;
+    else if (key == "--max-status-p99-ms") opt->max_status_p99_ms = std::atof(value.c_str());
+    else if (key == "--max-cpu-ms-per-cycle") opt->max_cpu_ms_per_cycle = std::atof(value.c_str());
+    else {
+      std::cerr << "unknown option " << key << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+void seedGatewayBank(asc_bench::RegisterBank* bank) {
+  bank->setReg(kBatteryUid, 0x0000, 5870);  // SOC 58.70%
+  bank->setReg(kBatteryUid, 0x0001, 112);   // 1.12 A
+  bank->setReg(kBatteryUid, 0x0002, 5240);  // 52.40 V
+  bank->setReg(kBatteryUid, 0x0003, 1200);  // 120.0 Ah remaining
+  bank->setReg(kBatteryUid, 0x0004, 2000);  // 200.0 Ah full
+  bank->setReg(kBatteryUid, 0x0007, 240);
+  bank->setReg(kBatteryUid, 0x0008, 60);
+  bank->setReg(kBatteryUid, 0x000A, 1);
+  bank->setReg(kBatteryUid, 0x0064, kBatteryUid);
+  bank->setReg(kSolarUid, 0x3100, 4860);
+  bank->setReg(kSolarUid, 0x3101, 370);
+  bank->setReg(kSolarUid, 0x3102, 18000);
+  bank->setReg(kSolarUid, 0x311A, 76);
+  bank->setReg(kSolarUid, 0x3201, 0x0004);
+  bank->setReg(kSolarUid, 0x331A, 5230);
+  bank->setReg(kSolarUid, 0x331B, 135);
+}
+
+void seedHookBank(asc_bench::RegisterBank* bank) {
+  bank->setReg(kHookUid, 0x0003, 0x0003);
+  for (std::uint8_t uid : {kHookUid, kHookPowerUid}) {
+    bank->setReg(uid, 0x0066, 5870);
+    bank->setReg(uid, 0x0069, 240);
+    bank->setReg(uid, 0x006A, 1);
+    bank->setReg(uid, 0x006D, 5240);
+    bank->setReg(uid, 0x006E, 112);
+  }
+}
+
+std::string retryJson() {
+  return "{\"max_retries\": 1, \"base_backoff_ms\": 20, \"max_backoff_ms\": 50, \"jitter_ms\": 0, "
+         "\"log_enabled\": false}";
+}
+
+// Config pointing every driver at the in-process simulators. The encoder has
+// no simulator here and stays disabled.
+std::string buildConfig(const Options& opt, int gateway_port, const std::string& hook_device, int lidar_port) {
+  std::ostringstream hz;
+  hz << opt.poll_hz;
+  std::ostringstream c;
+  c << "{\n  \"runtime\": {\n"
+    << "    \"battery\": {\"enable\": true, \"module_ip\": \"127.0.0.1\", \"module_port\": " << gateway_port
+    << ", \"module_slave_id\": " << int(kModuleUid) << ", \"battery_slave_id\": " << int(kBatteryUid)
+    << ", \"read_gap_tolerance\": 4, \"query_hz\": " << hz.str() << ", \"retry\": " << retryJson() << "},\n"
+    << "    \"solar\": {\"enable\": true, \"module_ip\": \"127.0.0.1\", \"module_port\": " << gateway_port
+    << ", \"module_slave_id\": " << int(kModuleUid) << ", \"solar_slave_id\": " << int(kSolarUid)
+    << ", \"sample_timeout_sec\": 1.0, \"read_gap_tolerance\": 4, \"query_hz\": " << hz.str()
+    << ", \"retry\": " << retryJson() << "},\n"
+    << "    \"io_relay\": {\"enable\": true, \"module_ip\": \"127.0.0.1\", \"module_port\": " << gateway_port
+    << ", \"module_slave_id\": " << int(kModuleUid) << ", \"battery_button_relay_channels\": [1, 2, 5]"
+    << ", \"query_hz\": " << hz.str() << ", \"retry\": " << retryJson() << "},\n"
+    << "    \"hoist_hook\": {\"enable\": true, \"transport\": \"rtu\", \"device\": \"" << hook_device
+    << "\", \"baud\": 9600, \"parity\": \"N\", \"data_bit\": 8, \"stop_bit\": 1"
+    << ", \"hook_slave_id\": " << int(kHookUid) << ", \"power_slave_id\": " << int(kHookPowerUid)
+    << ", \"heartbeat_enable\": false, \"time_sync_enable\": false, \"speaker_volume\": -1"
+    << ", \"read_gap_tolerance\": 4, \"query_hz\": " << hz.str() << ", \"retry\": " << retryJson() << "},\n"
+    << "    \"multi_turn_encoder\": {\"enable\": false},\n"
+    << "    \"modbus_gateways\": [{\"module_ip\": \"127.0.0.1\", \"module_port\": " << gateway_port
+    << ", \"pipelined\": " << (opt.pipelined ? "true" : "false") << ", \"max_in_flight\": 4}],\n"
+    << "    \"spd_lidar\": {\"query_hz\": " << hz.str() << ", \"instances\": [{\"id\": \"" << kLidarId
+    << "\", \"enable\": true, \"mode\": \"client\", \"local_ip\": \"127.0.0.1\", \"local_port\": 0"
+    << ", \"device_ip\": \"127.0.0.1\", \"device_port\": " << lidar_port
+    << ", \"role\": \"bench\", \"vertical_angle_to_vertical_deg\": 0.0}]}\n"
+    << "  }\n}\n";
+  return c.str();
+}
+
+double processCpuSeconds() {
+  rusage ru{};
+  ::getrusage(RUSAGE_SELF, &ru);
+  return static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+         static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+std::uint64_t totalTransactions() {
+  std::uint64_t n = 0;
+  for (const auto& s : ai_safety_controller::common::TransactionMetrics::instance().snapshot()) n += s.requests;
+  return n;
+}
+
+double ms(std::uint64_t us) { return static_cast<double>(us) / 1000.0; }
+
+struct CommandResult {
+  std::string name;
+  int ok = 0;
+  int failed = 0;
+  double ops_per_sec = 0.0;
+  LatencySummary latency;
+};
+
+struct UpdateResult {
+  std::string name;
+  int observed = 0;
+  int missed = 0;
+  LatencySummary latency;
+};
+
+void printSummaryLine(const std::string& name, const LatencySummary& s) {
+  std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+            << " n=" << s.count << " p50=" << ms(s.p50_us) << " p90=" << ms(s.p90_us) << " p99=" << ms(s.p99_us)
+            << " max=" << ms(s.max_us) << " ms\n";
+}
+
+void writeSummaryJson(std::ostream& os, const LatencySummary& s) {
+  os << "{\"count\": " << s.count << ", \"p50_ms\": " << ms(s.p50_us) << ", \"p90_ms\": " << ms(s.p90_us)
+     << ", \"p99_ms\": " << ms(s.p99_us) << ", \"max_ms\": " << ms(s.max_us)
+     << ", \"mean_ms\": " << s.mean_us / 1000.0 << "}";
+}
+
+// Phase 1: back-to-back structured queries on an Interface that is not polling.
+std::vector<CommandResult> runThroughput(const std::string& config_path, const Options& opt) {
+  std::vector<CommandResult> results;
+  ai_safety_controller::Interface sdk;
+  if (!sdk.loadConfig(config_path).ok || !sdk.init().ok) {
+    std::cerr << "[bench] phase 1: interface init failed\n";
+    return results;
+  }
+  const std::vector<std::pair<std::string, std::vector<std::string>>> commands = {
+      {"battery", {"summary"}},
+      {"solar", {"charge"}},
+      {"hoist_hook", {"power"}},
+      {"io_relay", {"read", "1"}},
+  };
+  for (const auto& cmd : commands) {
+    const std::vector<std::string> enabled = sdk.enabledSensors();
+    if (std::find(enabled.begin(), enabled.end(), cmd.first) == enabled.end()) continue;
+    CommandResult r;
+    r.name = cmd.first;
+    for (const auto& a : cmd.second) r.name += " " + a;
+    LatencyHistogram hist;
+    const Clock::time_point begin = Clock::now();
+    for (int i = 0; i < opt.iterations; ++i) {
+      const Clock::time_point t0 = Clock::now();
+      const bool ok = sdk.queryResult(cmd.first, cmd.second).status.ok;
+      hist.record(Clock::now() - t0);
+      ok ? ++r.ok : ++r.failed;
+    }
+    const double wall = std::chrono::duration<double>(Clock::now() - begin).count();
+    r.ops_per_sec = wall > 0.0 ? static_cast<double>(opt.iterations) / wall : 0.0;
+    r.latency = hist.summary();
+    results.push_back(r);
+  }
+  return results;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options opt;
+  opt.faults.latency_ms = 2.0;
+  opt.faults.jitter_ms = 1.0;
+  if (!parseOptions(argc, argv, &opt)) {
+    printUsage();
+    return 1;
+  }
+  // Keep driver chatter out of the report unless the caller asked for it.
+  ::setenv("ASC_LOG_LEVEL", "warn", 0);
+
+  asc_bench::RegisterBank gateway_bank;
+  asc_bench::RegisterBank hook_bank;
+  seedGatewayBank(&gateway_bank);
+  seedHookBank(&hook_bank);
+
+  asc_bench::ModbusTcpSim gateway(&gateway_bank, opt.faults, opt.seed);
+  asc_bench::ModbusRtuSim hook(&hook_bank, opt.faults, opt.seed + 1);
+  asc_bench::SpdLidarSim lidar(opt.faults, opt.seed + 2);
+  if (!gateway.open() || !hook.open() || !lidar.open()) {
+    std::cerr << "[bench] failed to open simulator endpoints\n";
+    return 1;
+  }
+  gateway.start();
+  hook.start();
+  lidar.start();
+
+  char config_path[] = "/tmp/asc_bench_config_XXXXXX";
+  const int config_fd = ::mkstemp(config_path);
+  if (config_fd < 0) {
+    std::cerr << "[bench] mkstemp failed\n";
+    return 1;
+  }
+  ::close(config_fd);
+  {
+    std::ofstream out(config_path);
+    out << buildConfig(opt, gateway.port(), hook.devicePath(), lidar.port());
+  }
+
+  // ---- Phase 1 ----
+  const std::vector<CommandResult> throughput = runThroughput(config_path, opt);
+
+  // ---- Phase 2 ----
+  ai_safety_controller::DevicesManagerClient client;
+  std::mutex status_mutex;
+  std::condition_variable status_cv;
+  int pushed_percent = -1;
+  client.SignalSendDeviceStatus.connect([&](ai_safety_common::DeviceStatus d) {
+    {
+      std::lock_guard<std::mutex> lock(status_mutex);
+      pushed_percent = d.trolleyBattery.percent;
+    }
+    status_cv.notify_all();
+  });
+  if (!client.loadConfig(config_path).ok || !client.init().ok || !client.start().ok) {
+    std::cerr << "[bench] phase 2: devices manager client start failed\n";
+    ::unlink(config_path);
+    return 1;
+  }
+
+  std::mt19937 rng(opt.seed);
+  const auto poll_period = std::chrono::duration<double>(1.0 / opt.poll_hz);
+  const auto settle_timeout = std::chrono::milliseconds(3000) +
+                              std::chrono::duration_cast<std::chrono::milliseconds>(poll_period * 4);
+  std::uniform_real_distribution<double> phase(0.0, 1.0);
+
+  UpdateResult status_update;
+  status_update.name = "battery -> DeviceStatus";
+  {
+    LatencyHistogram hist;
+    for (int i = 0; i < opt.updates; ++i) {
+      // Land the change at a random point of the poll period.
+      std::this_thread::sleep_for(poll_period * phase(rng));
+      const int target = 20 + (i * 7) % 70;
+      const Clock::time_point t0 = Clock::now();
+      gateway_bank.setReg(kBatteryUid, 0x0000, static_cast<std::uint16_t>(target * 100));
+      std::unique_lock<std::mutex> lock(status_mutex);
+      if (status_cv.wait_for(lock, settle_timeout, [&] { return pushed_percent == target; })) {
+        hist.record(Clock::now() - t0);
+        ++status_update.observed;
+      } else {
+        ++status_update.missed;
+      }
+    }
+    status_update.latency = hist.summary();
+  }
+
+  UpdateResult lidar_update;
+  lidar_update.name = "lidar -> raw_mm";
+  {
+    LatencyHistogram hist;
+    for (int i = 0; i < opt.updates; ++i) {
+      std::this_thread::sleep_for(poll_period * phase(rng));
+      const std::uint16_t target = static_cast<std::uint16_t>(1000 + i * 13);
+      const Clock::time_point t0 = Clock::now();
+      lidar.setDistanceMm(target);
+      bool seen = false;
+      while (Clock::now() - t0 < settle_timeout) {
+        const auto raw = client.getLatestLidarRawMm();
+        const auto it = raw.find(kLidarId);
+        if (it != raw.end() && it->second == target) {
+          seen = true;
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      if (seen) {
+        hist.record(Clock::now() - t0);
+        ++lidar_update.observed;
+      } else {
+        ++lidar_update.missed;
+      }
+    }
+    lidar_update.latency = hist.summary();
+  }
+
+  // ---- Phase 3 ----
+  const double sims_cpu0 = gateway.cpuSeconds() + hook.cpuSeconds() + lidar.cpuSeconds();
+  const double cpu0 = processCpuSeconds();
+  const std::uint64_t tx0 = totalTransactions();
+  const Clock::time_point w0 = Clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(opt.window_sec));
+  const double wall = std::chrono::duration<double>(Clock::now() - w0).count();
+  const double sdk_cpu = (processCpuSeconds() - cpu0) -
+                         (gateway.cpuSeconds() + hook.cpuSeconds() + lidar.cpuSeconds() - sims_cpu0);
+  const std::uint64_t tx = totalTransactions() - tx0;
+  const double cycles = wall * opt.poll_hz;
+  const double cpu_ms_per_cycle = cycles > 0.0 ? sdk_cpu * 1000.0 / cycles : 0.0;
+  const double cpu_us_per_tx = tx > 0 ? sdk_cpu * 1e6 / static_cast<double>(tx) : 0.0;
+
+  client.stop();
+  ::unlink(config_path);
+
+  // ---- Report ----
+  std::cout << "\n==== ai_safety_controller_bench ====\n"
+            << "faults: latency=" << opt.faults.latency_ms << "ms jitter=" << opt.faults.jitter_ms
+            << "ms loss=" << opt.faults.loss << " seed=" << opt.seed << " poll_hz=" << opt.poll_hz
+            << " pipelined=" << (opt.pipelined ? "true" : "false") << "\n";
+  std::cout << "[throughput] queryResult x" << opt.iterations << "\n";
+  for (const CommandResult& r : throughput) {
+    std::cout << "  " << std::left << std::setw(22) << r.name << std::right << std::fixed << std::setprecision(1)
+              << " " << r.ops_per_sec << " ops/s, failed=" << r.failed << "\n";
+    printSummaryLine("", r.latency);
+  }
+  std::cout << "[end-to-end] value change -> observed update\n";
+  for (const UpdateResult* u : {&status_update, &lidar_update}) {
+    printSummaryLine(u->name, u->latency);
+    if (u->missed > 0) std::cout << "    missed=" << u->missed << "\n";
+  }
+  std::cout << "[cpu] window=" << std::fixed << std::setprecision(1) << wall << "s sdk_cpu=" << std::setprecision(3)
+            << sdk_cpu << "s cycles=" << std::setprecision(0) << cycles << std::setprecision(3)
+            << " cpu_per_cycle=" << cpu_ms_per_cycle << "ms transactions=" << tx
+            << " cpu_per_transaction=" << std::setprecision(1) << cpu_us_per_tx << "us\n";
+  std::cout << "[sims] gateway requests=" << gateway.requests() << " dropped=" << gateway.dropped()
+            << ", hook requests=" << hook.requests() << " dropped=" << hook.dropped()
+            << ", lidar requests=" << lidar.requests() << " dropped=" << lidar.dropped() << "\n";
+  std::cout << ai_safety_controller::common::formatTransactionMetrics(
+      ai_safety_controller::common::TransactionMetrics::instance().snapshot());
+  std::cout << ai_safety_controller::common::formatBusQueueMetrics(
+      ai_safety_controller::common::GatewayScheduler::instance().snapshot());
+
+  if (!opt.json_path.empty()) {
+    std::ofstream js(opt.json_path);
+    js << std::fixed << std::setprecision(3);
+    js << "{\n  \"seed\": " << opt.seed << ",\n  \"latency_ms\": " << opt.faults.latency_ms
+       << ",\n  \"jitter_ms\": " << opt.faults.jitter_ms << ",\n  \"loss\": " << opt.faults.loss
+       << ",\n  \"poll_hz\": " << opt.poll_hz << ",\n  \"pipelined\": " << (opt.pipelined ? "true" : "false")
+       << ",\n  \"throughput\": [";
+    for (size_t i = 0; i < throughput.size(); ++i) {
+      const CommandResult& r = throughput[i];
+      js << (i ? ", " : "") << "\n    {\"command\": \"" << r.name << "\", \"ops_per_sec\": " << r.ops_per_sec
+         << ", \"failed\": " << r.failed << ", \"latency\": ";
+      writeSummaryJson(js, r.latency);
+      js << "}";
+    }
+    js << "\n  ],\n  \"end_to_end\": [";
+    bool first = true;
+    for (const UpdateResult* u : {&status_update, &lidar_update}) {
+      js << (first ? "" : ", ") << "\n    {\"source\": \"" << u->name << "\", \"missed\": " << u->missed
+         << ", \"latency\": ";
+      writeSummaryJson(js, u->latency);
+      js << "}";
+      first = false;
+    }
+    js << "\n  ],\n  \"cpu\": {\"window_sec\": " << wall << ", \"sdk_cpu_sec\": " << sdk_cpu
+       << ", \"poll_cycles\": " << cycles << ", \"cpu_ms_per_cycle\": " << cpu_ms_per_cycle
+       << ", \"transactions\": " << tx << ", \"cpu_us_per_transaction\": " << cpu_us_per_tx << "}\n}\n";
+  }
+
+  int rc = 0;
+  if (opt.max_status_p99_ms > 0.0 &&
+      (status_update.missed > 0 || ms(status_update.latency.p99_us) > opt.max_status_p99_ms)) {
+    std::cout << "[bench] FAIL: DeviceStatus p99 " << ms(status_update.latency.p99_us) << "ms > "
+              << opt.max_status_p99_ms << "ms (missed=" << status_update.missed << ")\n";
+    rc = 2;
+  }
+  if (opt.max_cpu_ms_per_cycle > 0.0 && cpu_ms_per_cycle > opt.max_cpu_ms_per_cycle) {
+    std::cout << "[bench] FAIL: cpu per cycle " << cpu_ms_per_cycle << "ms > " << opt.max_cpu_ms_per_cycle << "ms\n";
+    rc = 2;
+  }
+  return rc;
+}
@@ -0,0 +1,487 @@
+#pragma once
+
+// In-process device simulators for ai_safety_controller_bench: a Modbus TCP
+// gateway (battery / solar / io_relay), a Modbus RTU slave on a pty (hoist
+// hook) and an SPD lidar TCP endpoint. Each simulator is one poll() loop on
+// its own thread, so its CPU time can be measured and subtracted from the
+// SDK's. Replies go through a FaultProfile (fixed latency, uniform jitter,
+// loss) driven by a seeded RNG, so runs are reproducible.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pty.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace asc_bench {
+
+struct FaultProfile {
+  double latency_ms = 0.0;
+  double jitter_ms = 0.0;
+  // Probability that a reply is silently dropped.
+  double loss = 0.0;
+};
+
+// Holding registers and coils per unit id, shared between the simulator
+// thread and the benchmark (which changes values to trigger updates).
+class RegisterBank {
+ public:
+  std::uint16_t reg(std::uint8_t uid, std::uint16_t addr) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = regs_.find(key(uid, addr));
+    return it == regs_.end() ? 0 : it->second;
+  }
+
+  void setReg(std::uint8_t uid, std::uint16_t addr, std::uint16_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    regs_[key(uid, addr)] = value;
+  }
+
+  bool coil(std::uint8_t uid, std::uint16_t addr) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = coils_.find(key(uid, addr));
+    return it != coils_.end() && it->second;
+  }
+
+  void setCoil(std::uint8_t uid, std::uint16_t addr, bool on) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    coils_[key(uid, addr)] = on;
+  }
+
+ private:
+  static std::uint32_t key(std::uint8_t uid, std::uint16_t addr) {
+    return (static_cast<std::uint32_t>(uid) << 16) | addr;
+  }
+
+  mutable std::mutex mutex_;
+  std::map<std::uint32_t, std::uint16_t> regs_;
+  std::map<std::uint32_t, bool> coils_;
+};
+
+// Modbus PDU handler shared by the TCP and RTU simulators. Supports FC 0x01,
+// 0x03, 0x04, 0x05, 0x06, 0x0F and 0x10; anything else gets exception 0x01.
+inline std::vector<std::uint8_t> handleModbusPdu(RegisterBank& bank,
+                                                 std::uint8_t uid,
+                                                 const std::uint8_t* pdu,
+                                                 std::size_t len) {
+  const auto u16 = [&](std::size_t i) { return static_cast<std::uint16_t>((pdu[i] << 8) | pdu[i + 1]); };
+  const auto exception = [&](std::uint8_t code) {
+    return std::vector<std::uint8_t>{static_cast<std::uint8_t>(pdu[0] | 0x80), code};
+  };
+  if (len < 5) return std::vector<std::uint8_t>{0x80, 0x03};
+  const std::uint8_t fc = pdu[0];
+  const std::uint16_t addr = u16(1);
+  const std::uint16_t arg = u16(3);
+  switch (fc) {
+    case 0x03:
+    case 0x04: {
+      if (arg == 0 || arg > 125) return exception(0x03);
+      std::vector<std::uint8_t> out{fc, static_cast<std::uint8_t>(arg * 2)};
+      for (std::uint16_t i = 0; i < arg; ++i) {
+        const std::uint16_t v = bank.reg(uid, static_cast<std::uint16_t>(addr + i));
+        out.push_back(static_cast<std::uint8_t>(v >> 8));
+        out.push_back(static_cast<std::uint8_t>(v & 0xFF));
+      }
+      return out;
+    }
+    case 0x01: {
+      if (arg == 0 || arg > 2000) return exception(0x03);
+      std::vector<std::uint8_t> out{fc, static_cast<std::uint8_t>((arg + 7) / 8)};
+      out.resize(2 + out[1], 0);
+      for (std::uint16_t i = 0; i < arg; ++i) {
+        if (bank.coil(uid, static_cast<std::uint16_t>(addr + i))) out[2 + i / 8] |= 1u << (i % 8);
+      }
+      return out;
+    }
+    case 0x05:
+      if (arg != 0xFF00 && arg != 0x0000) return exception(0x03);
+      bank.setCoil(uid, addr, arg == 0xFF00);
+      return std::vector<std::uint8_t>(pdu, pdu + 5);
+    case 0x06:
+      bank.setReg(uid, addr, arg);
+      return std::vector<std::uint8_t>(pdu, pdu + 5);
+    case 0x0F:
+    case 0x10: {
+      if (len < 6 || len < 6u + pdu[5]) return exception(0x03);
+      for (std::uint16_t i = 0; i < arg; ++i) {
+        if (fc == 0x0F) {
+          const bool on = (pdu[6 + i / 8] >> (i % 8)) & 1u;
+          bank.setCoil(uid, static_cast<std::uint16_t>(addr + i), on);
+        } else if (7u + 2u * i < len) {
+          bank.setReg(uid, static_cast<std::uint16_t>(addr + i), u16(6 + 2 * i));
+        }
+      }
+      return std::vector<std::uint8_t>(pdu, pdu + 5);
+    }
+    default:
+      return exception(0x01);
+  }
+}
+
+inline std::uint16_t modbusCrc16(const std::uint8_t* data, std::size_t len) {
+  std::uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; ++b) crc = (crc & 1) ? static_cast<std::uint16_t>((crc >> 1) ^ 0xA001) : crc >> 1;
+  }
+  return crc;
+}
+
+// One poll() loop per simulator. Subclasses own the protocol and their
+// descriptors (closed in their destructors after stop()); the base owns the
+// thread, the wake eventfd and the delayed-reply queue.
+class SimLoop {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  SimLoop(const FaultProfile& faults, std::uint32_t seed) : faults_(faults), rng_(seed) {}
+  virtual ~SimLoop() { stop(); }
+
+  SimLoop(const SimLoop&) = delete;
+  SimLoop& operator=(const SimLoop&) = delete;
+
+  void start() {
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    running_.store(true);
+    thread_ = std::thread([this]() { run(); });
+    handle_ = thread_.native_handle();
+  }
+
+  void stop() {
+    if (!running_.exchange(false)) return;
+    const std::uint64_t one = 1;
+    (void)::write(wake_fd_, &one, sizeof(one));
+    if (thread_.joinable()) thread_.join();
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+
+  // CPU consumed by the simulator thread so far.
+  double cpuSeconds() const {
+    clockid_t cid;
+    timespec ts{};
+    if (!thread_.joinable()) return 0.0;
+    if (pthread_getcpuclockid(handle_, &cid) != 0) return 0.0;
+    if (::clock_gettime(cid, &ts) != 0) return 0.0;
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+  }
+
+  std::uint64_t requests() const { return requests_.load(); }
+  std::uint64_t dropped() const { return dropped_.load(); }
+
+ protected:
+  // Descriptors to watch besides the wake fd.
+  virtual std::vector<int> watchedFds() const = 0;
+  virtual void onReadable(int fd) = 0;
+
+  // Queue a reply on fd after the fault profile's delay, or drop it.
+  void reply(int fd, std::vector<std::uint8_t> bytes) {
+    requests_.fetch_add(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (faults_.loss > 0.0 && unit(rng_) < faults_.loss) {
+      dropped_.fetch_add(1);
+      return;
+    }
+    double delay_ms = faults_.latency_ms;
+    if (faults_.jitter_ms > 0.0) delay_ms += (unit(rng_) * 2.0 - 1.0) * faults_.jitter_ms;
+    if (delay_ms < 0.0) delay_ms = 0.0;
+    const auto due = Clock::now() + std::chrono::microseconds(static_cast<long long>(delay_ms * 1000.0));
+    // Keep per-fd order: a reply never overtakes an earlier one on the same link.
+    for (auto it = outbox_.rbegin(); it != outbox_.rend(); ++it) {
+      if (it->fd == fd) {
+        outbox_.push_back(Outgoing{std::max(due, it->due), fd, std::move(bytes)});
+        return;
+      }
+    }
+    outbox_.push_back(Outgoing{due, fd, std::move(bytes)});
+  }
+
+  void forget(int fd) {
+    for (auto it = outbox_.begin(); it != outbox_.end();) {
+      it = it->fd == fd ? outbox_.erase(it) : it + 1;
+    }
+  }
+
+ private:
+  struct Outgoing {
+    Clock::time_point due;
+    int fd;
+    std::vector<std::uint8_t> bytes;
+  };
+
+  void flushDue() {
+    const Clock::time_point now = Clock::now();
+    for (auto it = outbox_.begin(); it != outbox_.end();) {
+      if (it->due > now) {
+        ++it;
+        continue;
+      }
+      std::size_t off = 0;
+      while (off < it->bytes.size()) {
+        const ssize_t n = ::write(it->fd, it->bytes.data() + off, it->bytes.size() - off);
+        if (n <= 0) break;
+        off += static_cast<std::size_t>(n);
+      }
+      it = outbox_.erase(it);
+    }
+  }
+
+  int pollTimeoutMs() const {
+    if (outbox_.empty()) return 100;
+    Clock::time_point first = outbox_.front().due;
+    for (const Outgoing& o : outbox_) first = std::min(first, o.due);
+    const auto left = std::chrono::duration_cast<std::chrono::microseconds>(first - Clock::now()).count();
+    return left <= 0 ? 0 : static_cast<int>((left + 999) / 1000);
+  }
+
+  void run() {
+    while (running_.load()) {
+      std::vector<int> fds = watchedFds();
+      std::vector<pollfd> pfds;
+      pfds.push_back(pollfd{wake_fd_, POLLIN, 0});
+      for (int fd : fds) pfds.push_back(pollfd{fd, POLLIN, 0});
+      const int n = ::poll(pfds.data(), pfds.size(), pollTimeoutMs());
+      if (n > 0) {
+        for (std::size_t i = 1; i < pfds.size(); ++i) {
+          if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) onReadable(pfds[i].fd);
+        }
+      }
+      flushDue();
+    }
+  }
+
+  FaultProfile faults_;
+  std::mt19937 rng_;
+  std::vector<Outgoing> outbox_;
+  std::atomic<bool> running_{false};
+  std::atomic<std::uint64_t> requests_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  int wake_fd_ = -1;
+  std::thread thread_;
+  pthread_t handle_{};
+};
+
+// Listening TCP socket on 127.0.0.1 with an ephemeral port.
+inline int listenLoopback(int* port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  const int one = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0 ||
+      ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  *port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// TCP server base: accepts connections and hands each received chunk to
+// onData() with that connection's reassembly buffer.
+class TcpSimLoop : public SimLoop {
+ public:
+  using SimLoop::SimLoop;
+
+  bool open() {
+    listen_fd_ = listenLoopback(&port_);
+    return listen_fd_ >= 0;
+  }
+
+  int port() const { return port_; }
+
+ protected:
+  virtual void onData(int fd, std::vector<std::uint8_t>* buf) = 0;
+
+  std::vector<int> watchedFds() const override {
+    std::vector<int> fds{listen_fd_};
+    for (const auto& kv : conns_) fds.push_back(kv.first);
+    return fds;
+  }
+
+  void onReadable(int fd) override {
+    if (fd == listen_fd_) {
+      const int conn = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (conn >= 0) conns_[conn];
+      return;
+    }
+    std::uint8_t chunk[512];
+    const ssize_t n = ::recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (n <= 0) {
+      forget(fd);
+      conns_.erase(fd);
+      ::close(fd);
+      return;
+    }
+    std::vector<std::uint8_t>& buf = conns_[fd];
+    buf.insert(buf.end(), chunk, chunk + n);
+    onData(fd, &buf);
+  }
+
+  // Derived destructors call this after stop(), once the loop thread is gone.
+  void closeAll() {
+    for (const auto& kv : conns_) ::close(kv.first);
+    conns_.clear();
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    listen_fd_ = -1;
+  }
+
+ private:
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::map<int, std::vector<std::uint8_t>> conns_;
+};
+
+// Modbus TCP gateway: MBAP framing, any unit id, answers from the bank.
+class ModbusTcpSim : public TcpSimLoop {
+ public:
+  ModbusTcpSim(RegisterBank* bank, const FaultProfile& faults, std::uint32_t seed)
+      : TcpSimLoop(faults, seed), bank_(bank) {}
+  ~ModbusTcpSim() override {
+    stop();
+    closeAll();
+  }
+
+ protected:
+  void onData(int fd, std::vector<std::uint8_t>* buf) override {
+    while (buf->size() >= 7) {
+      const std::size_t length = static_cast<std::size_t>(((*buf)[4] << 8) | (*buf)[5]);
+      if (length < 2 || length > 254) {
+        buf->clear();
+        return;
+      }
+      if (buf->size() < 6 + length) return;
+      const std::uint8_t uid = (*buf)[6];
+      const std::vector<std::uint8_t> pdu = handleModbusPdu(*bank_, uid, buf->data() + 7, length - 1);
+      std::vector<std::uint8_t> out{(*buf)[0], (*buf)[1], 0, 0,
+                                    static_cast<std::uint8_t>((pdu.size() + 1) >> 8),
+                                    static_cast<std::uint8_t>((pdu.size() + 1) & 0xFF), uid};
+      out.insert(out.end(), pdu.begin(), pdu.end());
+      buf->erase(buf->begin(), buf->begin() + static_cast<std::ptrdiff_t>(6 + length));
+      reply(fd, std::move(out));
+    }
+  }
+
+ private:
+  RegisterBank* bank_;
+};
+
+// SPD lidar endpoint: answers every 55 AA 88 ... single-shot command with a
+// measurement frame carrying the current distance.
+class SpdLidarSim : public TcpSimLoop {
+ public:
+  SpdLidarSim(const FaultProfile& faults, std::uint32_t seed) : TcpSimLoop(faults, seed) {}
+  ~SpdLidarSim() override {
+    stop();
+    closeAll();
+  }
+
+  void setDistanceMm(std::uint16_t mm) { distance_mm_.store(mm); }
+
+ protected:
+  void onData(int fd, std::vector<std::uint8_t>* buf) override {
+    while (buf->size() >= 8) {
+      if ((*buf)[0] != 0x55 || (*buf)[1] != 0xAA) {
+        buf->erase(buf->begin());
+        continue;
+      }
+      const std::uint16_t mm = distance_mm_.load();
+      std::vector<std::uint8_t> out{0x55, 0xAA, 0x88, 0x00, 0x00,
+                                    static_cast<std::uint8_t>(mm >> 8), static_cast<std::uint8_t>(mm & 0xFF), 0};
+      std::uint32_t sum = 0;
+      for (std::size_t i = 0; i < 7; ++i) sum += out[i];
+      out[7] = static_cast<std::uint8_t>(sum & 0xFF);
+      buf->erase(buf->begin(), buf->begin() + 8);
+      reply(fd, std::move(out));
+    }
+  }
+
+ private:
+  std::atomic<std::uint16_t> distance_mm_{1000};
+};
+
+// Modbus RTU slave behind a pseudo terminal. The driver opens devicePath();
+// the simulator keeps its own slave descriptor open so the master side stays
+// readable while the driver reopens the port between transactions.
+class ModbusRtuSim : public SimLoop {
+ public:
+  ModbusRtuSim(RegisterBank* bank, const FaultProfile& faults, std::uint32_t seed)
+      : SimLoop(faults, seed), bank_(bank) {}
+  ~ModbusRtuSim() override {
+    stop();
+    if (master_fd_ >= 0) ::close(master_fd_);
+    if (slave_fd_ >= 0) ::close(slave_fd_);
+  }
+
+  bool open() {
+    char name[128] = {0};
+    if (::openpty(&master_fd_, &slave_fd_, name, nullptr, nullptr) != 0) return false;
+    termios tio{};
+    ::tcgetattr(slave_fd_, &tio);
+    ::cfmakeraw(&tio);
+    ::tcsetattr(slave_fd_, TCSANOW, &tio);
+    ::fcntl(master_fd_, F_SETFL, ::fcntl(master_fd_, F_GETFL) | O_NONBLOCK);
+    device_path_ = name;
+    return true;
+  }
+
+  const std::string& devicePath() const { return device_path_; }
+
+ protected:
+  std::vector<int> watchedFds() const override { return std::vector<int>{master_fd_}; }
+
+  void onReadable(int fd) override {
+    std::uint8_t chunk[256];
+    const ssize_t n = ::read(fd, chunk, sizeof(chunk));
+    if (n <= 0) return;
+    buf_.insert(buf_.end(), chunk, chunk + n);
+    while (buf_.size() >= 8) {
+      const std::uint8_t fc = buf_[1];
+      std::size_t frame_len = 8;
+      if (fc == 0x0F || fc == 0x10) frame_len = 9u + buf_[6];
+      if (buf_.size() < frame_len) return;
+      const std::uint16_t crc = modbusCrc16(buf_.data(), frame_len - 2);
+      if (buf_[frame_len - 2] != (crc & 0xFF) || buf_[frame_len - 1] != (crc >> 8)) {
+        buf_.clear();
+        return;
+      }
+      const std::uint8_t uid = buf_[0];
+      const std::vector<std::uint8_t> pdu = handleModbusPdu(*bank_, uid, buf_.data() + 1, frame_len - 3);
+      std::vector<std::uint8_t> out{uid};
+      out.insert(out.end(), pdu.begin(), pdu.end());
+      const std::uint16_t out_crc = modbusCrc16(out.data(), out.size());
+      out.push_back(static_cast<std::uint8_t>(out_crc & 0xFF));
+      out.push_back(static_cast<std::uint8_t>(out_crc >> 8));
+      buf_.erase(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>(frame_len));
+      reply(master_fd_, std::move(out));
+    }
+  }
+
+ private:
+  RegisterBank* bank_;
+  int master_fd_ = -1;
+  int slave_fd_ = -1;
+  std::string device_path_;
+  std::vector<std::uint8_t> buf_;
+};
+
+}  // namespace asc_bench
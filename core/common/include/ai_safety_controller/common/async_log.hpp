@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ai_safety_controller {
+namespace common {
+
+enum class LogLevel : std::uint8_t { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+// Longest prefix of text[0, len) that does not end inside a UTF-8 sequence,
+// so truncated log lines never carry half a Chinese character or emoji.
+inline std::size_t utf8Prefix(const char* text, std::size_t len) {
+  std::size_t i = len;
+  std::size_t trailing = 0;
+  while (i > 0 && trailing < 3 && (static_cast<unsigned char>(text[i - 1]) & 0xC0) == 0x80) {
+    --i;
+    ++trailing;
+  }
+  if (i == 0) return len;
+  const unsigned char lead = static_cast<unsigned char>(text[i - 1]);
+  std::size_t need = 1;
+  if ((lead & 0xE0) == 0xC0) need = 2;
+  else if ((lead & 0xF0) == 0xE0) need = 3;
+  else if ((lead & 0xF8) == 0xF0) need = 4;
+  return trailing + 1 >= need ? len : i - 1;
+}
+
+// Process-wide asynchronous log. Producers copy an already formatted line into
+// a fixed-size record of a bounded lock-free ring (Vyukov MPMC, used here as
+// MPSC) and return immediately; a single sink thread writes the records to
+// stdout. When the ring is full or a module exceeds its per-second budget the
+// record is dropped and counted instead of blocking the caller. Warn and
+// Error records are never rate limited.
+//
+// Environment: ASC_LOG_LEVEL=debug|info|warn|error|off (default info),
+// ASC_LOG_RATE=<Debug/Info records per second per module> (default 50,
+// 0 = unlimited).
+class AsyncLog {
+ public:
+  static constexpr std::size_t kCapacity = 1024;
+  static constexpr std::size_t kModuleMax = 24;
+  static constexpr std::size_t kTextMax = 232;
+
+  static AsyncLog& instance() {
+    static AsyncLog log;
+    return log;
+  }
+
+  AsyncLog(const AsyncLog&) = delete;
+  AsyncLog& operator=(const AsyncLog&) = delete;
+
+  bool enabled(LogLevel level) const {
+    return level != LogLevel::Off && level >= min_level_.load(std::memory_order_relaxed);
+  }
+  void setLevel(LogLevel level) { min_level_.store(level, std::memory_order_relaxed); }
+  void setRateLimit(int per_second) { rate_limit_.store(per_second, std::memory_order_relaxed); }
+
+  // Returns false when the record was filtered, rate limited or dropped.
+  bool push(LogLevel level, const char* module, const char* text, std::size_t len) {
+    if (!enabled(level)) return false;
+    if (level < LogLevel::Warn && !admit(module)) return false;
+    return enqueue(level, module, text, len);
+  }
+
+  // Wait (bounded) until everything pushed so far has been written.
+  void flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(500)) {
+    const std::size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    wake_cv_.notify_one();
+    while (written_pos_.load(std::memory_order_acquire) < target &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  std::uint64_t suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Record {
+    LogLevel level = LogLevel::Info;
+    std::uint16_t text_len = 0;
+    char module[kModuleMax] = {};
+    char text[kTextMax] = {};
+  };
+  struct Cell {
+    std::atomic<std::size_t> seq{0};
+    Record record;
+  };
+  // Rate limiting is per module name and per wall-clock second. A budget is
+  // claimed on a module's first limited record and never released; the
+  // module names are literals, so the table stays small.
+  struct Budget {
+    std::atomic<int> state{0};  // 0 free, 1 claiming, 2 ready
+    char module[kModuleMax] = {};
+    std::atomic<std::int64_t> second{0};
+    std::atomic<int> count{0};
+    std::atomic<int> suppressed{0};
+  };
+  static constexpr std::size_t kBudgets = 64;
+
+  AsyncLog() {
+    for (std::size_t i = 0; i < kCapacity; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    const char* level = std::getenv("ASC_LOG_LEVEL");
+    if (level) {
+      const std::string v(level);
+      if (v == "debug") setLevel(LogLevel::Debug);
+      else if (v == "warn") setLevel(LogLevel::Warn);
+      else if (v == "error") setLevel(LogLevel::Error);
+      else if (v == "off") setLevel(LogLevel::Off);
+    }
+    const char* rate = std::getenv("ASC_LOG_RATE");
+    if (rate && rate[0] != '\0') setRateLimit(std::atoi(rate));
+    sink_thread_ = std::thread([this]() { sinkLoop(); });
+  }
+
+  ~AsyncLog() {
+    running_.store(false, std::memory_order_release);
+    wake_cv_.notify_one();
+    if (sink_thread_.joinable()) sink_thread_.join();
+  }
+
+  static bool sameModule(const char* stored, const char* module) {
+    std::size_t i = 0;
+    for (; module && module[i] != '\0' && i + 1 < kModuleMax; ++i) {
+      if (stored[i] != module[i]) return false;
+    }
+    return stored[i] == '\0';
+  }
+
+  // Open addressing on the module name; once every slot is claimed, further
+  // modules share one overflow budget.
+  Budget& budgetOf(const char* module) {
+    std::size_t h = 2166136261u;
+    for (std::size_t i = 0; module && module[i] != '\0' && i + 1 < kModuleMax; ++i) {
+      h = (h ^ static_cast<unsigned char>(module[i])) * 16777619u;
+    }
+    for (std::size_t probe = 0; probe < kBudgets; ++probe) {
+      Budget& b = budgets_[(h + probe) % kBudgets];
+      int state = b.state.load(std::memory_order_acquire);
+      if (state == 0) {
+        if (b.state.compare_exchange_strong(state, 1, std::memory_order_acquire)) {
+          std::size_t m = 0;
+          for (; module && module[m] != '\0' && m + 1 < kModuleMax; ++m) b.module[m] = module[m];
+          b.module[m] = '\0';
+          b.state.store(2, std::memory_order_release);
+          return b;
+        }
+      }
+      while (state == 1) state = b.state.load(std::memory_order_acquire);
+      if (sameModule(b.module, module)) return b;
+    }
+    return overflow_budget_;
+  }
+
+  bool admit(const char* module) {
+    const int limit = rate_limit_.load(std::memory_order_relaxed);
+    if (limit <= 0) return true;
+    Budget& b = budgetOf(module);
+    const std::int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch())
+                                 .count();
+    std::int64_t seen = b.second.load(std::memory_order_relaxed);
+    if (seen != now && b.second.compare_exchange_strong(seen, now, std::memory_order_relaxed)) {
+      b.count.store(0, std::memory_order_relaxed);
+      const int skipped = b.suppressed.exchange(0, std::memory_order_relaxed);
+      if (skipped > 0) {
+        char note[64];
+        const int n = std::snprintf(note, sizeof(note), "… 上一秒限流丢弃 %d 条日志", skipped);
+        enqueue(LogLevel::Warn, module, note, n > 0 ? static_cast<std::size_t>(n) : 0);
+      }
+    }
+    if (b.count.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+    b.suppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  bool enqueue(LogLevel level, const char* module, const char* text, std::size_t len) {
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &cells_[pos & (kCapacity - 1)];
+      const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+      const std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    Record& r = cell->record;
+    r.level = level;
+    std::size_t m = 0;
+    for (; module && module[m] != '\0' && m + 1 < kModuleMax; ++m) r.module[m] = module[m];
+    r.module[m] = '\0';
+    const std::size_t n = len < kTextMax ? len : utf8Prefix(text, kTextMax);
+    std::memcpy(r.text, text, n);
+    r.text_len = static_cast<std::uint16_t>(n);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    if (sink_idle_.load(std::memory_order_acquire)) wake_cv_.notify_one();
+    return true;
+  }
+
+  void sinkLoop() {
+    std::size_t pos = 0;
+    std::string out;
+    out.reserve(16 * 1024);
+    for (;;) {
+      Cell& cell = cells_[pos & (kCapacity - 1)];
+      if (cell.seq.load(std::memory_order_acquire) == pos + 1) {
+        const Record& r = cell.record;
+        out += '[';
+        out += r.module;
+        out += "] ";
+        out.append(r.text, r.text_len);
+        out += '\n';
+        cell.seq.store(pos + kCapacity, std::memory_order_release);
+        ++pos;
+        if (out.size() < 12 * 1024) continue;
+      }
+      if (!out.empty()) {
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+        std::cout.flush();
+        out.clear();
+        written_pos_.store(pos, std::memory_order_release);
+        continue;
+      }
+      written_pos_.store(pos, std::memory_order_release);
+      if (!running_.load(std::memory_order_acquire)) break;
+      // Producers only notify while the sink is idle; the timeout covers a
+      // notification that races with going to sleep.
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      sink_idle_.store(true, std::memory_order_release);
+      wake_cv_.wait_for(lock, std::chrono::milliseconds(20));
+      sink_idle_.store(false, std::memory_order_release);
+    }
+  }
+
+  Cell cells_[kCapacity];
+  Budget budgets_[kBudgets];
+  Budget overflow_budget_;
+  std::atomic<std::size_t> enqueue_pos_{0};
+  std::atomic<std::size_t> written_pos_{0};
+  std::atomic<LogLevel> min_level_{LogLevel::Info};
+  std::atomic<int> rate_limit_{50};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> suppressed_{0};
+  std::atomic<bool> running_{true};
+  std::atomic<bool> sink_idle_{false};
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  std::thread sink_thread_;
+};
+
+// Builds one log line in a stack buffer and hands it to AsyncLog on
+// destruction. Formatting uses snprintf only; nothing here touches iostreams.
+//   LogLine(LogLevel::Error, "battery") << "❌ 无响应: " << context;
+class LogLine {
+ public:
+  LogLine(LogLevel level, const char* module)
+      : level_(level), module_(module), active_(AsyncLog::instance().enabled(level)) {}
+  ~LogLine() {
+    if (active_) AsyncLog::instance().push(level_, module_, buf_, len_);
+  }
+  LogLine(const LogLine&) = delete;
+  LogLine& operator=(const LogLine&) = delete;
+
+  bool active() const { return active_; }
+
+  LogLine& append(const char* text, std::size_t len) {
+    if (!active_) return *this;
+    const std::size_t room = sizeof(buf_) - len_;
+    const std::size_t n = len < room ? len : utf8Prefix(text, room);
+    std::memcpy(buf_ + len_, text, n);
+    len_ += n;
+    return *this;
+  }
+  LogLine& operator<<(const char* text) { return text ? append(text, std::strlen(text)) : *this; }
+  LogLine& operator<<(const std::string& text) { return append(text.data(), text.size()); }
+  LogLine& operator<<(char c) { return append(&c, 1); }
+  LogLine& operator<<(int v) { return printf("%d", v); }
+  LogLine& operator<<(unsigned v) { return printf("%u", v); }
+  LogLine& operator<<(long v) { return printf("%ld", v); }
+  LogLine& operator<<(unsigned long v) { return printf("%lu", v); }
+  LogLine& operator<<(long long v) { return printf("%lld", v); }
+  LogLine& operator<<(unsigned long long v) { return printf("%llu", v); }
+  LogLine& operator<<(double v) { return printf("%g", v); }
+  // Uppercase hex, zero padded to width (no "0x" prefix).
+  LogLine& hex(unsigned v, int width = 0) { return printf("%0*X", width, v); }
+  LogLine& fixed(double v, int precision) { return printf("%.*f", precision, v); }
+
+  template <typename... Args>
+  LogLine& printf(const char* fmt, Args... args) {
+    if (!active_ || len_ >= sizeof(buf_)) return *this;
+    const int n = std::snprintf(buf_ + len_, sizeof(buf_) - len_, fmt, args...);
+    if (n <= 0) return *this;
+    if (len_ + static_cast<std::size_t>(n) < sizeof(buf_)) {
+      len_ += static_cast<std::size_t>(n);
+    } else {
+      len_ = utf8Prefix(buf_, sizeof(buf_) - 1);
+    }
+    return *this;
+  }
+
+ private:
+  LogLevel level_;
+  const char* module_;
+  bool active_;
+  std::size_t len_ = 0;
+  char buf_[AsyncLog::kTextMax];
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
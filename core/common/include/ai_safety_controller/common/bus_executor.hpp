@@ -0,0 +1,121 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// One-shot command executor with a FIFO worker per physical bus ("lane").
+// Commands for the same bus run in submission order, commands for different
+// buses run concurrently, and the submitting thread never waits. Lanes start
+// on first use and live until stop().
+class BusExecutor {
+ public:
+  using Task = std::function<void()>;
+
+  BusExecutor() = default;
+  ~BusExecutor() { stop(); }
+
+  BusExecutor(const BusExecutor&) = delete;
+  BusExecutor& operator=(const BusExecutor&) = delete;
+
+  // Queue run on lane. If the executor is stopped before run gets its turn,
+  // cancel is called instead (on the stopping thread) so that whoever waits
+  // on the result is released. Returns false, without calling either, while a
+  // stop() is in progress.
+  bool post(const std::string& lane, Task run, Task cancel = Task()) {
+    if (!run) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) return false;
+    std::unique_ptr<Lane>& slot = lanes_[lane];
+    if (!slot) {
+      slot.reset(new Lane());
+      Lane* created = slot.get();
+      created->worker = std::thread([this, created]() { runLane(created); });
+    }
+    slot->queue.push_back(Item{std::move(run), std::move(cancel)});
+    slot->cv.notify_one();
+    return true;
+  }
+
+  // Commands queued (not yet running) on lane.
+  std::size_t pending(const std::string& lane) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = lanes_.find(lane);
+    return it == lanes_.end() ? 0 : it->second->queue.size();
+  }
+
+  // Cancel everything still queued, wait for the running commands and join
+  // the workers. post() works again afterwards.
+  void stop() {
+    std::map<std::string, std::unique_ptr<Lane>> lanes;
+    std::vector<Item> dropped;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (lanes_.empty()) return;
+      stopping_ = true;
+      for (auto& kv : lanes_) {
+        Lane& lane = *kv.second;
+        while (!lane.queue.empty()) {
+          dropped.push_back(std::move(lane.queue.front()));
+          lane.queue.pop_front();
+        }
+        lane.cv.notify_all();
+      }
+    }
+    for (std::size_t i = 0; i < dropped.size(); ++i) {
+      if (dropped[i].cancel) dropped[i].cancel();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lanes.swap(lanes_);
+    }
+    for (auto& kv : lanes) {
+      if (kv.second->worker.joinable()) kv.second->worker.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+
+ private:
+  struct Item {
+    Task run;
+    Task cancel;
+  };
+
+  struct Lane {
+    std::deque<Item> queue;
+    std::condition_variable cv;
+    std::thread worker;
+  };
+
+  void runLane(Lane* lane) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      lane->cv.wait(lock, [&]() { return stopping_ || !lane->queue.empty(); });
+      if (stopping_) return;
+      Item item = std::move(lane->queue.front());
+      lane->queue.pop_front();
+      lock.unlock();
+      item.run();
+      lock.lock();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  bool stopping_ = false;
+  std::map<std::string, std::unique_ptr<Lane>> lanes_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
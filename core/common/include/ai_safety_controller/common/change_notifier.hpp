@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Generation counter plus condition variable. Producers call notify() after a
+// real change; consumers remember the last generation they handled and block
+// until it moves on or a deadline passes.
+class ChangeNotifier {
+ public:
+  void notify() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++generation_;
+    }
+    cv_.notify_all();
+  }
+
+  std::uint64_t generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+  }
+
+  // Returns the current generation; equal to seen means the deadline passed
+  // without a change.
+  std::uint64_t waitUntil(std::uint64_t seen, std::chrono::steady_clock::time_point deadline) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_until(lock, deadline, [&] { return generation_ != seen; });
+    return generation_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+  std::uint64_t generation_ = 0;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
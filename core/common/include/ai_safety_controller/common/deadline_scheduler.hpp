@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Periodic task scheduler with one worker ("lane") per physical bus. Tasks in
+// the same lane run strictly one after another, different lanes run in
+// parallel. Each lane keeps its tasks in a deadline min-heap and sleeps on a
+// condition variable exactly until the earliest one is due.
+class DeadlineScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void()>;
+
+  struct TaskInfo {
+    std::string lane;
+    std::string name;
+    Clock::duration period{};
+  };
+
+  DeadlineScheduler() = default;
+  ~DeadlineScheduler() { stop(); }
+
+  DeadlineScheduler(const DeadlineScheduler&) = delete;
+  DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+
+  // Register a periodic task on a lane. Lanes are created on first use; the
+  // task set is fixed while running, so calls between start() and stop() are
+  // rejected.
+  bool addTask(const std::string& lane, const std::string& name, Clock::duration period, Task fn) {
+    if (!fn || period <= Clock::duration::zero()) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return false;
+    Lane* target = nullptr;
+    for (std::size_t i = 0; i < lanes_.size(); ++i) {
+      if (lanes_[i].name == lane) {
+        target = &lanes_[i];
+        break;
+      }
+    }
+    if (!target) {
+      lanes_.emplace_back();
+      target = &lanes_.back();
+      target->name = lane;
+    }
+    Slot slot;
+    slot.info.lane = lane;
+    slot.info.name = name;
+    slot.info.period = period;
+    slot.fn = std::move(fn);
+    target->slots.push_back(std::move(slot));
+    return true;
+  }
+
+  std::vector<TaskInfo> tasks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TaskInfo> out;
+    for (std::size_t i = 0; i < lanes_.size(); ++i) {
+      for (std::size_t j = 0; j < lanes_[i].slots.size(); ++j) out.push_back(lanes_[i].slots[j].info);
+    }
+    return out;
+  }
+
+  std::size_t laneCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lanes_.size();
+  }
+
+  void start() {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+    for (std::size_t i = 0; i < lanes_.size(); ++i) {
+      const std::vector<Slot>* slots = &lanes_[i].slots;
+      threads_.emplace_back([this, slots]() { runLane(*slots); });
+    }
+  }
+
+  void stop() {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+      threads.swap(threads_);
+    }
+    cv_.notify_all();
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+      if (threads[i].joinable()) threads[i].join();
+    }
+  }
+
+  // Stop and drop every task and lane.
+  void clear() {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    lanes_.clear();
+  }
+
+ private:
+  struct Slot {
+    TaskInfo info;
+    Task fn;
+  };
+
+  struct Lane {
+    std::string name;
+    std::vector<Slot> slots;
+  };
+
+  struct Due {
+    Clock::time_point at;
+    std::size_t slot = 0;
+  };
+
+  struct LaterFirst {
+    bool operator()(const Due& a, const Due& b) const { return a.at > b.at; }
+  };
+
+  void runLane(const std::vector<Slot>& slots) {
+    std::priority_queue<Due, std::vector<Due>, LaterFirst> heap;
+    const Clock::time_point now = Clock::now();
+    for (std::size_t i = 0; i < slots.size(); ++i) heap.push(Due{now, i});
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_ && !heap.empty()) {
+      const Due next = heap.top();
+      if (cv_.wait_until(lock, next.at, [this] { return !running_; })) break;
+      heap.pop();
+      lock.unlock();
+      slots[next.slot].fn();
+      lock.lock();
+
+      // Fixed-rate: keep the original phase, but never queue a burst of
+      // catch-up runs after a slow exchange.
+      Due again{next.at + slots[next.slot].info.period, next.slot};
+      const Clock::time_point done = Clock::now();
+      if (again.at < done) again.at = done;
+      heap.push(again);
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool running_ = false;
+  std::vector<Lane> lanes_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
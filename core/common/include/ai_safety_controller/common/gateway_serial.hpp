@@ -1,52 +1,260 @@
 #pragma once
 
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace ai_safety_controller {
 namespace common {
 
-// Serialize requests targeting the same gateway endpoint.
+// Request classes on one bus, most urgent first. Queued requests of a higher
+// class are always granted before any queued request of a lower class; an
+// exchange already on the wire is never interrupted.
+enum class BusPriority : std::uint8_t {
+  Control = 0,     // writes: speaker / light / relay / heartbeat
+  Normal = 1,      // interactive reads and anything without a scope
+  Background = 2,  // periodic polling, may be shed when the bus is saturated
+};
+
+constexpr std::size_t kBusPriorityCount = 3;
+
+inline const char* busPriorityName(BusPriority p) {
+  switch (p) {
+    case BusPriority::Control:
+      return "control";
+    case BusPriority::Normal:
+      return "normal";
+    case BusPriority::Background:
+    default:
+      return "background";
+  }
+}
+
+// Thread-local priority for reads issued on this thread, e.g. by the polling
+// scheduler. Scopes nest and restore the previous class on exit.
+class BusPriorityScope {
+ public:
+  explicit BusPriorityScope(BusPriority priority) : previous_(current()) { current() = priority; }
+  ~BusPriorityScope() { current() = previous_; }
+
+  BusPriorityScope(const BusPriorityScope&) = delete;
+  BusPriorityScope& operator=(const BusPriorityScope&) = delete;
+
+  static BusPriority& current() {
+    thread_local BusPriority priority = BusPriority::Normal;
+    return priority;
+  }
+
+ private:
+  BusPriority previous_;
+};
+
+// Writes are always control traffic; reads take the class of the caller.
+inline BusPriority busPriorityFor(std::uint8_t function_code) {
+  switch (function_code) {
+    case 0x05:
+    case 0x06:
+    case 0x0F:
+    case 0x10:
+      return BusPriority::Control;
+    default:
+      return BusPriorityScope::current();
+  }
+}
+
+// Queueing statistics of one bus and priority class.
+struct BusQueueSnapshot {
+  std::string endpoint;
+  BusPriority priority = BusPriority::Normal;
+  std::uint64_t granted = 0;
+  std::uint64_t shed = 0;
+  std::uint64_t waiting = 0;
+  LatencySummary queue_wait;
+};
+
+// Per-endpoint priority scheduler: each gateway (or serial line) has its own
+// queue per BusPriority, so traffic to different endpoints never waits on each
+// other and, on one endpoint, control writes overtake queued polling reads.
+// Within a class the order is FIFO.
+class GatewayScheduler {
+ public:
+  struct Endpoint {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool busy = false;
+    std::uint64_t next_ticket[kBusPriorityCount] = {};
+    std::uint64_t serving_ticket[kBusPriorityCount] = {};
+    bool has_last_done = false;
+    std::chrono::steady_clock::time_point last_done;
+    // Background cycles are shed once this many requests are active or queued.
+    std::uint32_t background_backlog_limit = 3;
+    std::atomic<std::uint64_t> granted[kBusPriorityCount] = {};
+    std::atomic<std::uint64_t> shed{0};
+    LatencyHistogram queue_wait[kBusPriorityCount];
+
+    std::uint64_t waiting(std::size_t c) const { return next_ticket[c] - serving_ticket[c]; }
+  };
+
+  static GatewayScheduler& instance() {
+    static GatewayScheduler scheduler;
+    return scheduler;
+  }
+
+  std::shared_ptr<Endpoint> endpoint(const std::string& endpoint_key) {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    auto& ep = endpoints_[endpoint_key];
+    if (!ep) ep = std::make_shared<Endpoint>();
+    return ep;
+  }
+
+  void configure(const std::string& endpoint_key, std::uint32_t background_backlog_limit) {
+    const std::shared_ptr<Endpoint> ep = endpoint(endpoint_key);
+    std::lock_guard<std::mutex> lock(ep->mutex);
+    ep->background_backlog_limit = background_backlog_limit < 1 ? 1 : background_backlog_limit;
+  }
+
+  // Called before a background polling cycle. Returns false, and counts the
+  // cycle as shed, when the bus is saturated: control traffic is waiting or
+  // the backlog has reached the endpoint limit. The next period polls again.
+  bool admitBackground(const std::string& endpoint_key) {
+    const std::shared_ptr<Endpoint> ep = endpoint(endpoint_key);
+    std::lock_guard<std::mutex> lock(ep->mutex);
+    std::uint64_t backlog = ep->busy ? 1 : 0;
+    for (std::size_t c = 0; c < kBusPriorityCount; ++c) backlog += ep->waiting(c);
+    const bool saturated =
+        ep->waiting(static_cast<std::size_t>(BusPriority::Control)) > 0 ||
+        backlog >= ep->background_backlog_limit;
+    if (saturated) ep->shed.fetch_add(1, std::memory_order_relaxed);
+    return !saturated;
+  }
+
+  // One entry per endpoint and class that has seen traffic, sorted by endpoint.
+  std::vector<BusQueueSnapshot> snapshot() {
+    std::map<std::string, std::shared_ptr<Endpoint>> endpoints;
+    {
+      std::lock_guard<std::mutex> lock(map_mutex_);
+      endpoints.insert(endpoints_.begin(), endpoints_.end());
+    }
+    std::vector<BusQueueSnapshot> out;
+    for (const auto& kv : endpoints) {
+      Endpoint& ep = *kv.second;
+      std::uint64_t waiting[kBusPriorityCount] = {};
+      {
+        std::lock_guard<std::mutex> lock(ep.mutex);
+        for (std::size_t c = 0; c < kBusPriorityCount; ++c) waiting[c] = ep.waiting(c);
+      }
+      for (std::size_t c = 0; c < kBusPriorityCount; ++c) {
+        BusQueueSnapshot s;
+        s.endpoint = kv.first;
+        s.priority = static_cast<BusPriority>(c);
+        s.granted = ep.granted[c].load(std::memory_order_relaxed);
+        s.waiting = waiting[c];
+        if (s.priority == BusPriority::Background) s.shed = ep.shed.load(std::memory_order_relaxed);
+        if (s.granted == 0 && s.waiting == 0 && s.shed == 0) continue;
+        s.queue_wait = ep.queue_wait[c].summary();
+        out.push_back(s);
+      }
+    }
+    return out;
+  }
+
+ private:
+  GatewayScheduler() = default;
+
+  std::mutex map_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<Endpoint>> endpoints_;
+};
+
+// Serialize requests targeting the same gateway endpoint, keeping at least
+// min_gap_ms between the end of one exchange and the start of the next.
+// Waiters are granted by priority class, then in arrival order. The gap is
+// waited out on the endpoint condition variable, not under a lock.
 class GatewaySerialGuard {
  public:
-  GatewaySerialGuard(const std::string& endpoint_key, std::uint32_t min_gap_ms = 120)
-      : endpoint_key_(endpoint_key),
-        min_gap_(std::chrono::milliseconds(min_gap_ms)),
-        lock_(globalMutex()) {
-    auto& last = lastSendByEndpoint();
-    const auto it = last.find(endpoint_key_);
-    if (it != last.end()) {
-      const auto due = it->second + min_gap_;
-      const auto now = std::chrono::steady_clock::now();
-      if (due > now) std::this_thread::sleep_for(due - now);
+  GatewaySerialGuard(const std::string& endpoint_key,
+                     std::uint32_t min_gap_ms = 120,
+                     BusPriority priority = BusPriority::Normal)
+      : endpoint_(GatewayScheduler::instance().endpoint(endpoint_key)),
+        min_gap_(std::chrono::milliseconds(min_gap_ms)) {
+    const std::size_t c = static_cast<std::size_t>(priority);
+    const auto enqueued = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(endpoint_->mutex);
+    const std::uint64_t ticket = endpoint_->next_ticket[c]++;
+    while (true) {
+      if (eligibleLocked(c, ticket)) {
+        if (!endpoint_->has_last_done) break;
+        const auto due = endpoint_->last_done + min_gap_;
+        if (std::chrono::steady_clock::now() >= due) break;
+        // A more urgent arrival during the gap re-checks eligibility on wake-up.
+        endpoint_->cv.wait_until(lock, due);
+        continue;
+      }
+      endpoint_->cv.wait(lock);
+    }
+    endpoint_->busy = true;
+    ++endpoint_->serving_ticket[c];
+    lock.unlock();
+    endpoint_->granted[c].fetch_add(1, std::memory_order_relaxed);
+    endpoint_->queue_wait[c].record(std::chrono::steady_clock::now() - enqueued);
+    owns_ = true;
+  }
+
+  // Non-preemptive variant: only takes the endpoint when nobody is active or
+  // queued and the inter-frame gap has already elapsed.
+  GatewaySerialGuard(const std::string& endpoint_key, std::uint32_t min_gap_ms, std::try_to_lock_t)
+      : endpoint_(GatewayScheduler::instance().endpoint(endpoint_key)),
+        min_gap_(std::chrono::milliseconds(min_gap_ms)) {
+    std::lock_guard<std::mutex> lock(endpoint_->mutex);
+    if (endpoint_->busy) return;
+    for (std::size_t c = 0; c < kBusPriorityCount; ++c) {
+      if (endpoint_->waiting(c) > 0) return;
+    }
+    if (endpoint_->has_last_done &&
+        std::chrono::steady_clock::now() < endpoint_->last_done + min_gap_) {
+      return;
     }
+    endpoint_->busy = true;
+    owns_ = true;
   }
 
   ~GatewaySerialGuard() {
-    lastSendByEndpoint()[endpoint_key_] = std::chrono::steady_clock::now();
+    if (!owns_) return;
+    {
+      std::lock_guard<std::mutex> lock(endpoint_->mutex);
+      endpoint_->last_done = std::chrono::steady_clock::now();
+      endpoint_->has_last_done = true;
+      endpoint_->busy = false;
+    }
+    endpoint_->cv.notify_all();
   }
 
+  bool owns() const { return owns_; }
+
   GatewaySerialGuard(const GatewaySerialGuard&) = delete;
   GatewaySerialGuard& operator=(const GatewaySerialGuard&) = delete;
 
  private:
-  static std::mutex& globalMutex() {
-    static std::mutex mtx;
-    return mtx;
-  }
-
-  static std::unordered_map<std::string, std::chrono::steady_clock::time_point>& lastSendByEndpoint() {
-    static std::unordered_map<std::string, std::chrono::steady_clock::time_point> last_by_endpoint;
-    return last_by_endpoint;
+  // Bus idle, nothing more urgent queued, and this ticket heads its class.
+  bool eligibleLocked(std::size_t c, std::uint64_t ticket) const {
+    if (endpoint_->busy) return false;
+    for (std::size_t higher = 0; higher < c; ++higher) {
+      if (endpoint_->waiting(higher) > 0) return false;
+    }
+    return endpoint_->serving_ticket[c] == ticket;
   }
 
-  std::string endpoint_key_;
+  std::shared_ptr<GatewayScheduler::Endpoint> endpoint_;
   std::chrono::steady_clock::duration min_gap_;
-  std::unique_lock<std::mutex> lock_;
+  bool owns_ = false;
 };
 
 }  // namespace common
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Minimal JSON DOM for config files. parse() tokenizes the text in a single
+// pass and reports the line/column of the first syntax error. Object members
+// keep file order; lookups only look at direct children and the last
+// duplicate key wins.
+class JsonValue {
+ public:
+  enum class Type : std::uint8_t { kNull = 0, kBool, kNumber, kString, kArray, kObject };
+
+  using Member = std::pair<std::string, JsonValue>;
+
+  JsonValue() = default;
+
+  static bool parse(const std::string& text, JsonValue* out, std::string* error) {
+    Parser p(text);
+    JsonValue root;
+    if (!p.parseValue(&root, 0) || !p.finish()) {
+      if (error) *error = p.error();
+      return false;
+    }
+    if (out) *out = std::move(root);
+    return true;
+  }
+
+  Type type() const { return type_; }
+  bool isNull() const { return type_ == Type::kNull; }
+  bool isBool() const { return type_ == Type::kBool; }
+  bool isNumber() const { return type_ == Type::kNumber; }
+  bool isString() const { return type_ == Type::kString; }
+  bool isArray() const { return type_ == Type::kArray; }
+  bool isObject() const { return type_ == Type::kObject; }
+
+  bool asBool() const { return bool_; }
+  double asNumber() const { return number_; }
+  const std::string& asString() const { return string_; }
+
+  // Array elements or object member count.
+  std::size_t size() const { return isArray() ? items_.size() : (isObject() ? members_.size() : 0); }
+  const JsonValue& at(std::size_t i) const { return items_[i]; }
+  const std::vector<Member>& members() const { return members_; }
+
+  const JsonValue* find(const std::string& key) const {
+    if (!isObject()) return nullptr;
+    for (std::size_t i = members_.size(); i > 0; --i) {
+      if (members_[i - 1].first == key) return &members_[i - 1].second;
+    }
+    return nullptr;
+  }
+
+  const JsonValue* findObject(const std::string& key) const {
+    const JsonValue* v = find(key);
+    return (v && v->isObject()) ? v : nullptr;
+  }
+
+  const JsonValue* findArray(const std::string& key) const {
+    const JsonValue* v = find(key);
+    return (v && v->isArray()) ? v : nullptr;
+  }
+
+  // Binary form used by the config cache: one tag byte per value, then a
+  // payload (bool byte, raw double, or u32 length-prefixed strings / lists).
+  void serialize(std::string* out) const {
+    out->push_back(static_cast<char>(type_));
+    switch (type_) {
+      case Type::kNull:
+        break;
+      case Type::kBool:
+        out->push_back(bool_ ? 1 : 0);
+        break;
+      case Type::kNumber:
+        out->append(reinterpret_cast<const char*>(&number_), sizeof(number_));
+        break;
+      case Type::kString:
+        putString(out, string_);
+        break;
+      case Type::kArray:
+        putU32(out, static_cast<std::uint32_t>(items_.size()));
+        for (std::size_t i = 0; i < items_.size(); ++i) items_[i].serialize(out);
+        break;
+      case Type::kObject:
+        putU32(out, static_cast<std::uint32_t>(members_.size()));
+        for (std::size_t i = 0; i < members_.size(); ++i) {
+          putString(out, members_[i].first);
+          members_[i].second.serialize(out);
+        }
+        break;
+    }
+  }
+
+  // Rebuild from serialize() output; false on truncated or malformed data.
+  static bool deserialize(const char* data, std::size_t size, JsonValue* out) {
+    Reader r{data, data + size};
+    JsonValue root;
+    if (!root.read(&r, 0) || r.cur != r.end) return false;
+    if (out) *out = std::move(root);
+    return true;
+  }
+
+ private:
+  static constexpr int kMaxDepth = 64;
+
+  struct Reader {
+    const char* cur;
+    const char* end;
+  };
+
+  static void putU32(std::string* out, std::uint32_t v) {
+    out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+  }
+
+  static void putString(std::string* out, const std::string& s) {
+    putU32(out, static_cast<std::uint32_t>(s.size()));
+    out->append(s);
+  }
+
+  static bool getU32(Reader* r, std::uint32_t* v) {
+    if (static_cast<std::size_t>(r->end - r->cur) < sizeof(*v)) return false;
+    std::memcpy(v, r->cur, sizeof(*v));
+    r->cur += sizeof(*v);
+    return true;
+  }
+
+  static bool getString(Reader* r, std::string* s) {
+    std::uint32_t n = 0;
+    if (!getU32(r, &n) || static_cast<std::size_t>(r->end - r->cur) < n) return false;
+    s->assign(r->cur, n);
+    r->cur += n;
+    return true;
+  }
+
+  bool read(Reader* r, int depth) {
+    if (depth > kMaxDepth || r->cur >= r->end) return false;
+    const std::uint8_t tag = static_cast<std::uint8_t>(*r->cur++);
+    if (tag > static_cast<std::uint8_t>(Type::kObject)) return false;
+    type_ = static_cast<Type>(tag);
+    std::uint32_t n = 0;
+    switch (type_) {
+      case Type::kNull:
+        return true;
+      case Type::kBool:
+        if (r->cur >= r->end) return false;
+        bool_ = *r->cur++ != 0;
+        return true;
+      case Type::kNumber:
+        if (static_cast<std::size_t>(r->end - r->cur) < sizeof(number_)) return false;
+        std::memcpy(&number_, r->cur, sizeof(number_));
+        r->cur += sizeof(number_);
+        return true;
+      case Type::kString:
+        return getString(r, &string_);
+      case Type::kArray:
+        if (!getU32(r, &n)) return false;
+        // Every element takes at least one byte; a larger count is a corrupt cache.
+        if (n > static_cast<std::size_t>(r->end - r->cur)) return false;
+        items_.resize(n);
+        for (std::uint32_t i = 0; i < n; ++i) {
+          if (!items_[i].read(r, depth + 1)) return false;
+        }
+        return true;
+      case Type::kObject:
+        if (!getU32(r, &n)) return false;
+        if (n > static_cast<std::size_t>(r->end - r->cur)) return false;
+        members_.resize(n);
+        for (std::uint32_t i = 0; i < n; ++i) {
+          if (!getString(r, &members_[i].first) || !members_[i].second.read(r, depth + 1)) return false;
+        }
+        return true;
+    }
+    return false;
+  }
+
+  class Parser {
+   public:
+    explicit Parser(const std::string& text) : begin_(text.data()), cur_(text.data()), end_(text.data() + text.size()) {}
+
+    const std::string& error() const { return error_; }
+
+    bool finish() {
+      skipWhitespace();
+      if (cur_ != end_) return fail("unexpected trailing data");
+      return true;
+    }
+
+    bool parseValue(JsonValue* out, int depth) {
+      if (depth > kMaxDepth) return fail("nesting too deep");
+      skipWhitespace();
+      if (cur_ == end_) return fail("unexpected end of input");
+      switch (*cur_) {
+        case '{':
+          return parseObject(out, depth);
+        case '[':
+          return parseArray(out, depth);
+        case '"':
+          out->type_ = Type::kString;
+          return parseString(&out->string_);
+        case 't':
+          out->type_ = Type::kBool;
+          out->bool_ = true;
+          return literal("true");
+        case 'f':
+          out->type_ = Type::kBool;
+          out->bool_ = false;
+          return literal("false");
+        case 'n':
+          out->type_ = Type::kNull;
+          return literal("null");
+        default:
+          out->type_ = Type::kNumber;
+          return parseNumber(&out->number_);
+      }
+    }
+
+   private:
+    bool fail(const char* what) {
+      if (!error_.empty()) return false;
+      int line = 1;
+      int column = 1;
+      for (const char* p = begin_; p < cur_ && p < end_; ++p) {
+        if (*p == '\n') {
+          ++line;
+          column = 1;
+        } else {
+          ++column;
+        }
+      }
+      error_ = std::string(what) + " at line " + std::to_string(line) + ", column " + std::to_string(column);
+      return false;
+    }
+
+    void skipWhitespace() {
+      while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\t' || *cur_ == '\n' || *cur_ == '\r')) ++cur_;
+    }
+
+    bool consume(char ch) {
+      skipWhitespace();
+      if (cur_ < end_ && *cur_ == ch) {
+        ++cur_;
+        return true;
+      }
+      return false;
+    }
+
+    bool literal(const char* word) {
+      const std::size_t n = std::strlen(word);
+      if (static_cast<std::size_t>(end_ - cur_) < n || std::memcmp(cur_, word, n) != 0) {
+        return fail("invalid literal");
+      }
+      cur_ += n;
+      return true;
+    }
+
+    bool parseObject(JsonValue* out, int depth) {
+      out->type_ = Type::kObject;
+      ++cur_;  // '{'
+      if (consume('}')) return true;
+      for (;;) {
+        skipWhitespace();
+        if (cur_ == end_ || *cur_ != '"') return fail("expected object key");
+        out->members_.emplace_back();
+        Member& member = out->members_.back();
+        if (!parseString(&member.first)) return false;
+        if (!consume(':')) return fail("expected ':'");
+        if (!parseValue(&member.second, depth + 1)) return false;
+        if (consume(',')) continue;
+        if (consume('}')) return true;
+        return fail("expected ',' or '}'");
+      }
+    }
+
+    bool parseArray(JsonValue* out, int depth) {
+      out->type_ = Type::kArray;
+      ++cur_;  // '['
+      if (consume(']')) return true;
+      for (;;) {
+        out->items_.emplace_back();
+        if (!parseValue(&out->items_.back(), depth + 1)) return false;
+        if (consume(',')) continue;
+        if (consume(']')) return true;
+        return fail("expected ',' or ']'");
+      }
+    }
+
+    bool parseNumber(double* out) {
+      const char* start = cur_;
+      if (cur_ < end_ && *cur_ == '-') ++cur_;
+      if (cur_ == end_ || *cur_ < '0' || *cur_ > '9') return fail("invalid value");
+      while (cur_ < end_ && ((*cur_ >= '0' && *cur_ <= '9') || *cur_ == '.' || *cur_ == 'e' ||
+                             *cur_ == 'E' || *cur_ == '+' || *cur_ == '-')) {
+        ++cur_;
+      }
+      const std::string token(start, cur_);
+      char* parsed_end = nullptr;
+      *out = std::strtod(token.c_str(), &parsed_end);
+      if (parsed_end != token.c_str() + token.size() || !std::isfinite(*out)) {
+        cur_ = start;
+        return fail("invalid number");
+      }
+      return true;
+    }
+
+    bool parseHex4(unsigned* out) {
+      if (end_ - cur_ < 4) return fail("truncated \\u escape");
+      unsigned v = 0;
+      for (int i = 0; i < 4; ++i) {
+        const char c = *cur_++;
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= static_cast<unsigned>(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= static_cast<unsigned>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= static_cast<unsigned>(c - 'A' + 10);
+        else return fail("invalid \\u escape");
+      }
+      *out = v;
+      return true;
+    }
+
+    static void appendUtf8(std::string* out, unsigned cp) {
+      if (cp < 0x80) {
+        out->push_back(static_cast<char>(cp));
+      } else if (cp < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      } else if (cp < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      } else {
+        out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+      }
+    }
+
+    bool parseString(std::string* out) {
+      ++cur_;  // opening quote
+      out->clear();
+      for (;;) {
+        // Copy the run up to the next quote or escape in one go.
+        const char* run = cur_;
+        while (cur_ < end_ && *cur_ != '"' && *cur_ != '\\') {
+          if (static_cast<unsigned char>(*cur_) < 0x20) return fail("control character in string");
+          ++cur_;
+        }
+        out->append(run, cur_);
+        if (cur_ == end_) return fail("unterminated string");
+        if (*cur_++ == '"') return true;
+        if (cur_ == end_) return fail("unterminated string");
+        const char esc = *cur_++;
+        switch (esc) {
+          case '"': out->push_back('"'); break;
+          case '\\': out->push_back('\\'); break;
+          case '/': out->push_back('/'); break;
+          case 'b': out->push_back('\b'); break;
+          case 'f': out->push_back('\f'); break;
+          case 'n': out->push_back('\n'); break;
+          case 'r': out->push_back('\r'); break;
+          case 't': out->push_back('\t'); break;
+          case 'u': {
+            unsigned cp = 0;
+            if (!parseHex4(&cp)) return false;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+              unsigned low = 0;
+              if (end_ - cur_ < 2 || cur_[0] != '\\' || cur_[1] != 'u') return fail("unpaired surrogate");
+              cur_ += 2;
+              if (!parseHex4(&low)) return false;
+              if (low < 0xDC00 || low > 0xDFFF) return fail("unpaired surrogate");
+              cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            }
+            appendUtf8(out, cp);
+            break;
+          }
+          default:
+            --cur_;
+            return fail("invalid escape");
+        }
+      }
+    }
+
+    const char* begin_;
+    const char* cur_;
+    const char* end_;
+    std::string error_;
+  };
+
+  Type type_ = Type::kNull;
+  bool bool_ = false;
+  double number_ = 0.0;
+  std::string string_;
+  std::vector<JsonValue> items_;
+  std::vector<Member> members_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
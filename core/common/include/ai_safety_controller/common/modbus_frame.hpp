@@ -0,0 +1,342 @@
+#pragma once
+
+#include "ai_safety_controller/common/async_log.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Largest Modbus ADU: MBAP header (7) + PDU (253).
+constexpr std::size_t kModbusMaxFrameSize = 260;
+
+// Fixed-capacity frame buffer used for requests and responses, so the polling
+// paths never touch the heap. Mirrors the small part of std::vector the
+// drivers rely on; writes beyond capacity are rejected instead of growing.
+class ModbusFrame {
+ public:
+  const std::uint8_t* data() const { return bytes_.data(); }
+  std::uint8_t* data() { return bytes_.data(); }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  static constexpr std::size_t capacity() { return kModbusMaxFrameSize; }
+  const std::uint8_t* begin() const { return bytes_.data(); }
+  const std::uint8_t* end() const { return bytes_.data() + size_; }
+  std::uint8_t operator[](std::size_t i) const { return bytes_[i]; }
+  std::uint8_t& operator[](std::size_t i) { return bytes_[i]; }
+
+  void clear() { size_ = 0; }
+
+  bool resize(std::size_t n) {
+    if (n > capacity()) return false;
+    size_ = n;
+    return true;
+  }
+
+  bool assign(const std::uint8_t* first, const std::uint8_t* last) {
+    size_ = 0;
+    return append(first, last);
+  }
+
+  bool append(const std::uint8_t* first, const std::uint8_t* last) {
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (size_ + n > capacity()) return false;
+    if (n > 0) std::memcpy(bytes_.data() + size_, first, n);
+    size_ += n;
+    return true;
+  }
+
+  bool push_back(std::uint8_t b) {
+    if (size_ >= capacity()) return false;
+    bytes_[size_++] = b;
+    return true;
+  }
+
+  friend bool operator==(const ModbusFrame& a, const ModbusFrame& b) {
+    return a.size_ == b.size_ && std::memcmp(a.bytes_.data(), b.bytes_.data(), a.size_) == 0;
+  }
+  friend bool operator!=(const ModbusFrame& a, const ModbusFrame& b) { return !(a == b); }
+
+ private:
+  std::array<std::uint8_t, kModbusMaxFrameSize> bytes_;
+  std::size_t size_ = 0;
+};
+
+inline std::uint16_t readBe16(const std::uint8_t* p) {
+  return static_cast<std::uint16_t>((static_cast<std::uint16_t>(p[0]) << 8) | p[1]);
+}
+
+namespace detail {
+
+struct Crc16Table {
+  std::uint16_t entries[256];
+  constexpr Crc16Table() : entries() {
+    for (int i = 0; i < 256; ++i) {
+      std::uint16_t crc = static_cast<std::uint16_t>(i);
+      for (int j = 0; j < 8; ++j) {
+        crc = (crc & 1) ? static_cast<std::uint16_t>((crc >> 1) ^ 0xA001)
+                        : static_cast<std::uint16_t>(crc >> 1);
+      }
+      entries[i] = crc;
+    }
+  }
+};
+
+constexpr Crc16Table kCrc16Table{};
+
+}  // namespace detail
+
+// CRC16/MODBUS (poly 0xA001 reflected, init 0xFFFF), one table lookup per byte.
+inline std::uint16_t crc16Modbus(const std::uint8_t* data, std::size_t len) {
+  std::uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; ++i) {
+    crc = static_cast<std::uint16_t>((crc >> 8) ^ detail::kCrc16Table.entries[(crc ^ data[i]) & 0xFF]);
+  }
+  return crc;
+}
+
+// Encode a request whose PDU body is address + one 16-bit word (FC 01~06:
+// quantity for reads, value for single writes).
+inline bool encodeMbapRequest(ModbusFrame* out,
+                              std::uint16_t transaction_id,
+                              std::uint8_t unit_id,
+                              std::uint8_t function_code,
+                              std::uint16_t address,
+                              std::uint16_t data) {
+  if (!out || !out->resize(12)) return false;
+  std::uint8_t* p = out->data();
+  p[0] = static_cast<std::uint8_t>((transaction_id >> 8) & 0xFF);
+  p[1] = static_cast<std::uint8_t>(transaction_id & 0xFF);
+  p[2] = 0x00;  // Protocol id.
+  p[3] = 0x00;
+  p[4] = 0x00;  // Length: unit id + 5 byte PDU.
+  p[5] = 0x06;
+  p[6] = unit_id;
+  p[7] = function_code;
+  p[8] = static_cast<std::uint8_t>((address >> 8) & 0xFF);
+  p[9] = static_cast<std::uint8_t>(address & 0xFF);
+  p[10] = static_cast<std::uint8_t>((data >> 8) & 0xFF);
+  p[11] = static_cast<std::uint8_t>(data & 0xFF);
+  return true;
+}
+
+// Encode an FC0F Write Multiple Coils request for up to 16 coils starting at
+// address; bit i of coils is the state of coil address + i.
+inline bool encodeMbapWriteCoils(ModbusFrame* out,
+                                 std::uint16_t transaction_id,
+                                 std::uint8_t unit_id,
+                                 std::uint16_t address,
+                                 std::uint16_t quantity,
+                                 std::uint16_t coils) {
+  if (quantity < 1 || quantity > 16) return false;
+  const std::uint8_t byte_count = quantity > 8 ? 2 : 1;
+  if (!out || !out->resize(13 + byte_count)) return false;
+  const std::uint16_t mask = static_cast<std::uint16_t>(quantity == 16 ? 0xFFFF : (1u << quantity) - 1);
+  coils = static_cast<std::uint16_t>(coils & mask);
+  std::uint8_t* p = out->data();
+  p[0] = static_cast<std::uint8_t>((transaction_id >> 8) & 0xFF);
+  p[1] = static_cast<std::uint8_t>(transaction_id & 0xFF);
+  p[2] = 0x00;  // Protocol id.
+  p[3] = 0x00;
+  p[4] = 0x00;  // Length: unit id + fc + address + quantity + byte count + data.
+  p[5] = static_cast<std::uint8_t>(7 + byte_count);
+  p[6] = unit_id;
+  p[7] = 0x0F;
+  p[8] = static_cast<std::uint8_t>((address >> 8) & 0xFF);
+  p[9] = static_cast<std::uint8_t>(address & 0xFF);
+  p[10] = static_cast<std::uint8_t>((quantity >> 8) & 0xFF);
+  p[11] = static_cast<std::uint8_t>(quantity & 0xFF);
+  p[12] = byte_count;
+  p[13] = static_cast<std::uint8_t>(coils & 0xFF);  // Coils are packed LSB first.
+  if (byte_count == 2) p[14] = static_cast<std::uint8_t>((coils >> 8) & 0xFF);
+  return true;
+}
+
+inline bool encodeRtuRequest(ModbusFrame* out,
+                             std::uint8_t unit_id,
+                             std::uint8_t function_code,
+                             std::uint16_t address,
+                             std::uint16_t data) {
+  if (!out || !out->resize(8)) return false;
+  std::uint8_t* p = out->data();
+  p[0] = unit_id;
+  p[1] = function_code;
+  p[2] = static_cast<std::uint8_t>((address >> 8) & 0xFF);
+  p[3] = static_cast<std::uint8_t>(address & 0xFF);
+  p[4] = static_cast<std::uint8_t>((data >> 8) & 0xFF);
+  p[5] = static_cast<std::uint8_t>(data & 0xFF);
+  const std::uint16_t crc = crc16Modbus(p, 6);
+  p[6] = static_cast<std::uint8_t>(crc & 0xFF);
+  p[7] = static_cast<std::uint8_t>((crc >> 8) & 0xFF);
+  return true;
+}
+
+// Non-owning view over the register words of a read response.
+struct RegisterView {
+  const std::uint8_t* bytes = nullptr;
+  std::size_t count = 0;
+
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  std::uint16_t operator[](std::size_t i) const { return readBe16(bytes + i * 2); }
+};
+
+enum class DecodeError {
+  kNone,
+  kTooShort,
+  kException,         // Exception response (function code | 0x80).
+  kFunctionMismatch,  // Some other function code than the one requested.
+  kLengthMismatch,    // Frame size disagrees with the byte count.
+  kBadCrc,
+  kShortPayload,      // Fewer registers than requested.
+};
+
+struct RegisterDecode {
+  DecodeError error = DecodeError::kTooShort;
+  std::uint8_t exception_code = 0;
+  std::uint8_t function_code = 0;  // As received; differs from the request on mismatch.
+  std::size_t expected_size = 0;
+  RegisterView registers;
+
+  bool ok() const { return error == DecodeError::kNone; }
+};
+
+// Decode an FC03/04 MBAP response: header(7) + fc + byte count + data.
+inline RegisterDecode decodeMbapRegisters(const std::uint8_t* frame,
+                                          std::size_t size,
+                                          std::uint8_t function_code,
+                                          std::uint16_t quantity) {
+  RegisterDecode r;
+  if (size < 9) return r;
+  r.function_code = frame[7];
+  if (frame[7] == (function_code | 0x80)) {
+    r.error = DecodeError::kException;
+    r.exception_code = frame[8];
+    return r;
+  }
+  if (frame[7] != function_code) {
+    r.error = DecodeError::kFunctionMismatch;
+    return r;
+  }
+  const std::uint8_t data_len = frame[8];
+  r.expected_size = static_cast<std::size_t>(9) + data_len;
+  if (size != r.expected_size) {
+    r.error = DecodeError::kLengthMismatch;
+    return r;
+  }
+  if (data_len < quantity * 2) {
+    r.error = DecodeError::kShortPayload;
+    return r;
+  }
+  r.registers.bytes = frame + 9;
+  r.registers.count = quantity;
+  r.error = DecodeError::kNone;
+  return r;
+}
+
+// Decode an FC03/04 RTU response: unit + fc + byte count + data + CRC.
+inline RegisterDecode decodeRtuRegisters(const std::uint8_t* frame,
+                                         std::size_t size,
+                                         std::uint8_t function_code,
+                                         std::uint16_t quantity) {
+  RegisterDecode r;
+  if (size < 5) return r;
+  r.function_code = frame[1];
+  if (frame[1] == (function_code | 0x80)) {
+    r.error = DecodeError::kException;
+    r.exception_code = frame[2];
+    return r;
+  }
+  if (frame[1] != function_code) {
+    r.error = DecodeError::kFunctionMismatch;
+    return r;
+  }
+  const std::uint8_t data_len = frame[2];
+  const std::size_t payload_end = static_cast<std::size_t>(3) + data_len;
+  r.expected_size = payload_end + 2;
+  if (size < r.expected_size) {
+    r.error = DecodeError::kLengthMismatch;
+    return r;
+  }
+  const std::uint16_t crc_recv = static_cast<std::uint16_t>(frame[payload_end]) |
+                                 static_cast<std::uint16_t>(frame[payload_end + 1] << 8);
+  if (crc16Modbus(frame, payload_end) != crc_recv) {
+    r.error = DecodeError::kBadCrc;
+    return r;
+  }
+  if (data_len < quantity * 2) {
+    r.error = DecodeError::kShortPayload;
+    return r;
+  }
+  r.registers.bytes = frame + 3;
+  r.registers.count = quantity;
+  r.error = DecodeError::kNone;
+  return r;
+}
+
+// Request description for log lines. Holds only the raw fields (or a borrowed
+// string) and formats them when streamed, i.e. only when something is printed.
+class LazyContext {
+ public:
+  // Implicit so call sites can keep passing plain strings. Only the pointer is
+  // kept: the text must outlive the LazyContext, so temporaries are rejected.
+  LazyContext(const char* text) : text_(text) {}
+  LazyContext(const std::string& text) : text_(text.c_str()) {}
+  LazyContext(std::string&&) = delete;
+  LazyContext(const char* label,
+              std::uint8_t function_code,
+              std::uint8_t unit_id,
+              std::uint16_t address,
+              std::uint16_t quantity)
+      : text_(label),
+        has_fields_(true),
+        function_code_(function_code),
+        unit_id_(unit_id),
+        address_(address),
+        quantity_(quantity) {}
+
+  std::string str() const {
+    std::ostringstream oss;
+    oss << *this;
+    return oss.str();
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const LazyContext& ctx) {
+    if (ctx.text_) os << ctx.text_;
+    if (!ctx.has_fields_) return os;
+    const std::ios_base::fmtflags flags = os.flags();
+    os << " fc=0x" << std::hex << std::uppercase << static_cast<int>(ctx.function_code_)
+       << ", uid=" << std::dec << static_cast<int>(ctx.unit_id_) << ", addr=0x" << std::hex
+       << std::uppercase << ctx.address_ << ", qty=" << std::dec << ctx.quantity_;
+    os.flags(flags);
+    return os;
+  }
+
+  friend LogLine& operator<<(LogLine& line, const LazyContext& ctx) {
+    if (ctx.text_) line << ctx.text_;
+    if (!ctx.has_fields_) return line;
+    return line.printf(" fc=0x%X, uid=%d, addr=0x%X, qty=%u",
+                       static_cast<unsigned>(ctx.function_code_),
+                       static_cast<int>(ctx.unit_id_),
+                       static_cast<unsigned>(ctx.address_),
+                       static_cast<unsigned>(ctx.quantity_));
+  }
+
+ private:
+  const char* text_ = nullptr;
+  bool has_fields_ = false;
+  std::uint8_t function_code_ = 0;
+  std::uint8_t unit_id_ = 0;
+  std::uint16_t address_ = 0;
+  std::uint16_t quantity_ = 0;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
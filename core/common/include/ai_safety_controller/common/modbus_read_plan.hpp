@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Collect the register reads one poll cycle needs and merge contiguous or
+// near-contiguous ranges (same unit id and function code) into as few PDUs as
+// possible. gap_tolerance is the number of unused registers allowed between
+// two ranges before they are split; max_quantity caps a single PDU.
+class ModbusReadPlan {
+ public:
+  struct Block {
+    std::uint8_t unit_id = 0;
+    std::uint8_t function_code = 0;
+    std::uint16_t address = 0;
+    std::uint16_t quantity = 0;
+  };
+
+  explicit ModbusReadPlan(std::uint16_t gap_tolerance = 0, std::uint16_t max_quantity = 125)
+      : gap_tolerance_(gap_tolerance), max_quantity_(std::max<std::uint16_t>(1, max_quantity)) {}
+
+  void add(std::uint8_t unit_id, std::uint8_t function_code, std::uint16_t address, std::uint16_t quantity) {
+    if (quantity == 0) return;
+    Request r;
+    r.range.unit_id = unit_id;
+    r.range.function_code = function_code;
+    r.range.address = address;
+    r.range.quantity = quantity;
+    requests_.push_back(r);
+    planned_ = false;
+  }
+
+  const std::vector<Block>& blocks() {
+    if (!planned_) plan();
+    return blocks_;
+  }
+
+  // Outcome of one read(). Only an exception reply for an illegal
+  // function/address/value says the merged range is unreadable as a whole;
+  // timeouts, I/O errors and other exceptions (device busy, gateway target
+  // not responding) mean the link itself failed.
+  enum class ReadStatus { kOk, kIllegalRange, kFailed };
+
+  static ReadStatus readStatus(bool ok, std::uint8_t exception_code) {
+    if (ok) return ReadStatus::kOk;
+    return exception_code >= 0x01 && exception_code <= 0x03 ? ReadStatus::kIllegalRange
+                                                            : ReadStatus::kFailed;
+  }
+
+  // read(const Block&, std::vector<uint16_t>* values) issues one PDU and
+  // returns a ReadStatus. A merged block answered with kIllegalRange is
+  // retried as its original requests, so one unsupported register does not
+  // take down the whole cycle. kFailed stops the cycle: the remaining reads
+  // would only wait out the same timeout.
+  // Returns the number of requests left without values.
+  template <typename ReadFn>
+  std::size_t execute(ReadFn&& read) {
+    if (!planned_) plan();
+    std::vector<std::uint16_t> values;
+    bool link_failed = false;
+    for (std::size_t b = 0; b < blocks_.size() && !link_failed; ++b) {
+      const Block& block = blocks_[b];
+      values.clear();
+      ReadStatus status = read(block, &values);
+      if (status == ReadStatus::kOk && values.size() < block.quantity) status = ReadStatus::kFailed;
+      if (status == ReadStatus::kFailed) break;
+      for (std::size_t i = 0; i < requests_.size() && !link_failed; ++i) {
+        Request& r = requests_[i];
+        if (r.block_index != b) continue;
+        if (status == ReadStatus::kOk) {
+          const std::size_t offset = static_cast<std::size_t>(r.range.address - block.address);
+          r.values.assign(values.begin() + offset, values.begin() + offset + r.range.quantity);
+          r.ok = true;
+        } else if (block.quantity != r.range.quantity) {
+          std::vector<std::uint16_t> single;
+          ReadStatus single_status = read(r.range, &single);
+          if (single_status == ReadStatus::kOk && single.size() < r.range.quantity) {
+            single_status = ReadStatus::kFailed;
+          }
+          r.ok = single_status == ReadStatus::kOk;
+          if (r.ok) r.values.assign(single.begin(), single.begin() + r.range.quantity);
+          link_failed = single_status == ReadStatus::kFailed;
+        }
+      }
+    }
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < requests_.size(); ++i) {
+      if (!requests_[i].ok) ++failed;
+    }
+    return failed;
+  }
+
+  bool value(std::uint8_t unit_id, std::uint8_t function_code, std::uint16_t address, std::uint16_t* out) const {
+    std::vector<std::uint16_t> v;
+    if (!values(unit_id, function_code, address, 1, &v)) return false;
+    if (out) *out = v[0];
+    return true;
+  }
+
+  bool values(std::uint8_t unit_id,
+              std::uint8_t function_code,
+              std::uint16_t address,
+              std::uint16_t quantity,
+              std::vector<std::uint16_t>* out) const {
+    for (std::size_t i = 0; i < requests_.size(); ++i) {
+      const Request& r = requests_[i];
+      if (!r.ok || r.range.unit_id != unit_id || r.range.function_code != function_code) continue;
+      const std::uint32_t end = static_cast<std::uint32_t>(address) + quantity;
+      const std::uint32_t r_end = static_cast<std::uint32_t>(r.range.address) + r.range.quantity;
+      if (address < r.range.address || end > r_end) continue;
+      if (out) {
+        const std::size_t offset = static_cast<std::size_t>(address - r.range.address);
+        out->assign(r.values.begin() + offset, r.values.begin() + offset + quantity);
+      }
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  struct Request {
+    Block range;
+    std::size_t block_index = 0;
+    bool ok = false;
+    std::vector<std::uint16_t> values;
+  };
+
+  void plan() {
+    blocks_.clear();
+    std::vector<std::size_t> order(requests_.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+      const Block& x = requests_[a].range;
+      const Block& y = requests_[b].range;
+      if (x.unit_id != y.unit_id) return x.unit_id < y.unit_id;
+      if (x.function_code != y.function_code) return x.function_code < y.function_code;
+      return x.address < y.address;
+    });
+
+    for (std::size_t k = 0; k < order.size(); ++k) {
+      Request& r = requests_[order[k]];
+      const std::uint32_t r_end = static_cast<std::uint32_t>(r.range.address) + r.range.quantity;
+      if (!blocks_.empty()) {
+        Block& last = blocks_.back();
+        const std::uint32_t last_end = static_cast<std::uint32_t>(last.address) + last.quantity;
+        const std::uint32_t merged_end = std::max(last_end, r_end);
+        if (last.unit_id == r.range.unit_id && last.function_code == r.range.function_code &&
+            r.range.address <= last_end + gap_tolerance_ &&
+            merged_end - last.address <= max_quantity_) {
+          last.quantity = static_cast<std::uint16_t>(merged_end - last.address);
+          r.block_index = blocks_.size() - 1;
+          continue;
+        }
+      }
+      blocks_.push_back(r.range);
+      r.block_index = blocks_.size() - 1;
+    }
+    planned_ = true;
+  }
+
+  std::uint16_t gap_tolerance_;
+  std::uint16_t max_quantity_;
+  bool planned_ = false;
+  std::vector<Request> requests_;
+  std::vector<Block> blocks_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
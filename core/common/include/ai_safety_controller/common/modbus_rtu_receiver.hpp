@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ai_safety_controller/common/modbus_frame.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Total RTU response length implied by the bytes received so far, or 0 while
+// it cannot be told yet (or for function codes without a fixed layout, which
+// then end on line silence).
+inline std::size_t rtuExpectedResponseLength(const std::uint8_t* p, std::size_t n) {
+  if (n < 2) return 0;
+  const std::uint8_t fc = p[1];
+  if (fc & 0x80) return 5;  // unit, fc|0x80, exception code, crc
+  switch (fc) {
+    case 0x01:
+    case 0x02:
+    case 0x03:
+    case 0x04:
+      return n < 3 ? 0 : static_cast<std::size_t>(3) + p[2] + 2;
+    case 0x05:
+    case 0x06:
+    case 0x0F:
+    case 0x10:
+      return 8;  // echo of address + value / quantity
+    default:
+      return 0;
+  }
+}
+
+// Modbus RTU end-of-frame silence (3.5 character times). Above 19200 baud the
+// spec fixes it at 1750 us.
+inline std::chrono::microseconds rtuFrameSilence(int baud, int bits_per_char) {
+  if (baud <= 0 || baud > 19200) return std::chrono::microseconds(1750);
+  return std::chrono::microseconds((static_cast<long long>(bits_per_char) * 3500000LL) / baud);
+}
+
+enum class RtuReceiveStatus {
+  kOk,
+  kTimeout,     // nothing arrived before the response timeout
+  kIncomplete,  // the line went silent before the frame was complete
+  kBadCrc,
+  kMismatch,    // complete frame, but for another unit / function code
+  kIoError,
+};
+
+inline const char* rtuReceiveStatusName(RtuReceiveStatus s) {
+  switch (s) {
+    case RtuReceiveStatus::kOk:
+      return "ok";
+    case RtuReceiveStatus::kTimeout:
+      return "timeout";
+    case RtuReceiveStatus::kIncomplete:
+      return "incomplete frame";
+    case RtuReceiveStatus::kBadCrc:
+      return "crc mismatch";
+    case RtuReceiveStatus::kMismatch:
+      return "unexpected unit/function";
+    case RtuReceiveStatus::kIoError:
+    default:
+      return "io error";
+  }
+}
+
+// Event-driven receive of one RTU response on a non-blocking serial fd.
+// Waits with poll() for the first byte (up to response_timeout), then keeps
+// reading until the length implied by the function code is reached, or the
+// line stays quiet for `silence`. Returns as soon as the frame is complete,
+// trimming anything after it, and checks CRC, unit id and function code.
+//
+// `silence` should be at least rtuFrameSilence(); USB-serial adapters hand
+// bytes over in latency-timer bursts, so callers usually pass a larger floor.
+inline RtuReceiveStatus receiveRtuFrame(int fd,
+                                        std::uint8_t unit_id,
+                                        std::uint8_t function_code,
+                                        std::chrono::milliseconds response_timeout,
+                                        std::chrono::microseconds silence,
+                                        ModbusFrame* out) {
+  using Clock = std::chrono::steady_clock;
+  out->clear();
+  const Clock::time_point deadline = Clock::now() + response_timeout;
+  std::size_t expected = 0;
+  while (true) {
+    Clock::time_point wait_until = deadline;
+    if (!out->empty()) wait_until = std::min(deadline, Clock::now() + silence);
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::microseconds>(wait_until - Clock::now()).count();
+    pollfd pfd{fd, POLLIN, 0};
+    // Round up so a sub-millisecond silence still waits one tick.
+    const int rc = ::poll(&pfd, 1, remaining <= 0 ? 0 : static_cast<int>((remaining + 999) / 1000));
+    if (rc < 0) {
+      if (errno == EINTR) continue;
+      return RtuReceiveStatus::kIoError;
+    }
+    if (rc == 0) {
+      if (out->empty()) return RtuReceiveStatus::kTimeout;
+      if (expected == 0 && out->size() >= 4) break;  // unknown layout: silence ends it
+      return RtuReceiveStatus::kIncomplete;
+    }
+    if (pfd.revents & (POLLERR | POLLNVAL)) return RtuReceiveStatus::kIoError;
+    const ssize_t n = ::read(fd, out->data() + out->size(), out->capacity() - out->size());
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+      return RtuReceiveStatus::kIoError;
+    }
+    if (n == 0) {
+      if (pfd.revents & POLLHUP) return out->empty() ? RtuReceiveStatus::kIoError : RtuReceiveStatus::kIncomplete;
+      continue;
+    }
+    out->resize(out->size() + static_cast<std::size_t>(n));
+    if (expected == 0) expected = rtuExpectedResponseLength(out->data(), out->size());
+    if (expected > out->capacity()) return RtuReceiveStatus::kIncomplete;
+    if (expected > 0 && out->size() >= expected) {
+      out->resize(expected);
+      break;
+    }
+    if (out->size() >= out->capacity()) break;
+  }
+
+  const std::size_t len = out->size();
+  const std::uint16_t crc = crc16Modbus(out->data(), len - 2);
+  if ((*out)[len - 2] != static_cast<std::uint8_t>(crc & 0xFF) ||
+      (*out)[len - 1] != static_cast<std::uint8_t>((crc >> 8) & 0xFF)) {
+    return RtuReceiveStatus::kBadCrc;
+  }
+  if ((*out)[0] != unit_id || ((*out)[1] & 0x7F) != function_code) return RtuReceiveStatus::kMismatch;
+  return RtuReceiveStatus::kOk;
+}
+
+}  // namespace common
+}  // namespace ai_safety_controller
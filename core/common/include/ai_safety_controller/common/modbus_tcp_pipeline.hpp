@@ -0,0 +1,317 @@
+#pragma once
+
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pool.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Optional pipelined Modbus TCP mode for gateways that accept several
+// outstanding MBAP transactions. Callers on the same endpoint write their
+// requests back-to-back on one shared socket; a reader thread per endpoint
+// matches replies by transaction id. The pipeline assigns its own transaction
+// ids on the wire and restores the caller's id in the returned frame, so
+// drivers with independent counters never collide. Endpoints that are not
+// configured here stay on the strictly serial path.
+class ModbusTcpPipeline {
+ public:
+  static ModbusTcpPipeline& instance() {
+    static ModbusTcpPipeline pipeline;
+    return pipeline;
+  }
+
+  ~ModbusTcpPipeline() {
+    std::unordered_map<std::string, std::shared_ptr<Endpoint>> endpoints;
+    {
+      std::lock_guard<std::mutex> lock(map_mutex_);
+      endpoints.swap(endpoints_);
+    }
+    for (auto& kv : endpoints) stopEndpoint(kv.second);
+  }
+
+  ModbusTcpPipeline(const ModbusTcpPipeline&) = delete;
+  ModbusTcpPipeline& operator=(const ModbusTcpPipeline&) = delete;
+
+  void configure(const std::string& ip, std::uint16_t port, bool enabled, int max_in_flight) {
+    const std::string key = ModbusTcpConnectionPool::endpointKey(ip, port);
+    std::shared_ptr<Endpoint> stale;
+    {
+      std::lock_guard<std::mutex> lock(map_mutex_);
+      auto it = endpoints_.find(key);
+      if (it != endpoints_.end()) {
+        stale = it->second;
+        endpoints_.erase(it);
+      }
+      if (enabled) {
+        auto ep = std::make_shared<Endpoint>();
+        ep->ip = ip;
+        ep->port = port;
+        ep->max_in_flight = max_in_flight < 1 ? 1 : max_in_flight;
+        ep->running.store(true);
+        ep->reader = std::thread([this, ep]() { readerLoop(ep); });
+        endpoints_[key] = ep;
+      }
+    }
+    if (stale) stopEndpoint(stale);
+  }
+
+  bool enabled(const std::string& ip, std::uint16_t port) {
+    return endpointFor(ip, port) != nullptr;
+  }
+
+  // Sends one MBAP request and waits until the reply with the matching
+  // transaction id arrives or timeout_sec elapses. *timed_out tells a deadline
+  // miss apart from connection errors.
+  bool exchange(const std::string& ip,
+                std::uint16_t port,
+                const ModbusFrame& request,
+                ModbusFrame* response,
+                double timeout_sec,
+                std::string* error,
+                bool* timed_out = nullptr) {
+    if (response) response->clear();
+    if (timed_out) *timed_out = false;
+    if (request.size() < 8) {
+      if (error) *error = "请求报文过短";
+      return false;
+    }
+    const std::shared_ptr<Endpoint> ep = endpointFor(ip, port);
+    if (!ep) {
+      if (error) *error = "端点未启用流水线模式";
+      return false;
+    }
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::microseconds(static_cast<long long>(timeout_sec * 1000000.0));
+
+    std::unique_lock<std::mutex> lock(ep->mutex);
+    const std::uint64_t seen_attempt = ep->connect_attempt;
+    if (!ep->cv.wait_until(lock, deadline, [&] {
+          return ep->in_flight < ep->max_in_flight && !ep->connecting;
+        })) {
+      if (error) *error = ep->connecting ? "等待流水线重连超时" : "流水线在途请求已满，等待超时";
+      if (timed_out) *timed_out = true;
+      return false;
+    }
+    if (ep->fd < 0 && ep->connect_attempt != seen_attempt && !ep->connect_error.empty()) {
+      // The reconnect we waited on failed; don't queue up another one behind it.
+      if (error) *error = ep->connect_error;
+      return false;
+    }
+    if (ep->fd < 0) {
+      // Single-flight reconnect: connect without holding ep->mutex so the
+      // reader and other callers are not stuck behind a connect timeout;
+      // they wait on `connecting` instead of dialing in parallel.
+      ep->connecting = true;
+      ++ep->connect_attempt;
+      lock.unlock();
+      const double remaining_sec =
+          std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+      std::string connect_error;
+      const int fd = ModbusTcpConnectionPool::instance().acquire(
+          ep->ip, ep->port, remaining_sec > 0.0 ? remaining_sec : 0.001, &connect_error);
+      lock.lock();
+      ep->connecting = false;
+      ep->cv.notify_all();
+      if (fd < 0) {
+        ep->connect_error = connect_error.empty() ? "连接失败" : connect_error;
+        if (error) *error = ep->connect_error;
+        return false;
+      }
+      if (!ep->running.load()) {
+        ModbusTcpConnectionPool::instance().discard(fd);
+        if (error) *error = "端点已停止";
+        return false;
+      }
+      ep->connect_error.clear();
+      ep->fd = fd;
+    }
+
+    std::uint16_t txid = ep->next_txid;
+    while (ep->pending.count(txid) != 0) ++txid;
+    ep->next_txid = static_cast<std::uint16_t>(txid + 1);
+
+    ModbusFrame wire = request;
+    wire[0] = static_cast<std::uint8_t>((txid >> 8) & 0xFF);
+    wire[1] = static_cast<std::uint8_t>(txid & 0xFF);
+    Pending pending;
+    ep->pending[txid] = &pending;
+    ++ep->in_flight;
+
+    if (!sendAll(ep->fd, wire.data(), wire.size())) {
+      // Wake the reader so it tears the connection down and fails everyone.
+      ::shutdown(ep->fd, SHUT_RDWR);
+      ep->pending.erase(txid);
+      --ep->in_flight;
+      ep->cv.notify_all();
+      if (error) *error = std::string("发送失败: ") + std::strerror(errno);
+      return false;
+    }
+
+    const bool done = ep->cv.wait_until(lock, deadline, [&] { return pending.done; });
+    ep->pending.erase(txid);
+    --ep->in_flight;
+    ep->cv.notify_all();
+    if (!done || !pending.ok) {
+      if (error) *error = done ? "连接中断" : "无响应（流水线等待超时）";
+      if (timed_out) *timed_out = !done;
+      return false;
+    }
+    pending.response[0] = request[0];
+    pending.response[1] = request[1];
+    if (response) *response = pending.response;
+    return true;
+  }
+
+ private:
+  struct Pending {
+    bool done = false;
+    bool ok = false;
+    ModbusFrame response;
+  };
+
+  struct Endpoint {
+    std::string ip;
+    std::uint16_t port = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int fd = -1;
+    bool connecting = false;  // one caller is reconnecting outside the mutex
+    std::uint64_t connect_attempt = 0;
+    std::string connect_error;  // of the last failed reconnect
+    int max_in_flight = 4;
+    int in_flight = 0;
+    std::uint16_t next_txid = 1;
+    std::unordered_map<std::uint16_t, Pending*> pending;
+    std::atomic<bool> running{false};
+    std::thread reader;
+  };
+
+  static constexpr int kReaderPollMs = 100;
+
+  ModbusTcpPipeline() = default;
+
+  std::shared_ptr<Endpoint> endpointFor(const std::string& ip, std::uint16_t port) {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    const auto it = endpoints_.find(ModbusTcpConnectionPool::endpointKey(ip, port));
+    return it == endpoints_.end() ? nullptr : it->second;
+  }
+
+  static void stopEndpoint(const std::shared_ptr<Endpoint>& ep) {
+    ep->running.store(false);
+    ep->cv.notify_all();
+    if (ep->reader.joinable()) ep->reader.join();
+    std::lock_guard<std::mutex> lock(ep->mutex);
+    failAllLocked(ep.get());
+  }
+
+  static bool sendAll(int fd, const std::uint8_t* data, std::size_t len) {
+    std::size_t sent = 0;
+    while (sent < len) {
+      const ssize_t n = ::send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      sent += static_cast<std::size_t>(n);
+    }
+    return true;
+  }
+
+  // Reads exactly len bytes; gives up when the endpoint stops or the peer
+  // stays silent mid-frame for too long.
+  static bool recvExact(Endpoint* ep, int fd, std::uint8_t* out, std::size_t len, bool frame_started) {
+    std::size_t got = 0;
+    int idle_ms = 0;
+    while (got < len) {
+      if (!ep->running.load()) return false;
+      pollfd pfd{fd, POLLIN, 0};
+      const int pr = ::poll(&pfd, 1, kReaderPollMs);
+      if (pr < 0 && errno == EINTR) continue;
+      if (pr < 0) return false;
+      if (pr == 0) {
+        if (frame_started || got > 0) {
+          idle_ms += kReaderPollMs;
+          if (idle_ms >= 2000) return false;
+        }
+        continue;
+      }
+      const ssize_t n = ::recv(fd, out + got, len - got, MSG_DONTWAIT);
+      if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+      if (n <= 0) return false;
+      got += static_cast<std::size_t>(n);
+      idle_ms = 0;
+    }
+    return true;
+  }
+
+  static void failAllLocked(Endpoint* ep) {
+    for (auto& kv : ep->pending) {
+      kv.second->done = true;
+      kv.second->ok = false;
+    }
+    if (ep->fd >= 0) {
+      ModbusTcpConnectionPool::instance().discard(ep->fd);
+      ep->fd = -1;
+    }
+    ep->cv.notify_all();
+  }
+
+  static void readerLoop(const std::shared_ptr<Endpoint>& ep) {
+    while (ep->running.load()) {
+      int fd = -1;
+      {
+        std::unique_lock<std::mutex> lock(ep->mutex);
+        ep->cv.wait_for(lock, std::chrono::milliseconds(kReaderPollMs),
+                        [&] { return ep->fd >= 0 || !ep->running.load(); });
+        fd = ep->fd;
+      }
+      if (fd < 0) continue;
+
+      std::uint8_t header[7];
+      bool ok = recvExact(ep.get(), fd, header, sizeof(header), false);
+      ModbusFrame frame;
+      if (ok) {
+        const std::uint16_t length = static_cast<std::uint16_t>((header[4] << 8) | header[5]);
+        ok = length >= 2 && length <= 254;
+        if (ok) {
+          frame.assign(header, header + sizeof(header));
+          frame.resize(6 + length);
+          ok = recvExact(ep.get(), fd, frame.data() + sizeof(header), length - 1, true);
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(ep->mutex);
+      if (!ok) {
+        if (ep->running.load()) failAllLocked(ep.get());
+        continue;
+      }
+      const std::uint16_t txid = static_cast<std::uint16_t>((frame[0] << 8) | frame[1]);
+      const auto it = ep->pending.find(txid);
+      if (it == ep->pending.end()) continue;  // Late reply of a request that already timed out.
+      it->second->response = frame;
+      it->second->ok = true;
+      it->second->done = true;
+      ep->cv.notify_all();
+    }
+  }
+
+  std::mutex map_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<Endpoint>> endpoints_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
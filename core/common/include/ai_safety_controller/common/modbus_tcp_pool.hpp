@@ -0,0 +1,144 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Keep Modbus TCP connections open per gateway endpoint ("ip:port") so that
+// drivers sharing a gateway reuse one socket instead of reconnecting per request.
+// A connection is checked out exclusively by acquire() and handed back with
+// release() after a good exchange, or discard() after any I/O error.
+class ModbusTcpConnectionPool {
+ public:
+  static ModbusTcpConnectionPool& instance() {
+    static ModbusTcpConnectionPool pool;
+    return pool;
+  }
+
+  ~ModbusTcpConnectionPool() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& kv : idle_by_endpoint_) {
+      for (int fd : kv.second) ::close(fd);
+    }
+    idle_by_endpoint_.clear();
+  }
+
+  ModbusTcpConnectionPool(const ModbusTcpConnectionPool&) = delete;
+  ModbusTcpConnectionPool& operator=(const ModbusTcpConnectionPool&) = delete;
+
+  static std::string endpointKey(const std::string& ip, std::uint16_t port) {
+    return ip + ":" + std::to_string(port);
+  }
+
+  // Returns a connected socket, or -1 with *error set.
+  int acquire(const std::string& ip, std::uint16_t port, double timeout_sec, std::string* error) {
+    const std::string key = endpointKey(ip, port);
+    int fd = takeIdle(key);
+    while (fd >= 0) {
+      if (isReusable(fd)) {
+        applyTimeouts(fd, timeout_sec);
+        return fd;
+      }
+      ::close(fd);
+      fd = takeIdle(key);
+    }
+    return connectNew(ip, port, timeout_sec, error);
+  }
+
+  void release(const std::string& ip, std::uint16_t port, int fd) {
+    if (fd < 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& idle = idle_by_endpoint_[endpointKey(ip, port)];
+    if (idle.size() >= kMaxIdlePerEndpoint) {
+      ::close(fd);
+      return;
+    }
+    idle.push_back(fd);
+  }
+
+  void discard(int fd) {
+    if (fd >= 0) ::close(fd);
+  }
+
+ private:
+  static constexpr std::size_t kMaxIdlePerEndpoint = 2;
+
+  ModbusTcpConnectionPool() = default;
+
+  int takeIdle(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = idle_by_endpoint_.find(key);
+    if (it == idle_by_endpoint_.end() || it->second.empty()) return -1;
+    const int fd = it->second.back();
+    it->second.pop_back();
+    return fd;
+  }
+
+  // Peek without blocking: 0 means the peer closed its side, stray bytes are
+  // late replies from an earlier timed-out request and get drained.
+  static bool isReusable(int fd) {
+    std::uint8_t buf[256];
+    for (;;) {
+      const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_PEEK | MSG_DONTWAIT);
+      if (n == 0) return false;
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      if (::recv(fd, buf, static_cast<size_t>(n), MSG_DONTWAIT) <= 0) return false;
+    }
+  }
+
+  static void applyTimeouts(int fd, double timeout_sec) {
+    timeval tv{};
+    tv.tv_sec = static_cast<int>(timeout_sec);
+    tv.tv_usec = static_cast<int>((timeout_sec - tv.tv_sec) * 1000000.0);
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  }
+
+  static int connectNew(const std::string& ip,
+                        std::uint16_t port,
+                        double timeout_sec,
+                        std::string* error) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+      if (error) *error = std::string("socket 创建失败: ") + std::strerror(errno);
+      return -1;
+    }
+    applyTimeouts(fd, timeout_sec);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+      if (error) *error = "模块IP无效: " + ip;
+      ::close(fd);
+      return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      if (error) *error = std::string("连接失败: ") + std::strerror(errno);
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<int>> idle_by_endpoint_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "ai_safety_controller/common/modbus_frame.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ai_safety_controller {
+namespace common {
+
+enum class MbapReceiveStatus {
+  kOk,
+  kTimeout,    // deadline passed; a partial frame may still be in flight
+  kClosed,     // peer closed the connection
+  kBadHeader,  // protocol id / length out of range: stream is out of sync
+  kIoError,
+};
+
+inline const char* mbapReceiveStatusName(MbapReceiveStatus s) {
+  switch (s) {
+    case MbapReceiveStatus::kOk:
+      return "ok";
+    case MbapReceiveStatus::kTimeout:
+      return "timeout";
+    case MbapReceiveStatus::kClosed:
+      return "connection closed";
+    case MbapReceiveStatus::kBadHeader:
+      return "bad MBAP header";
+    case MbapReceiveStatus::kIoError:
+    default:
+      return "io error";
+  }
+}
+
+inline std::chrono::steady_clock::time_point deadlineAfter(double seconds) {
+  return std::chrono::steady_clock::now() +
+         std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+             std::chrono::duration<double>(seconds > 0.0 ? seconds : 0.0));
+}
+
+namespace detail {
+
+// Reads exactly len bytes before deadline, however the peer segments them.
+inline MbapReceiveStatus recvExactUntil(int fd,
+                                        std::uint8_t* out,
+                                        std::size_t len,
+                                        std::chrono::steady_clock::time_point deadline) {
+  std::size_t got = 0;
+  while (got < len) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               deadline - std::chrono::steady_clock::now())
+                               .count();
+    if (remaining <= 0) return MbapReceiveStatus::kTimeout;
+    pollfd pfd{fd, POLLIN, 0};
+    const int pr = ::poll(&pfd, 1, static_cast<int>(remaining));
+    if (pr < 0 && errno == EINTR) continue;
+    if (pr < 0) return MbapReceiveStatus::kIoError;
+    if (pr == 0) return MbapReceiveStatus::kTimeout;
+    const ssize_t n = ::recv(fd, out + got, len - got, MSG_DONTWAIT);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+    if (n < 0) return MbapReceiveStatus::kIoError;
+    if (n == 0) return MbapReceiveStatus::kClosed;
+    got += static_cast<std::size_t>(n);
+  }
+  return MbapReceiveStatus::kOk;
+}
+
+}  // namespace detail
+
+// Receives the MBAP response to transaction_id on a connected socket: reads
+// the 7-byte header, then exactly `length - 1` more bytes, so split segments
+// are reassembled and nothing of the next frame is consumed. Complete frames
+// carrying another transaction id (late replies to requests that already
+// timed out) are discarded and the wait goes on until the deadline.
+// `discarded`, when given, counts those stale frames.
+inline MbapReceiveStatus receiveMbapResponse(int fd,
+                                             std::uint16_t transaction_id,
+                                             std::chrono::steady_clock::time_point deadline,
+                                             ModbusFrame* out,
+                                             int* discarded = nullptr) {
+  out->clear();
+  while (true) {
+    std::uint8_t header[7];
+    MbapReceiveStatus st = detail::recvExactUntil(fd, header, sizeof(header), deadline);
+    if (st != MbapReceiveStatus::kOk) return st;
+    const std::uint16_t protocol = readBe16(header + 2);
+    const std::uint16_t length = readBe16(header + 4);
+    if (protocol != 0 || length < 2 || length > 254) return MbapReceiveStatus::kBadHeader;
+    out->assign(header, header + sizeof(header));
+    out->resize(6 + length);
+    st = detail::recvExactUntil(fd, out->data() + sizeof(header), length - 1, deadline);
+    if (st != MbapReceiveStatus::kOk) return st;
+    if (readBe16(header) == transaction_id) return MbapReceiveStatus::kOk;
+    if (discarded) ++*discarded;
+    out->clear();
+  }
+}
+
+}  // namespace common
+}  // namespace ai_safety_controller
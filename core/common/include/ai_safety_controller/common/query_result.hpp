@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ai_safety_controller/common/status.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// One decoded quantity of a query, e.g. {"voltage", 52.1, "V"}.
+struct QueryValue {
+  std::string name;
+  double value = 0.0;
+  std::string unit;
+};
+
+// Structured outcome of a driver query. Filling one never touches std::cout;
+// turning it into text is the job of formatQueryResult() (query_result_format.hpp).
+struct QueryResult {
+  Status status{false, ""};
+  std::string sensor;
+  std::string command;
+  // Raw register words for register reads, starting at start_address.
+  std::uint8_t function_code = 0;
+  std::uint16_t start_address = 0;
+  std::vector<std::uint16_t> registers;
+  // Decoded values, in driver order.
+  std::vector<QueryValue> values;
+  std::chrono::system_clock::time_point finished_at{};
+  std::chrono::microseconds elapsed{0};
+
+  void add(const std::string& name, double value, const std::string& unit = std::string()) {
+    values.push_back(QueryValue{name, value, unit});
+  }
+
+  const QueryValue* find(const std::string& name) const {
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (values[i].name == name) return &values[i];
+    }
+    return nullptr;
+  }
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ai_safety_controller/common/query_result.hpp"
+#include "ai_safety_controller/common/sensor_snapshot.hpp"
+
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Presentation for QueryResult: a header line followed by one line per value
+// and per register. Only interactive / snapshot output should call this.
+inline std::string formatQueryResult(const QueryResult& result) {
+  std::ostringstream oss;
+  const std::time_t t = std::chrono::system_clock::to_time_t(result.finished_at);
+  std::tm tm_buf{};
+  localtime_r(&t, &tm_buf);
+  oss << "[" << result.sensor << "] " << result.command
+      << " ok=" << (result.status.ok ? "true" : "false")
+      << " time=" << std::put_time(&tm_buf, "%T")
+      << " elapsed_ms=" << std::fixed << std::setprecision(1)
+      << static_cast<double>(result.elapsed.count()) / 1000.0 << "\n";
+  oss.unsetf(std::ios::floatfield);
+  oss << std::setprecision(6);
+  if (!result.status.ok && !result.status.message.empty()) {
+    oss << "  " << result.status.message << "\n";
+  }
+  for (size_t i = 0; i < result.values.size(); ++i) {
+    const QueryValue& v = result.values[i];
+    oss << "  " << v.name << "=" << v.value;
+    if (!v.unit.empty()) oss << " " << v.unit;
+    oss << "\n";
+  }
+  for (size_t i = 0; i < result.registers.size(); ++i) {
+    const unsigned reg = static_cast<unsigned>(result.start_address + i);
+    const unsigned word = result.registers[i];
+    oss << "  0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << reg
+        << std::dec << " = " << word << " (0x" << std::hex << std::uppercase << std::setw(4)
+        << std::setfill('0') << word << std::dec << ")\n";
+    oss << std::setfill(' ');
+  }
+  return oss.str();
+}
+
+// One line per SensorRecord for the periodic snapshot reporter; empty for
+// slots that have never been queried.
+inline std::string formatSensorRecord(SensorSlot slot, const SensorRecord& rec) {
+  if (rec.status == SensorStatusCode::NoData) return std::string();
+  std::ostringstream oss;
+  const std::time_t t = static_cast<std::time_t>(rec.finished_at_ms / 1000);
+  std::tm tm_buf{};
+  localtime_r(&t, &tm_buf);
+  oss << "[" << sensorSlotName(slot) << "] " << rec.command
+      << " ok=" << (rec.status == SensorStatusCode::Ok ? "true" : "false")
+      << " time=" << std::put_time(&tm_buf, "%T")
+      << " elapsed_ms=" << std::fixed << std::setprecision(1)
+      << static_cast<double>(rec.latency_us) / 1000.0;
+  oss.unsetf(std::ios::floatfield);
+  oss << std::setprecision(6);
+  if (rec.value_count > 0 || rec.register_count > 0) {
+    oss << " " << (rec.value_name[0] != '\0' ? rec.value_name : "reg0") << "=" << rec.value
+        << " values=" << rec.value_count << " registers=" << rec.register_count;
+  }
+  oss << " updates=" << rec.updates;
+  if (rec.status == SensorStatusCode::Failed) {
+    oss << " failures=" << rec.consecutive_failures;
+    if (rec.message[0] != '\0') oss << " (" << rec.message << ")";
+  }
+  oss << "\n";
+  return oss.str();
+}
+
+}  // namespace common
+}  // namespace ai_safety_controller
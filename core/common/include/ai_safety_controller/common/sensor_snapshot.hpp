@@ -0,0 +1,160 @@
+#pragma once
+
+#include "ai_safety_controller/common/query_result.hpp"
+#include "ai_safety_controller/common/seqlock_snapshot.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Fixed slot per queryable sensor, so pollers index the snapshot table
+// directly instead of hashing a sensor name into a map.
+enum class SensorSlot : std::uint8_t {
+  Battery = 0,
+  Solar,
+  HoistHook,
+  IoRelay,
+  MultiTurnEncoder,
+  SpdLidar,
+  Device,
+};
+
+constexpr std::size_t kSensorSlotCount = 7;
+
+inline const char* sensorSlotName(SensorSlot slot) {
+  switch (slot) {
+    case SensorSlot::Battery:
+      return "battery";
+    case SensorSlot::Solar:
+      return "solar";
+    case SensorSlot::HoistHook:
+      return "hoist_hook";
+    case SensorSlot::IoRelay:
+      return "io_relay";
+    case SensorSlot::MultiTurnEncoder:
+      return "multi_turn_encoder";
+    case SensorSlot::SpdLidar:
+      return "spd_lidar";
+    case SensorSlot::Device:
+    default:
+      return "device";
+  }
+}
+
+// Slot of a sensor name; false for names without one. Compares in place, no
+// allocation.
+inline bool sensorSlotFor(const std::string& sensor, SensorSlot* out) {
+  for (std::size_t i = 0; i < kSensorSlotCount; ++i) {
+    const SensorSlot slot = static_cast<SensorSlot>(i);
+    if (sensor == sensorSlotName(slot)) {
+      *out = slot;
+      return true;
+    }
+  }
+  return false;
+}
+
+enum class SensorStatusCode : std::uint8_t {
+  NoData = 0,  // never queried
+  Ok,
+  Failed,
+};
+
+// Latest query outcome of one sensor. Trivially copyable, so it lives in a
+// SeqlockSnapshot; text fields are truncated copies, always NUL-terminated.
+struct SensorRecord {
+  SensorStatusCode status = SensorStatusCode::NoData;
+  std::uint8_t function_code = 0;
+  std::uint16_t value_count = 0;
+  std::uint16_t register_count = 0;
+  std::uint32_t consecutive_failures = 0;
+  std::uint32_t latency_us = 0;
+  std::uint64_t updates = 0;
+  std::int64_t finished_at_ms = 0;  // system clock, ms since epoch
+  double value = 0.0;               // first decoded value, else first register
+  char value_name[24] = {};
+  char command[24] = {};
+  char message[48] = {};  // status message of the last failure
+};
+
+// One seqlock slot per SensorSlot. record() is called from the polling
+// threads and only copies fixed-size fields; load() never blocks them.
+class SensorSnapshotTable {
+ public:
+  void record(SensorSlot slot, const QueryResult& result) {
+    slots_[static_cast<std::size_t>(slot)].update([&](SensorRecord* rec) {
+      rec->status = result.status.ok ? SensorStatusCode::Ok : SensorStatusCode::Failed;
+      rec->consecutive_failures = result.status.ok ? 0 : rec->consecutive_failures + 1;
+      rec->function_code = result.function_code;
+      rec->value_count = static_cast<std::uint16_t>(result.values.size());
+      rec->register_count = static_cast<std::uint16_t>(result.registers.size());
+      rec->latency_us = static_cast<std::uint32_t>(result.elapsed.count());
+      ++rec->updates;
+      rec->finished_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                result.finished_at.time_since_epoch())
+                                .count();
+      if (!result.values.empty()) {
+        rec->value = result.values[0].value;
+        copyText(rec->value_name, result.values[0].name);
+      } else if (!result.registers.empty()) {
+        rec->value = result.registers[0];
+        copyText(rec->value_name, std::string());
+      }
+      copyText(rec->command, result.command);
+      if (!result.status.ok) copyText(rec->message, result.status.message);
+    });
+  }
+
+  // Outcome of one background poll (update*FromDriver). All text arguments
+  // are string literals, so the polling lanes never allocate here.
+  void recordPoll(SensorSlot slot, bool ok, const char* command, const char* value_name,
+                  double value, std::chrono::microseconds elapsed, const char* message = nullptr) {
+    const std::int64_t finished_at_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                            std::chrono::system_clock::now().time_since_epoch())
+                                            .count();
+    slots_[static_cast<std::size_t>(slot)].update([&](SensorRecord* rec) {
+      rec->status = ok ? SensorStatusCode::Ok : SensorStatusCode::Failed;
+      rec->consecutive_failures = ok ? 0 : rec->consecutive_failures + 1;
+      rec->function_code = 0;
+      rec->value_count = ok ? 1 : 0;
+      rec->register_count = 0;
+      rec->latency_us = static_cast<std::uint32_t>(elapsed.count());
+      ++rec->updates;
+      rec->finished_at_ms = finished_at_ms;
+      if (ok) {
+        rec->value = value;
+        copyText(rec->value_name, value_name);
+      }
+      copyText(rec->command, command);
+      if (!ok) copyText(rec->message, message != nullptr ? message : "");
+    });
+  }
+
+  SensorRecord load(SensorSlot slot) const { return slots_[static_cast<std::size_t>(slot)].load(); }
+
+ private:
+  template <std::size_t N>
+  static void copyText(char (&dst)[N], const std::string& src) {
+    const std::size_t n = src.size() < N - 1 ? src.size() : N - 1;
+    std::memcpy(dst, src.data(), n);
+    std::memset(dst + n, 0, N - n);
+  }
+
+  template <std::size_t N>
+  static void copyText(char (&dst)[N], const char* src) {
+    std::size_t n = 0;
+    while (n < N - 1 && src[n] != '\0') ++n;
+    std::memcpy(dst, src, n);
+    std::memset(dst + n, 0, N - n);
+  }
+
+  SeqlockSnapshot<SensorRecord> slots_[kSensorSlotCount];
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Default change test of SeqlockSnapshot. Compares the object representation,
+// padding and float bit patterns included; payloads with padding or float
+// fields should pass a field-wise comparator instead.
+template <typename T>
+struct BytewiseEqual {
+  bool operator()(const T& lhs, const T& rhs) const { return std::memcmp(&lhs, &rhs, sizeof(T)) == 0; }
+};
+
+// Seqlock-protected copy of a small trivially copyable aggregate. Readers
+// never block: they copy the payload and retry only if a write overlapped.
+// Writers are serialized by an internal mutex, so update() is an atomic
+// read-modify-write and concurrent writers cannot lose each other's fields.
+// The payload is kept in atomic words so the racing copy is well defined.
+// Equal decides whether store()/update() actually changed anything.
+template <typename T, typename Equal = BytewiseEqual<T>>
+class SeqlockSnapshot {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqlockSnapshot requires a trivially copyable type");
+
+ public:
+  explicit SeqlockSnapshot(const T& initial = T()) { writeWords(initial); }
+
+  SeqlockSnapshot(const SeqlockSnapshot&) = delete;
+  SeqlockSnapshot& operator=(const SeqlockSnapshot&) = delete;
+
+  T load() const {
+    T out;
+    for (;;) {
+      const std::uint64_t begin = seq_.load(std::memory_order_acquire);
+      if (begin & 1) continue;
+      readWords(&out);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == begin) return out;
+    }
+  }
+
+  // Returns false (and skips the write) when value equals the current one.
+  bool store(const T& value) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    T current;
+    readWords(&current);
+    if (Equal()(current, value)) return false;
+    publishLocked(value);
+    return true;
+  }
+
+  // Apply fn(T*) to the current value and publish the result atomically with
+  // respect to other writers. Returns whether anything changed.
+  template <typename Fn>
+  bool update(Fn&& fn) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    T current;
+    readWords(&current);
+    T value = current;
+    fn(&value);
+    if (Equal()(current, value)) return false;
+    publishLocked(value);
+    return true;
+  }
+
+  // Number of completed writes.
+  std::uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+ private:
+  static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+  void publishLocked(const T& value) {
+    const std::uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    writeWords(value);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  void writeWords(const T& value) {
+    std::uint64_t buf[kWords] = {};
+    std::memcpy(buf, &value, sizeof(T));
+    for (std::size_t i = 0; i < kWords; ++i) words_[i].store(buf[i], std::memory_order_relaxed);
+  }
+
+  void readWords(T* out) const {
+    std::uint64_t buf[kWords];
+    for (std::size_t i = 0; i < kWords; ++i) buf[i] = words_[i].load(std::memory_order_relaxed);
+    std::memcpy(out, buf, sizeof(T));
+  }
+
+  std::atomic<std::uint64_t> seq_{0};
+  std::atomic<std::uint64_t> words_[kWords];
+  std::mutex writer_mutex_;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
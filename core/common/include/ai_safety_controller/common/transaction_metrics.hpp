@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Percentiles of one latency histogram, in microseconds.
+struct LatencySummary {
+  std::uint64_t count = 0;
+  std::uint64_t min_us = 0;
+  std::uint64_t max_us = 0;
+  double mean_us = 0.0;
+  std::uint64_t p50_us = 0;
+  std::uint64_t p90_us = 0;
+  std::uint64_t p99_us = 0;
+  std::uint64_t p999_us = 0;
+};
+
+// HDR-style histogram over microseconds: every power of two is split into 16
+// linear sub-buckets, so a reported percentile is within 1/16 of the recorded
+// value from 1 us up to ~9 hours, in a fixed array. record() is a handful of
+// relaxed atomic adds and never allocates or locks.
+class LatencyHistogram {
+ public:
+  LatencyHistogram() {
+    for (std::size_t i = 0; i < kBuckets; ++i) counts_[i].store(0, std::memory_order_relaxed);
+  }
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void record(std::uint64_t us) {
+    counts_[indexOf(us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(us, std::memory_order_relaxed);
+    std::uint64_t seen = min_.load(std::memory_order_relaxed);
+    while (us < seen && !min_.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+    seen = max_.load(std::memory_order_relaxed);
+    while (us > seen && !max_.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+  }
+
+  void record(std::chrono::steady_clock::duration d) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    record(static_cast<std::uint64_t>(us < 0 ? 0 : us));
+  }
+
+  // Concurrent record() calls may land between the bucket reads; the summary
+  // is then off by those in-flight samples, which is fine for monitoring.
+  LatencySummary summary() const {
+    LatencySummary s;
+    std::uint64_t counts[kBuckets];
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      counts[i] = counts_[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+    if (total == 0) return s;
+    s.count = total;
+    s.min_us = min_.load(std::memory_order_relaxed);
+    s.max_us = max_.load(std::memory_order_relaxed);
+    s.mean_us = static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+                static_cast<double>(count_.load(std::memory_order_relaxed));
+    s.p50_us = percentile(counts, total, 0.50, s.max_us);
+    s.p90_us = percentile(counts, total, 0.90, s.max_us);
+    s.p99_us = percentile(counts, total, 0.99, s.max_us);
+    s.p999_us = percentile(counts, total, 0.999, s.max_us);
+    return s;
+  }
+
+ private:
+  static constexpr int kSubBits = 4;
+  static constexpr std::uint64_t kSub = 1u << kSubBits;
+  static constexpr int kMaxMsb = 34;
+  static constexpr std::size_t kBuckets = kSub + (kMaxMsb - kSubBits + 1) * kSub;
+
+  static int msbOf(std::uint64_t v) {
+    int msb = 0;
+    while (v >>= 1) ++msb;
+    return msb;
+  }
+
+  static std::size_t indexOf(std::uint64_t v) {
+    if (v < kSub) return static_cast<std::size_t>(v);
+    int msb = msbOf(v);
+    if (msb > kMaxMsb) return kBuckets - 1;
+    const int shift = msb - kSubBits;
+    const std::uint64_t sub = (v >> shift) & (kSub - 1);
+    return static_cast<std::size_t>(kSub + static_cast<std::uint64_t>(shift) * kSub + sub);
+  }
+
+  // Highest value that maps to bucket index.
+  static std::uint64_t upperBound(std::size_t index) {
+    if (index < kSub) return index;
+    const std::size_t rel = index - kSub;
+    const int shift = static_cast<int>(rel / kSub);
+    const std::uint64_t sub = rel % kSub;
+    return (((kSub + sub) + 1) << shift) - 1;
+  }
+
+  static std::uint64_t percentile(const std::uint64_t* counts,
+                                  std::uint64_t total,
+                                  double q,
+                                  std::uint64_t max_us) {
+    const std::uint64_t rank =
+        std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * static_cast<double>(total) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) return std::min(upperBound(i), max_us);
+    }
+    return max_us;
+  }
+
+  std::atomic<std::uint64_t> counts_[kBuckets];
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> sum_{0};
+  std::atomic<std::uint64_t> min_{~static_cast<std::uint64_t>(0)};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+// Live counters for one (endpoint, function code) pair. Instances are owned by
+// TransactionMetrics and never move, so drivers may keep the reference.
+struct TransactionSeries {
+  std::string endpoint;
+  std::uint8_t function_code = 0;
+  std::atomic<std::uint64_t> requests{0};
+  std::atomic<std::uint64_t> failures{0};
+  std::atomic<std::uint64_t> retries{0};
+  std::atomic<std::uint64_t> timeouts{0};
+  std::atomic<std::uint64_t> bytes_out{0};
+  std::atomic<std::uint64_t> bytes_in{0};
+  // Waiting for the bus: gateway FIFO plus the inter-frame gap.
+  LatencyHistogram queue_wait;
+  // Opening (or checking a pooled) connection / serial port.
+  LatencyHistogram connect;
+  // Request written to reply received, successful attempts only.
+  LatencyHistogram round_trip;
+  // Whole call as seen by the driver, retries and backoff included.
+  LatencyHistogram total;
+};
+
+// Plain copy of a TransactionSeries for reporting.
+struct TransactionSeriesSnapshot {
+  std::string endpoint;
+  std::uint8_t function_code = 0;
+  std::uint64_t requests = 0;
+  std::uint64_t failures = 0;
+  std::uint64_t retries = 0;
+  std::uint64_t timeouts = 0;
+  std::uint64_t bytes_out = 0;
+  std::uint64_t bytes_in = 0;
+  LatencySummary queue_wait;
+  LatencySummary connect;
+  LatencySummary round_trip;
+  LatencySummary total;
+};
+
+// Process-wide registry of transaction series keyed by endpoint and function
+// code. Lookups of existing series take a shared lock only; the counters
+// themselves are atomics.
+class TransactionMetrics {
+ public:
+  static TransactionMetrics& instance() {
+    static TransactionMetrics metrics;
+    return metrics;
+  }
+
+  TransactionMetrics(const TransactionMetrics&) = delete;
+  TransactionMetrics& operator=(const TransactionMetrics&) = delete;
+
+  TransactionSeries& series(const std::string& endpoint, std::uint8_t function_code) {
+    const Key key(endpoint, function_code);
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      const auto it = series_.find(key);
+      if (it != series_.end()) return *it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::unique_ptr<TransactionSeries>& slot = series_[key];
+    if (!slot) {
+      slot.reset(new TransactionSeries());
+      slot->endpoint = endpoint;
+      slot->function_code = function_code;
+    }
+    return *slot;
+  }
+
+  // Sorted by endpoint, then function code.
+  std::vector<TransactionSeriesSnapshot> snapshot() const {
+    std::vector<TransactionSeriesSnapshot> out;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    out.reserve(series_.size());
+    for (const auto& kv : series_) {
+      const TransactionSeries& s = *kv.second;
+      TransactionSeriesSnapshot snap;
+      snap.endpoint = s.endpoint;
+      snap.function_code = s.function_code;
+      snap.requests = s.requests.load(std::memory_order_relaxed);
+      snap.failures = s.failures.load(std::memory_order_relaxed);
+      snap.retries = s.retries.load(std::memory_order_relaxed);
+      snap.timeouts = s.timeouts.load(std::memory_order_relaxed);
+      snap.bytes_out = s.bytes_out.load(std::memory_order_relaxed);
+      snap.bytes_in = s.bytes_in.load(std::memory_order_relaxed);
+      snap.queue_wait = s.queue_wait.summary();
+      snap.connect = s.connect.summary();
+      snap.round_trip = s.round_trip.summary();
+      snap.total = s.total.summary();
+      out.push_back(std::move(snap));
+    }
+    return out;
+  }
+
+ private:
+  using Key = std::pair<std::string, std::uint8_t>;
+
+  TransactionMetrics() = default;
+
+  mutable std::shared_mutex mutex_;
+  std::map<Key, std::unique_ptr<TransactionSeries>> series_;
+};
+
+// Timing of one driver call. Construct it before waiting for the bus and mark
+// the phases as they happen; the destructor books the call as failed unless
+// finish(true) was reached first.
+class TransactionProbe {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TransactionProbe(const std::string& endpoint, std::uint8_t function_code)
+      : series_(TransactionMetrics::instance().series(endpoint, function_code)),
+        start_(Clock::now()),
+        phase_start_(start_) {}
+
+  ~TransactionProbe() {
+    if (!finished_) finish(false);
+  }
+
+  TransactionProbe(const TransactionProbe&) = delete;
+  TransactionProbe& operator=(const TransactionProbe&) = delete;
+
+  // The bus is ours: everything since construction was queueing.
+  void acquired() { series_.queue_wait.record(Clock::now() - start_); }
+
+  void beginConnect() { phase_start_ = Clock::now(); }
+  void endConnect() { series_.connect.record(Clock::now() - phase_start_); }
+
+  void beginExchange() { phase_start_ = Clock::now(); }
+  void endExchange(std::size_t bytes_out, std::size_t bytes_in) {
+    series_.round_trip.record(Clock::now() - phase_start_);
+    series_.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+    series_.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+  }
+
+  // Bytes of a failed attempt still went on the wire.
+  void sent(std::size_t bytes_out) { series_.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed); }
+
+  void retry() { series_.retries.fetch_add(1, std::memory_order_relaxed); }
+  void timeout() { series_.timeouts.fetch_add(1, std::memory_order_relaxed); }
+
+  void finish(bool ok) {
+    if (finished_) return;
+    finished_ = true;
+    series_.total.record(Clock::now() - start_);
+    series_.requests.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) series_.failures.fetch_add(1, std::memory_order_relaxed);
+  }
+
+ private:
+  TransactionSeries& series_;
+  Clock::time_point start_;
+  Clock::time_point phase_start_;
+  bool finished_ = false;
+};
+
+}  // namespace common
+}  // namespace ai_safety_controller
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ai_safety_controller/common/gateway_serial.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ai_safety_controller {
+namespace common {
+
+// Text table for TransactionMetrics::snapshot(): one block per endpoint and
+// function code, latencies in milliseconds.
+inline std::string formatTransactionMetrics(const std::vector<TransactionSeriesSnapshot>& series) {
+  std::ostringstream oss;
+  if (series.empty()) {
+    oss << "[metrics] no transactions recorded yet\n";
+    return oss.str();
+  }
+  const auto ms = [](std::uint64_t us) { return static_cast<double>(us) / 1000.0; };
+  const auto line = [&](const char* name, const LatencySummary& s) {
+    if (s.count == 0) return;
+    oss << "    " << std::left << std::setw(10) << name << std::right
+        << " n=" << s.count << std::fixed << std::setprecision(2)
+        << " min=" << ms(s.min_us) << " p50=" << ms(s.p50_us) << " p90=" << ms(s.p90_us)
+        << " p99=" << ms(s.p99_us) << " p99.9=" << ms(s.p999_us) << " max=" << ms(s.max_us)
+        << " mean=" << s.mean_us / 1000.0 << "\n";
+  };
+  for (size_t i = 0; i < series.size(); ++i) {
+    const TransactionSeriesSnapshot& s = series[i];
+    oss << "[metrics] " << s.endpoint << " fc=0x" << std::hex << std::uppercase << std::setw(2)
+        << std::setfill('0') << static_cast<unsigned>(s.function_code) << std::dec
+        << std::setfill(' ') << " requests=" << s.requests << " failures=" << s.failures
+        << " retries=" << s.retries << " timeouts=" << s.timeouts << " bytes_out=" << s.bytes_out
+        << " bytes_in=" << s.bytes_in << "\n";
+    line("queue", s.queue_wait);
+    line("connect", s.connect);
+    line("rtt", s.round_trip);
+    line("total", s.total);
+  }
+  return oss.str();
+}
+
+// Text table for GatewayScheduler::snapshot(): one line per bus and priority.
+inline std::string formatBusQueueMetrics(const std::vector<BusQueueSnapshot>& queues) {
+  std::ostringstream oss;
+  if (queues.empty()) {
+    oss << "[bus_queue] no serialized bus traffic yet\n";
+    return oss.str();
+  }
+  const auto ms = [](std::uint64_t us) { return static_cast<double>(us) / 1000.0; };
+  for (size_t i = 0; i < queues.size(); ++i) {
+    const BusQueueSnapshot& q = queues[i];
+    oss << "[bus_queue] " << q.endpoint << " " << std::left << std::setw(10) << busPriorityName(q.priority)
+        << std::right << " granted=" << q.granted << " waiting=" << q.waiting;
+    if (q.priority == BusPriority::Background) oss << " shed=" << q.shed;
+    if (q.queue_wait.count > 0) {
+      oss << std::fixed << std::setprecision(2) << " wait p50=" << ms(q.queue_wait.p50_us)
+          << " p99=" << ms(q.queue_wait.p99_us) << " max=" << ms(q.queue_wait.max_us) << " ms";
+    }
+    oss << "\n";
+  }
+  return oss.str();
+}
+
+}  // namespace common
+}  // namespace ai_safety_controller
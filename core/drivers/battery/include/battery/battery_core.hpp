@@ -1,5 +1,9 @@
 #pragma once
 
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+
+#include <atomic>
 #include <cstdint>
 #include <mutex>
 #include <string>
@@ -45,6 +49,15 @@ class BatteryCore {
   void scanBatterySlaveIds(int start_id, int end_id);
   void setBatteryAddr(int new_addr);
   void genericRead(uint16_t address, uint16_t quantity, int function_code);
+  /**
+   * 读取连续寄存器并返回原始值，不打印；function_code<0 时使用默认功能码。
+   * 参数非法时 error 给出原因；通信失败时 error 为空（驱动已记录日志）。
+   */
+  bool readRegisterValues(uint16_t address,
+                          uint16_t quantity,
+                          int function_code,
+                          std::vector<uint16_t>* values,
+                          std::string* error = nullptr);
   void genericWrite(uint16_t address, uint16_t value, int function_code);
 
   static bool parseNumber(const std::string& text, int* out);
@@ -55,8 +68,13 @@ class BatteryCore {
   bool isOnline(double timeout_sec = 1.0);
   bool readSummary(Summary* out, double timeout_sec = 5.0);
   void setChargeTimeDebugEnabled(bool enabled);
+  /** 合并读取时允许的寄存器空洞数，0 表示只合并相邻区间 */
+  void setReadGapTolerance(int registers);
+  /** 运行中替换重试策略，下一次请求生效 */
+  void setRetryPolicy(const RetryPolicy& retry_policy);
 
  private:
+  RetryPolicy retryPolicy() const;
   struct RegisterGroup {
     uint16_t start;
     uint16_t end;
@@ -64,31 +82,42 @@ class BatteryCore {
     std::string desc;
   };
 
-  std::vector<uint8_t> createModbusPacket(uint8_t function_code,
-                                          uint16_t address,
-                                          uint16_t value,
-                                          uint16_t quantity,
-                                          uint8_t unit_id,
-                                          bool* ok);
-  bool sendModbusPacket(const std::vector<uint8_t>& packet,
-                        std::vector<uint8_t>* response,
-                        const std::string& context,
+  ai_safety_controller::common::ModbusFrame createModbusPacket(uint8_t function_code,
+                                                               uint16_t address,
+                                                               uint16_t value,
+                                                               uint16_t quantity,
+                                                               uint8_t unit_id,
+                                                               bool* ok);
+  bool sendModbusPacket(const ai_safety_controller::common::ModbusFrame& packet,
+                        ai_safety_controller::common::ModbusFrame* response,
+                        const ai_safety_controller::common::LazyContext& context,
                         double timeout_sec = 5.0);
   bool sendBatteryRead(uint8_t function_code,
                        uint16_t address,
                        uint16_t quantity,
                        uint8_t unit_id,
-                       std::vector<uint8_t>* response,
+                       ai_safety_controller::common::ModbusFrame* response,
                        double timeout_sec = 5.0);
-  bool parseRegisterResponse(const std::vector<uint8_t>& response,
+  bool readRegisters(uint8_t function_code,
+                     uint16_t address,
+                     uint16_t quantity,
+                     uint8_t unit_id,
+                     std::vector<uint16_t>* values,
+                     double timeout_sec,
+                     uint8_t* exception_code = nullptr);
+  bool parseRegisterResponse(const ai_safety_controller::common::ModbusFrame& response,
                              uint8_t function_code,
                              uint16_t quantity,
-                             std::vector<uint16_t>* values) const;
+                             std::vector<uint16_t>* values,
+                             uint8_t* exception_code = nullptr) const;
   bool ensureConnectionLocked(double timeout_sec);
+  void releaseConnectionLocked();
   void disconnectLocked();
-  bool sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                            std::vector<uint8_t>* response,
-                            const std::string& context);
+  bool sendAndReceiveLocked(const ai_safety_controller::common::ModbusFrame& packet,
+                            ai_safety_controller::common::ModbusFrame* response,
+                            const ai_safety_controller::common::LazyContext& context,
+                            double timeout_sec,
+                            ai_safety_controller::common::TransactionProbe* probe);
   bool confirmRiskyWrite(uint16_t addr) const;
   std::string describeBatteryRegister(uint16_t addr) const;
   int16_t toSigned16(uint16_t value) const;
@@ -100,7 +129,9 @@ class BatteryCore {
   uint16_t transaction_id_;
   int socket_fd_;
   RetryPolicy retry_policy_;
+  mutable std::mutex retry_policy_mutex_;
   bool charge_time_debug_enabled_ = false;
+  std::atomic<uint16_t> read_gap_tolerance_{4};
   std::mutex socket_mutex_;
   std::vector<RegisterGroup> register_groups_;
 };
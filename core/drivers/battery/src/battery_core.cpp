@@ -1,5 +1,10 @@
 #include "battery/battery_core.hpp"
 #include "ai_safety_controller/common/gateway_serial.hpp"
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/modbus_read_plan.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pipeline.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pool.hpp"
+#include "ai_safety_controller/common/modbus_tcp_receiver.hpp"
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -13,6 +18,7 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <random>
 #include <sstream>
 #include <thread>
@@ -21,9 +27,10 @@ namespace battery {
 
 namespace {
 
-uint16_t readBe16(const uint8_t* p) {
-  return static_cast<uint16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
-}
+using ai_safety_controller::common::LazyContext;
+using ai_safety_controller::common::LogLevel;
+using ai_safety_controller::common::LogLine;
+using ai_safety_controller::common::ModbusFrame;
 
 std::uint32_t estimateChargeRemainingMinutes(double q_rem_ah,
                                              double q_full_ah,
@@ -106,7 +113,7 @@ BatteryCore::BatteryCore(const std::string& module_ip,
 
 BatteryCore::~BatteryCore() {
   std::lock_guard<std::mutex> lock(socket_mutex_);
-  disconnectLocked();
+  releaseConnectionLocked();
 }
 
 bool BatteryCore::parseNumber(const std::string& text, int* out) {
@@ -140,7 +147,7 @@ bool BatteryCore::parseFunctionCode(const std::string& text,
 }
 
 bool BatteryCore::isOnline(double timeout_sec) {
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendBatteryRead(0x03, 0x0002, 1, battery_slave_id_, &response, timeout_sec)) {
     return false;
   }
@@ -159,25 +166,26 @@ bool BatteryCore::readSummary(Summary* out, double timeout_sec) {
     return false;
   }
 
-  std::vector<uint8_t> response;
-  if (!sendBatteryRead(0x03, 0x0000, 9, battery_slave_id_, &response, timeout_sec)) {
-    return false;
-  }
+  // 0x0000~0x0008 summary, 0x000A charge MOS and (debug) 0x0009 charge mode
+  // are planned together so they normally go out as a single PDU.
+  using ai_safety_controller::common::ModbusReadPlan;
+  ModbusReadPlan plan(read_gap_tolerance_);
+  plan.add(battery_slave_id_, 0x03, 0x0000, 9);
+  plan.add(battery_slave_id_, 0x03, 0x000A, 1);
+  if (charge_time_debug_enabled_) plan.add(battery_slave_id_, 0x03, 0x0009, 1);
+  plan.execute([&](const ModbusReadPlan::Block& b, std::vector<uint16_t>* block_values) {
+    uint8_t exception_code = 0;
+    const bool ok = readRegisters(b.function_code, b.address, b.quantity, b.unit_id, block_values,
+                                  timeout_sec, &exception_code);
+    return ModbusReadPlan::readStatus(ok, exception_code);
+  });
+
   std::vector<uint16_t> values;
-  if (!parseRegisterResponse(response, 0x03, 9, &values) || values.size() < 9) {
+  if (!plan.values(battery_slave_id_, 0x03, 0x0000, 9, &values)) {
     return false;
   }
-
-  std::vector<uint8_t> charge_mos_resp;
-  bool has_charge_mos = false;
   uint16_t charge_mos = 0;
-  if (sendBatteryRead(0x03, 0x000A, 1, battery_slave_id_, &charge_mos_resp, timeout_sec)) {
-    std::vector<uint16_t> mos_values;
-    if (parseRegisterResponse(charge_mos_resp, 0x03, 1, &mos_values) && !mos_values.empty()) {
-      has_charge_mos = true;
-      charge_mos = mos_values[0];
-    }
-  }
+  const bool has_charge_mos = plan.value(battery_slave_id_, 0x03, 0x000A, &charge_mos);
 
   Summary s;
   s.soc_percent = static_cast<float>(values[0] * 0.01);
@@ -209,29 +217,20 @@ bool BatteryCore::readSummary(Summary* out, double timeout_sec) {
     }
   }
   if (charge_time_debug_enabled_) {
-    bool has_charge_mode = false;
     std::uint16_t charge_mode = 0u;
-    std::vector<uint8_t> charge_mode_resp;
-    if (sendBatteryRead(0x03, 0x0009, 1, battery_slave_id_, &charge_mode_resp, timeout_sec)) {
-      std::vector<uint16_t> charge_mode_values;
-      if (parseRegisterResponse(charge_mode_resp, 0x03, 1, &charge_mode_values) &&
-          !charge_mode_values.empty()) {
-        has_charge_mode = true;
-        charge_mode = charge_mode_values[0];
-      }
-    }
-    std::cout << "[battery] [charge_time_debug] raw=" << charge_time_raw
-              << " valid_raw=" << (has_valid_charge_time_raw ? "true" : "false")
-              << " estimate=" << estimate_charge_min
-              << " selected=" << s.remaining_charge_min
-              << " source=" << charge_time_source
-              << " currentA=" << s.current_a
-              << " soc=" << s.soc_percent
-              << " q_rem_ah=" << q_rem_ah
-              << " q_full_ah=" << q_full_ah
-              << " reg0009=" << (has_charge_mode ? std::to_string(charge_mode) : "n/a")
-              << " charge_mos=" << (has_charge_mos ? std::to_string(charge_mos) : "n/a")
-              << "\n";
+    const bool has_charge_mode = plan.value(battery_slave_id_, 0x03, 0x0009, &charge_mode);
+    LogLine(LogLevel::Info, "battery")
+        << "[charge_time_debug] raw=" << charge_time_raw
+        << " valid_raw=" << (has_valid_charge_time_raw ? "true" : "false")
+        << " estimate=" << estimate_charge_min
+        << " selected=" << s.remaining_charge_min
+        << " source=" << charge_time_source
+        << " currentA=" << s.current_a
+        << " soc=" << s.soc_percent
+        << " q_rem_ah=" << q_rem_ah
+        << " q_full_ah=" << q_full_ah
+        << " reg0009=" << (has_charge_mode ? std::to_string(charge_mode) : "n/a")
+        << " charge_mos=" << (has_charge_mos ? std::to_string(charge_mos) : "n/a");
   }
   s.has_charge_mos = has_charge_mos;
   s.charge_mos = charge_mos;
@@ -244,75 +243,106 @@ void BatteryCore::setChargeTimeDebugEnabled(bool enabled) {
   charge_time_debug_enabled_ = enabled;
 }
 
-std::vector<uint8_t> BatteryCore::createModbusPacket(uint8_t function_code,
-                                                     uint16_t address,
-                                                     uint16_t value,
-                                                     uint16_t quantity,
-                                                     uint8_t unit_id,
-                                                     bool* ok) {
+void BatteryCore::setReadGapTolerance(int registers) {
+  read_gap_tolerance_ = static_cast<uint16_t>(std::min(std::max(registers, 0), 64));
+}
+
+ModbusFrame BatteryCore::createModbusPacket(uint8_t function_code,
+                                            uint16_t address,
+                                            uint16_t value,
+                                            uint16_t quantity,
+                                            uint8_t unit_id,
+                                            bool* ok) {
   if (ok) *ok = false;
   if (function_code == 0x03 || function_code == 0x04) {
     transaction_id_ = static_cast<uint16_t>((transaction_id_ + 1) & 0xFFFF);
   }
   if (!(function_code == 0x03 || function_code == 0x04 || function_code == 0x06)) {
-    std::cout << "[battery] ❌ 不支持的功能码\n";
+    LogLine(LogLevel::Error, "battery") << "❌ 不支持的功能码";
     return {};
   }
 
-  std::vector<uint8_t> pkt;
-  pkt.reserve(12);
-  const uint16_t protocol_id = 0x0000;
-  const uint16_t length = 6;
-  pkt.push_back(static_cast<uint8_t>((transaction_id_ >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(transaction_id_ & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((protocol_id >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(protocol_id & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((length >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(length & 0xFF));
-  pkt.push_back(unit_id);
-  pkt.push_back(function_code);
-  pkt.push_back(static_cast<uint8_t>((address >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(address & 0xFF));
+  ModbusFrame pkt;
   const uint16_t data = (function_code == 0x06) ? value : quantity;
-  pkt.push_back(static_cast<uint8_t>((data >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(data & 0xFF));
+  ai_safety_controller::common::encodeMbapRequest(
+      &pkt, transaction_id_, unit_id, function_code, address, data);
   if (ok) *ok = true;
   return pkt;
 }
 
-bool BatteryCore::sendModbusPacket(const std::vector<uint8_t>& packet,
-                                   std::vector<uint8_t>* response,
-                                   const std::string& context,
+void BatteryCore::setRetryPolicy(const RetryPolicy& retry_policy) {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  retry_policy_ = retry_policy;
+}
+
+BatteryCore::RetryPolicy BatteryCore::retryPolicy() const {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  return retry_policy_;
+}
+
+bool BatteryCore::sendModbusPacket(const ModbusFrame& packet,
+                                   ModbusFrame* response,
+                                   const LazyContext& context,
                                    double timeout_sec) {
   if (!response) return false;
   response->clear();
-  const std::string endpoint_key = module_ip_ + ":" + std::to_string(module_port_);
-  ai_safety_controller::common::GatewaySerialGuard serial_guard(endpoint_key, 120);
-  std::lock_guard<std::mutex> lock(socket_mutex_);
-  const int max_retries = std::max(0, retry_policy_.max_retries);
+  const std::string endpoint_key =
+      ai_safety_controller::common::ModbusTcpConnectionPool::endpointKey(module_ip_, module_port_);
+  // Pipelined gateways queue transactions themselves; everything else stays
+  // strictly serial behind the per-endpoint scheduler.
+  auto& pipeline = ai_safety_controller::common::ModbusTcpPipeline::instance();
+  const bool pipelined = pipeline.enabled(module_ip_, module_port_);
+  const std::uint8_t function_code = packet.size() > 7 ? packet[7] : 0;
+  ai_safety_controller::common::TransactionProbe probe(endpoint_key, function_code);
+  std::optional<ai_safety_controller::common::GatewaySerialGuard> serial_guard;
+  std::unique_lock<std::mutex> lock(socket_mutex_, std::defer_lock);
+  if (!pipelined) {
+    serial_guard.emplace(endpoint_key, 120, ai_safety_controller::common::busPriorityFor(function_code));
+    lock.lock();
+  }
+  probe.acquired();
+  const RetryPolicy policy = retryPolicy();
+  const int max_retries = std::max(0, policy.max_retries);
   for (int attempt = 0; attempt <= max_retries; ++attempt) {
     if (attempt > 0) {
-      const int delay_ms = computeRetryDelayMs(retry_policy_, attempt);
+      probe.retry();
+      const int delay_ms = computeRetryDelayMs(policy, attempt);
       if (delay_ms > 0) {
-        if (retry_policy_.log_enabled) {
-          std::cout << "[battery] ⚠️ 第" << attempt << "/" << max_retries
-                    << "次重试，退避" << delay_ms << "ms: " << context << "\n";
+        if (policy.log_enabled) {
+          LogLine(LogLevel::Warn, "battery") << "⚠️ 第" << attempt << "/" << max_retries
+                                             << "次重试，退避" << delay_ms << "ms: " << context;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
       }
     }
+    if (pipelined) {
+      std::string error;
+      bool timed_out = false;
+      probe.beginExchange();
+      if (pipeline.exchange(module_ip_, module_port_, packet, response, timeout_sec, &error, &timed_out)) {
+        probe.endExchange(packet.size(), response->size());
+        probe.finish(true);
+        return true;
+      }
+      if (timed_out) probe.timeout();
+      LogLine(LogLevel::Error, "battery") << "❌ " << error << ": " << context;
+      continue;
+    }
+    probe.beginConnect();
     if (!ensureConnectionLocked(timeout_sec)) {
       disconnectLocked();
       continue;
     }
-    if (sendAndReceiveLocked(packet, response, context)) {
-      disconnectLocked();
+    probe.endConnect();
+    if (sendAndReceiveLocked(packet, response, context, timeout_sec, &probe)) {
+      releaseConnectionLocked();
+      probe.finish(true);
       return true;
     }
     disconnectLocked();
   }
-  if (retry_policy_.log_enabled) {
-    std::cout << "[battery] ❌ 重试耗尽，操作失败: " << context << "\n";
+  if (policy.log_enabled) {
+    LogLine(LogLevel::Error, "battery") << "❌ 重试耗尽，操作失败: " << context;
   }
   return false;
 }
@@ -320,56 +350,53 @@ bool BatteryCore::sendModbusPacket(const std::vector<uint8_t>& packet,
 bool BatteryCore::ensureConnectionLocked(double timeout_sec) {
   if (socket_fd_ >= 0) return true;
 
-  socket_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  std::string error;
+  socket_fd_ = ai_safety_controller::common::ModbusTcpConnectionPool::instance().acquire(
+      module_ip_, module_port_, timeout_sec, &error);
   if (socket_fd_ < 0) {
-    std::cout << "[battery] ❌ socket 创建失败: " << std::strerror(errno) << "\n";
-    return false;
-  }
-
-  timeval tv{};
-  tv.tv_sec = static_cast<int>(timeout_sec);
-  tv.tv_usec = static_cast<int>((timeout_sec - tv.tv_sec) * 1000000.0);
-  ::setsockopt(socket_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-  ::setsockopt(socket_fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-  sockaddr_in addr{};
-  addr.sin_family = AF_INET;
-  addr.sin_port = htons(module_port_);
-  if (::inet_pton(AF_INET, module_ip_.c_str(), &addr.sin_addr) != 1) {
-    std::cout << "[battery] ❌ 模块IP无效: " << module_ip_ << "\n";
-    disconnectLocked();
-    return false;
-  }
-
-  if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
-    std::cout << "[battery] ❌ 连接失败: " << std::strerror(errno) << "\n";
-    disconnectLocked();
+    LogLine(LogLevel::Error, "battery") << "❌ " << error;
     return false;
   }
   return true;
 }
 
+void BatteryCore::releaseConnectionLocked() {
+  ai_safety_controller::common::ModbusTcpConnectionPool::instance().release(
+      module_ip_, module_port_, socket_fd_);
+  socket_fd_ = -1;
+}
+
 void BatteryCore::disconnectLocked() {
   if (socket_fd_ >= 0) {
-    ::close(socket_fd_);
+    ai_safety_controller::common::ModbusTcpConnectionPool::instance().discard(socket_fd_);
     socket_fd_ = -1;
   }
 }
 
-bool BatteryCore::sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                                       std::vector<uint8_t>* response,
-                                       const std::string& context) {
+bool BatteryCore::sendAndReceiveLocked(const ModbusFrame& packet,
+                                       ModbusFrame* response,
+                                       const LazyContext& context,
+                                       double timeout_sec,
+                                       ai_safety_controller::common::TransactionProbe* probe) {
+  probe->beginExchange();
   if (::send(socket_fd_, packet.data(), packet.size(), 0) < 0) {
-    std::cout << "[battery] ❌ 发送失败: " << std::strerror(errno) << "\n";
+    LogLine(LogLevel::Error, "battery") << "❌ 发送失败: " << std::strerror(errno);
     return false;
   }
-  uint8_t buf[1024];
-  const ssize_t n = ::recv(socket_fd_, buf, sizeof(buf), 0);
-  if (n <= 0) {
-    std::cout << "[battery] ❌ 无响应: " << context << "\n";
+  namespace mb = ai_safety_controller::common;
+  int stale = 0;
+  const mb::MbapReceiveStatus rx = mb::receiveMbapResponse(
+      socket_fd_, mb::readBe16(packet.data()), mb::deadlineAfter(timeout_sec), response, &stale);
+  if (stale > 0) {
+    LogLine(LogLevel::Warn, "battery") << "⚠️ 丢弃" << stale << "个过期响应帧: " << context;
+  }
+  if (rx != mb::MbapReceiveStatus::kOk) {
+    if (rx == mb::MbapReceiveStatus::kTimeout) probe->timeout();
+    probe->sent(packet.size());
+    LogLine(LogLevel::Error, "battery") << "❌ 无响应(" << mb::mbapReceiveStatusName(rx) << "): " << context;
     return false;
   }
-  response->assign(buf, buf + n);
+  probe->endExchange(packet.size(), response->size());
   return true;
 }
 
@@ -377,51 +404,68 @@ bool BatteryCore::sendBatteryRead(uint8_t function_code,
                                   uint16_t address,
                                   uint16_t quantity,
                                   uint8_t unit_id,
-                                  std::vector<uint8_t>* response,
+                                  ModbusFrame* response,
                                   double timeout_sec) {
   bool ok = false;
-  const std::vector<uint8_t> pkt =
-      createModbusPacket(function_code, address, 0, quantity, unit_id, &ok);
+  const ModbusFrame pkt = createModbusPacket(function_code, address, 0, quantity, unit_id, &ok);
   if (!ok) return false;
-  std::ostringstream ctx;
-  ctx << "电池读寄存器 fc=0x" << std::hex << std::uppercase << static_cast<int>(function_code)
-      << ", uid=" << std::dec << static_cast<int>(unit_id) << ", addr=0x" << std::hex
-      << std::uppercase << address << ", qty=" << std::dec << quantity;
-  return sendModbusPacket(pkt, response, ctx.str(), timeout_sec);
+  return sendModbusPacket(pkt, response,
+                          LazyContext("电池读寄存器", function_code, unit_id, address, quantity),
+                          timeout_sec);
+}
+
+bool BatteryCore::readRegisters(uint8_t function_code,
+                                uint16_t address,
+                                uint16_t quantity,
+                                uint8_t unit_id,
+                                std::vector<uint16_t>* values,
+                                double timeout_sec,
+                                uint8_t* exception_code) {
+  ModbusFrame response;
+  if (exception_code) *exception_code = 0;
+  if (!sendBatteryRead(function_code, address, quantity, unit_id, &response, timeout_sec)) {
+    return false;
+  }
+  return parseRegisterResponse(response, function_code, quantity, values, exception_code);
 }
 
-bool BatteryCore::parseRegisterResponse(const std::vector<uint8_t>& response,
+bool BatteryCore::parseRegisterResponse(const ModbusFrame& response,
                                         uint8_t function_code,
                                         uint16_t quantity,
-                                        std::vector<uint16_t>* values) const {
+                                        std::vector<uint16_t>* values,
+                                        uint8_t* exception_code) const {
+  using ai_safety_controller::common::DecodeError;
   if (!values) return false;
   values->clear();
-  if (response.size() < 9) {
-    std::cout << "[battery] ❌ 响应报文过短\n";
-    return false;
-  }
-  const uint8_t recv_fc = response[7];
-  if (recv_fc != function_code) {
-    const uint8_t err = response.size() > 8 ? response[8] : 0;
-    std::cout << "❌ 电池返回错误，错误码：0x" << std::hex << std::uppercase
-              << static_cast<int>(err) << std::dec << "\n";
-    return false;
-  }
-  const uint8_t data_len = response[8];
-  const size_t expected_len = 9 + data_len;
-  if (response.size() != expected_len) {
-    std::cout << "[battery] ❌ 响应长度异常，预期" << expected_len << "字节，实际" << response.size()
-              << "字节\n";
-    return false;
-  }
-  if (data_len < quantity * 2) {
-    std::cout << "[battery] ❌ 数据长度不足，无法解析" << quantity << "个寄存器\n";
-    return false;
-  }
-  for (uint16_t i = 0; i < quantity; ++i) {
-    const size_t base = 9 + i * 2;
-    values->push_back(readBe16(&response[base]));
-  }
+  if (exception_code) *exception_code = 0;
+  const auto decoded = ai_safety_controller::common::decodeMbapRegisters(
+      response.data(), response.size(), function_code, quantity);
+  switch (decoded.error) {
+    case DecodeError::kNone:
+      break;
+    case DecodeError::kException:
+      if (exception_code) *exception_code = decoded.exception_code;
+      LogLine(LogLevel::Error, "battery").printf(
+          "❌ 电池返回错误，错误码：0x%X", static_cast<unsigned>(decoded.exception_code));
+      return false;
+    case DecodeError::kFunctionMismatch:
+      LogLine(LogLevel::Error, "battery").printf(
+          "❌ 功能码不匹配，期望0x%02X，实际0x%02X", static_cast<unsigned>(function_code),
+          static_cast<unsigned>(decoded.function_code));
+      return false;
+    case DecodeError::kLengthMismatch:
+      LogLine(LogLevel::Error, "battery") << "❌ 响应长度异常，预期" << decoded.expected_size << "字节，实际"
+                                          << response.size() << "字节";
+      return false;
+    case DecodeError::kShortPayload:
+      LogLine(LogLevel::Error, "battery") << "❌ 数据长度不足，无法解析" << quantity << "个寄存器";
+      return false;
+    default:
+      LogLine(LogLevel::Error, "battery") << "❌ 响应报文过短";
+      return false;
+  }
+  values->reserve(quantity);
+  for (uint16_t i = 0; i < quantity; ++i) values->push_back(decoded.registers[i]);
   return true;
 }
 
@@ -466,24 +510,31 @@ bool BatteryCore::confirmRiskyWrite(uint16_t addr) const {
   return input == "YES";
 }
 
-void BatteryCore::genericRead(uint16_t address, uint16_t quantity, int function_code) {
+bool BatteryCore::readRegisterValues(uint16_t address,
+                                     uint16_t quantity,
+                                     int function_code,
+                                     std::vector<uint16_t>* values,
+                                     std::string* error) {
   if (quantity < 1 || quantity > 125) {
-    std::cout << "[battery] ❌ 数量超限，读寄存器数量需在1~125\n";
-    return;
+    if (error) *error = "[battery] ❌ 数量超限，读寄存器数量需在1~125";
+    return false;
   }
-  int fc = (function_code < 0) ? 0x03 : function_code;
+  const int fc = (function_code < 0) ? 0x03 : function_code;
   if (!(fc == 0x03 || fc == 0x04)) {
-    std::cout << "❌ 电池读取仅支持功能码 0x03/0x04\n";
-    return;
-  }
-  std::vector<uint8_t> response;
-  if (!sendBatteryRead(static_cast<uint8_t>(fc), address, quantity, battery_slave_id_, &response)) {
-    return;
+    if (error) *error = "❌ 电池读取仅支持功能码 0x03/0x04";
+    return false;
   }
+  return readRegisters(static_cast<uint8_t>(fc), address, quantity, battery_slave_id_, values, 5.0);
+}
+
+void BatteryCore::genericRead(uint16_t address, uint16_t quantity, int function_code) {
   std::vector<uint16_t> values;
-  if (!parseRegisterResponse(response, static_cast<uint8_t>(fc), quantity, &values)) {
+  std::string error;
+  if (!readRegisterValues(address, quantity, function_code, &values, &error)) {
+    if (!error.empty()) std::cout << error << "\n";
     return;
   }
+  const int fc = (function_code < 0) ? 0x03 : function_code;
   std::cout << "✅ 电池寄存器读取结果（fc=0x" << std::hex << std::uppercase << fc << std::dec
             << "）\n";
   for (size_t i = 0; i < values.size(); ++i) {
@@ -505,10 +556,10 @@ void BatteryCore::genericWrite(uint16_t address, uint16_t value, int function_co
     return;
   }
   bool ok = false;
-  const std::vector<uint8_t> packet =
+  const ModbusFrame packet =
       createModbusPacket(0x06, address, value, 0, battery_slave_id_, &ok);
   if (!ok) return;
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendModbusPacket(packet, &response, "电池写寄存器")) return;
   if (response == packet) {
     std::cout << "✅ 电池写入成功：0x" << std::hex << std::uppercase << std::setw(4)
@@ -526,11 +577,11 @@ void BatteryCore::queryBatteryInfo(const std::string& info_type) {
   }
 
   if (info_type == "basic") {
-    std::vector<uint8_t> response;
+    ModbusFrame response;
     if (!sendBatteryRead(0x03, 0x0000, 9, battery_slave_id_, &response)) return;
     std::vector<uint16_t> values;
     if (!parseRegisterResponse(response, 0x03, 9, &values)) return;
-    std::vector<uint8_t> charge_mos_resp;
+    ModbusFrame charge_mos_resp;
     bool has_charge_mos = false;
     uint16_t charge_mos = 0;
     if (sendBatteryRead(0x03, 0x000A, 1, battery_slave_id_, &charge_mos_resp)) {
@@ -575,7 +626,7 @@ void BatteryCore::queryBatteryInfo(const std::string& info_type) {
               << " (raw=0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0')
               << charge_time_raw << std::dec << ")\n";
   } else if (info_type == "cell") {
-    std::vector<uint8_t> response;
+    ModbusFrame response;
     if (!sendBatteryRead(0x03, 0x0010, 16, battery_slave_id_, &response)) return;
     std::vector<uint16_t> values;
     if (!parseRegisterResponse(response, 0x03, 16, &values)) return;
@@ -592,7 +643,7 @@ void BatteryCore::queryBatteryInfo(const std::string& info_type) {
       std::cout << "  第" << (i + 1) << "节: " << values[i] << "mV\n";
     }
   } else if (info_type == "temp") {
-    std::vector<uint8_t> response;
+    ModbusFrame response;
     if (!sendBatteryRead(0x03, 0x0050, 2, battery_slave_id_, &response)) return;
     std::vector<uint16_t> values;
     if (!parseRegisterResponse(response, 0x03, 2, &values)) return;
@@ -602,8 +653,8 @@ void BatteryCore::queryBatteryInfo(const std::string& info_type) {
     std::cout << "  第2路NTC温度: " << std::fixed << std::setprecision(1) << toSigned16(values[1]) * 0.1
               << "℃\n";
   } else if (info_type == "mos") {
-    std::vector<uint8_t> c_resp;
-    std::vector<uint8_t> d_resp;
+    ModbusFrame c_resp;
+    ModbusFrame d_resp;
     std::cout << "[battery] ✅ MOS管状态：\n";
     if (sendBatteryRead(0x03, 0x000A, 1, battery_slave_id_, &c_resp)) {
       std::vector<uint16_t> values;
@@ -618,7 +669,7 @@ void BatteryCore::queryBatteryInfo(const std::string& info_type) {
       }
     }
   } else if (info_type == "protect") {
-    std::vector<uint8_t> response;
+    ModbusFrame response;
     if (!sendBatteryRead(0x03, 0x0062, 1, battery_slave_id_, &response)) return;
     std::vector<uint16_t> values;
     if (!parseRegisterResponse(response, 0x03, 1, &values)) return;
@@ -662,7 +713,7 @@ void BatteryCore::scanBatterySlaveIds(int start_id, int end_id) {
   std::vector<int> found;
   for (int uid = start_id; uid <= end_id; ++uid) {
     if (uid == module_slave_id_) continue;
-    std::vector<uint8_t> response;
+    ModbusFrame response;
     if (!sendBatteryRead(0x03, 0x0002, 1, static_cast<uint8_t>(uid), &response, 1.5)) continue;
     std::vector<uint16_t> values;
     if (!parseRegisterResponse(response, 0x03, 1, &values)) continue;
@@ -688,10 +739,10 @@ void BatteryCore::setBatteryAddr(int new_addr) {
     return;
   }
   bool ok = false;
-  const std::vector<uint8_t> packet = createModbusPacket(
+  const ModbusFrame packet = createModbusPacket(
       0x06, 0x0064, static_cast<uint16_t>(new_addr), 0, battery_slave_id_, &ok);
   if (!ok) return;
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendModbusPacket(packet, &response, "电池地址修改")) return;
   if (response == packet) {
     battery_slave_id_ = static_cast<uint8_t>(new_addr);
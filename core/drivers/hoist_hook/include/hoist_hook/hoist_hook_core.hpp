@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+
 #include <atomic>
 #include <cstdint>
 #include <mutex>
@@ -57,9 +60,22 @@ class HoistHookCore {
   void startHeartbeat();
   void stopHeartbeat();
   void configureTimeSync(bool enable, int period_ms, bool log_enabled);
+  /** 合并读取时允许的寄存器空洞数，0 表示只合并相邻区间 */
+  void setReadGapTolerance(int registers);
+  /** 运行中替换重试策略，下一次请求生效 */
+  void setRetryPolicy(const RetryPolicy& retry_policy);
   void startTimeSync();
   void stopTimeSync();
   void genericRead(uint16_t address, uint16_t quantity, int function_code);
+  /**
+   * 读取连续寄存器并返回原始值，不打印；function_code<0 时使用默认功能码。
+   * 参数非法时 error 给出原因；通信失败时 error 为空（驱动已记录日志）。
+   */
+  bool readRegisterValues(uint16_t address,
+                          uint16_t quantity,
+                          int function_code,
+                          std::vector<uint16_t>* values,
+                          std::string* error = nullptr);
   /** skip_confirm=true 用于喇叭/灯/音量等交互控制；quiet=true 不打印写入成功，用于轮播时避免刷屏 */
   void genericWrite(uint16_t address, uint16_t value, int function_code, bool skip_confirm = false, bool quiet = false);
 
@@ -81,6 +97,7 @@ class HoistHookCore {
   bool readPowerSummary(PowerSummary* out, double timeout_sec = 2.0);
 
  private:
+  RetryPolicy retryPolicy() const;
   struct RegisterGroup {
     uint16_t start;
     uint16_t end;
@@ -88,34 +105,38 @@ class HoistHookCore {
     std::string desc;
   };
 
-  std::vector<uint8_t> createModbusPacket(uint8_t function_code,
-                                          uint16_t address,
-                                          uint16_t value,
-                                          uint16_t quantity,
-                                          uint8_t unit_id,
-                                          bool* ok);
-  bool sendModbusPacket(const std::vector<uint8_t>& packet,
-                        std::vector<uint8_t>* response,
-                        const std::string& context,
+  ai_safety_controller::common::ModbusFrame createModbusPacket(uint8_t function_code,
+                                                               uint16_t address,
+                                                               uint16_t value,
+                                                               uint16_t quantity,
+                                                               uint8_t unit_id,
+                                                               bool* ok);
+  bool sendModbusPacket(const ai_safety_controller::common::ModbusFrame& packet,
+                        ai_safety_controller::common::ModbusFrame* response,
+                        const ai_safety_controller::common::LazyContext& context,
                         double timeout_sec = 5.0);
+  std::string busKey() const;
+  std::uint32_t busMinGapMs() const;
   bool ensureConnectionLocked(double timeout_sec);
   void disconnectLocked();
-  bool sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                            std::vector<uint8_t>* response,
-                            const std::string& context);
+  bool sendAndReceiveLocked(const ai_safety_controller::common::ModbusFrame& packet,
+                            ai_safety_controller::common::ModbusFrame* response,
+                            const ai_safety_controller::common::LazyContext& context,
+                            double timeout_sec,
+                            ai_safety_controller::common::TransactionProbe* probe);
   bool sendRead(uint8_t function_code,
                 uint16_t address,
                 uint16_t quantity,
                 uint8_t unit_id,
-                std::vector<uint8_t>* response,
+                ai_safety_controller::common::ModbusFrame* response,
                 double timeout_sec = 5.0);
-  bool parseRegisterResponse(const std::vector<uint8_t>& response,
+  bool parseRegisterResponse(const ai_safety_controller::common::ModbusFrame& response,
                              uint8_t function_code,
                              uint16_t quantity,
-                             std::vector<uint16_t>* values) const;
+                             std::vector<uint16_t>* values,
+                             uint8_t* exception_code = nullptr) const;
   bool confirmRiskyWrite(uint16_t addr) const;
   std::string describeRegister(uint16_t addr) const;
-  static uint16_t crc16Modbus(const uint8_t* data, size_t len);
 
   void querySpeakerStatus();
   void queryLightStatus();
@@ -143,6 +164,7 @@ class HoistHookCore {
   int socket_fd_;
   int serial_fd_;
   RetryPolicy retry_policy_;
+  mutable std::mutex retry_policy_mutex_;
   bool heartbeat_enabled_;
   int heartbeat_period_ms_;
   bool heartbeat_log_enabled_;
@@ -155,6 +177,7 @@ class HoistHookCore {
   std::atomic<bool> time_sync_running_;
   std::thread time_sync_thread_;
   bool print_enabled_;
+  std::atomic<uint16_t> read_gap_tolerance_{4};
   std::mutex socket_mutex_;
   std::vector<RegisterGroup> register_groups_;
 };
@@ -1,4 +1,9 @@
 #include "hoist_hook/hoist_hook_core.hpp"
+#include "ai_safety_controller/common/gateway_serial.hpp"
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/modbus_read_plan.hpp"
+#include "ai_safety_controller/common/modbus_rtu_receiver.hpp"
+#include "ai_safety_controller/common/modbus_tcp_receiver.hpp"
 
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -16,16 +21,16 @@
 #include <iostream>
 #include <map>
 #include <random>
-#include <sstream>
 #include <thread>
 
 namespace hoist_hook {
 
 namespace {
 
-uint16_t readBe16(const uint8_t* p) {
-  return static_cast<uint16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
-}
+using ai_safety_controller::common::LazyContext;
+using ai_safety_controller::common::LogLevel;
+using ai_safety_controller::common::LogLine;
+using ai_safety_controller::common::ModbusFrame;
 
 uint32_t mergeUid(uint16_t high_word, uint16_t low_word) {
   return (static_cast<uint32_t>(high_word) << 16) | low_word;
@@ -50,20 +55,6 @@ int computeRetryDelayMs(const HoistHookCore::RetryPolicy& policy, int retry_inde
 
 }  // namespace
 
-uint16_t HoistHookCore::crc16Modbus(const uint8_t* data, size_t len) {
-  uint16_t crc = 0xFFFF;
-  for (size_t i = 0; i < len; ++i) {
-    crc ^= static_cast<uint16_t>(data[i]);
-    for (int j = 0; j < 8; ++j) {
-    if (crc & 1)
-      crc = static_cast<uint16_t>((crc >> 1) ^ 0xA001);
-    else
-      crc = static_cast<uint16_t>(crc >> 1);
-    }
-  }
-  return crc;
-}
-
 HoistHookCore::HoistHookCore() : HoistHookCore("192.168.1.12", 502, 0x03, 0x04, RetryPolicy()) {}
 
 HoistHookCore::HoistHookCore(const std::string& module_ip,
@@ -187,6 +178,10 @@ void HoistHookCore::configureTimeSync(bool enable, int period_ms, bool log_enabl
   time_sync_log_enabled_ = log_enabled;
 }
 
+void HoistHookCore::setReadGapTolerance(int registers) {
+  read_gap_tolerance_ = static_cast<uint16_t>(std::min(std::max(registers, 0), 64));
+}
+
 void HoistHookCore::startTimeSync() {
   if (!time_sync_enabled_) return;
   if (time_sync_running_.load(std::memory_order_relaxed)) return;
@@ -204,7 +199,7 @@ void HoistHookCore::heartbeatLoop() {
     const std::uint16_t value = heartbeat_counter_.load(std::memory_order_relaxed);
     genericWrite(static_cast<uint16_t>(0x0068), value, 0x06, true, true);
     if (heartbeat_log_enabled_) {
-      std::cout << "[hoist_hook] 🫀 心跳写入 reg104=" << value << "\n";
+      LogLine(LogLevel::Info, "hoist_hook") << "🫀 心跳写入 reg104=" << value;
     }
     heartbeat_counter_.store(static_cast<std::uint16_t>(value + 1), std::memory_order_relaxed);
     std::this_thread::sleep_for(std::chrono::milliseconds(heartbeat_period_ms_));
@@ -222,12 +217,12 @@ void HoistHookCore::timeSyncLoop() {
     const bool wrote = tryWriteTimeSyncNoPreempt(value);
     if (time_sync_log_enabled_) {
       if (wrote) {
-        std::cout << "[hoist_hook] 🕒 时间同步写入 reg116=0x"
-                  << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << value
-                  << std::dec << " (" << local_tm.tm_hour << ":" << std::setw(2)
-                  << std::setfill('0') << local_tm.tm_min << ")\n";
+        LogLine(LogLevel::Info, "hoist_hook").printf("🕒 时间同步写入 reg116=0x%04X (%d:%02d)",
+                                                     static_cast<unsigned>(value),
+                                                     local_tm.tm_hour,
+                                                     local_tm.tm_min);
       } else {
-        std::cout << "[hoist_hook] 🕒 时间同步跳过：总线忙，未抢占业务\n";
+        LogLine(LogLevel::Info, "hoist_hook") << "🕒 时间同步跳过：总线忙，未抢占业务";
       }
     }
     std::this_thread::sleep_for(std::chrono::milliseconds(time_sync_period_ms_));
@@ -236,7 +231,7 @@ void HoistHookCore::timeSyncLoop() {
 
 bool HoistHookCore::tryWriteTimeSyncNoPreempt(std::uint16_t value) {
   bool packet_ok = false;
-  const std::vector<uint8_t> packet = createModbusPacket(
+  const ModbusFrame packet = createModbusPacket(
       static_cast<uint8_t>(0x06),
       static_cast<uint16_t>(0x0074),
       value,
@@ -246,17 +241,26 @@ bool HoistHookCore::tryWriteTimeSyncNoPreempt(std::uint16_t value) {
   if (!packet_ok) return false;
 
   // Non-preemptive rule: if the bus lock is busy, skip this cycle immediately.
+  ai_safety_controller::common::GatewaySerialGuard serial_guard(
+      busKey(), busMinGapMs(), std::try_to_lock);
+  if (!serial_guard.owns()) return false;
   std::unique_lock<std::mutex> lock(socket_mutex_, std::try_to_lock);
   if (!lock.owns_lock()) return false;
 
-  std::vector<uint8_t> response;
+  // Skipped cycles above are not transactions; only a taken bus is measured.
+  ai_safety_controller::common::TransactionProbe probe(busKey(), 0x06);
+  probe.acquired();
+  ModbusFrame response;
+  probe.beginConnect();
   if (!ensureConnectionLocked(5.0)) {
     disconnectLocked();
     return false;
   }
-  const bool ok = sendAndReceiveLocked(packet, &response, "时间同步写寄存器(非抢占)");
+  probe.endConnect();
+  const bool ok = sendAndReceiveLocked(packet, &response, "时间同步写寄存器(非抢占)", 5.0, &probe);
   disconnectLocked();
   if (!ok) return false;
+  probe.finish(response == packet);
   return response == packet;
 }
 
@@ -289,101 +293,108 @@ bool HoistHookCore::parseFunctionCode(const std::string& text,
   return false;
 }
 
-std::vector<uint8_t> HoistHookCore::createModbusPacket(uint8_t function_code,
-                                                       uint16_t address,
-                                                       uint16_t value,
-                                                       uint16_t quantity,
-                                                       uint8_t unit_id,
-                                                       bool* ok) {
+ModbusFrame HoistHookCore::createModbusPacket(uint8_t function_code,
+                                              uint16_t address,
+                                              uint16_t value,
+                                              uint16_t quantity,
+                                              uint8_t unit_id,
+                                              bool* ok) {
   if (ok) *ok = false;
   if (!(function_code == 0x03 || function_code == 0x06)) {
-    std::cout << "[hoist_hook] ❌ 不支持的功能码，仅支持 0x03/0x06\n";
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ 不支持的功能码，仅支持 0x03/0x06";
     return {};
   }
 
   const uint16_t data = (function_code == 0x06) ? value : quantity;
+  ModbusFrame pkt;
 
   if (transport_ == Transport::RTU) {
-    std::vector<uint8_t> pkt;
-    pkt.reserve(8);
-    pkt.push_back(unit_id);
-    pkt.push_back(function_code);
-    pkt.push_back(static_cast<uint8_t>((address >> 8) & 0xFF));
-    pkt.push_back(static_cast<uint8_t>(address & 0xFF));
-    pkt.push_back(static_cast<uint8_t>((data >> 8) & 0xFF));
-    pkt.push_back(static_cast<uint8_t>(data & 0xFF));
-    const uint16_t crc = crc16Modbus(pkt.data(), pkt.size());
-    pkt.push_back(static_cast<uint8_t>(crc & 0xFF));
-    pkt.push_back(static_cast<uint8_t>((crc >> 8) & 0xFF));
+    ai_safety_controller::common::encodeRtuRequest(&pkt, unit_id, function_code, address, data);
     if (ok) *ok = true;
     return pkt;
   }
 
   transaction_id_ = static_cast<uint16_t>((transaction_id_ + 1) & 0xFFFF);
-  const uint16_t protocol_id = 0x0000;
-  const uint16_t length = 6;
-
-  std::vector<uint8_t> pkt;
-  pkt.reserve(12);
-  pkt.push_back(static_cast<uint8_t>((transaction_id_ >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(transaction_id_ & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((protocol_id >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(protocol_id & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((length >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(length & 0xFF));
-  pkt.push_back(unit_id);
-  pkt.push_back(function_code);
-  pkt.push_back(static_cast<uint8_t>((address >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(address & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((data >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(data & 0xFF));
-
+  ai_safety_controller::common::encodeMbapRequest(
+      &pkt, transaction_id_, unit_id, function_code, address, data);
   if (ok) *ok = true;
   return pkt;
 }
 
-bool HoistHookCore::sendModbusPacket(const std::vector<uint8_t>& packet,
-                                     std::vector<uint8_t>* response,
-                                     const std::string& context,
+void HoistHookCore::setRetryPolicy(const RetryPolicy& retry_policy) {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  retry_policy_ = retry_policy;
+}
+
+HoistHookCore::RetryPolicy HoistHookCore::retryPolicy() const {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  return retry_policy_;
+}
+
+bool HoistHookCore::sendModbusPacket(const ModbusFrame& packet,
+                                     ModbusFrame* response,
+                                     const LazyContext& context,
                                      double timeout_sec) {
   if (!response) return false;
   response->clear();
+  const std::size_t fc_offset = transport_ == Transport::RTU ? 1 : 7;
+  const std::uint8_t function_code = packet.size() > fc_offset ? packet[fc_offset] : 0;
+  ai_safety_controller::common::TransactionProbe probe(busKey(), function_code);
+  ai_safety_controller::common::GatewaySerialGuard serial_guard(
+      busKey(), busMinGapMs(), ai_safety_controller::common::busPriorityFor(function_code));
   std::lock_guard<std::mutex> lock(socket_mutex_);
-  const int max_retries = std::max(0, retry_policy_.max_retries);
+  probe.acquired();
+  const RetryPolicy policy = retryPolicy();
+  const int max_retries = std::max(0, policy.max_retries);
   for (int attempt = 0; attempt <= max_retries; ++attempt) {
     if (attempt > 0) {
-      const int delay_ms = computeRetryDelayMs(retry_policy_, attempt);
+      probe.retry();
+      const int delay_ms = computeRetryDelayMs(policy, attempt);
       if (delay_ms > 0) {
-        if (retry_policy_.log_enabled) {
-          std::cout << "[hoist_hook] ⚠️ 第" << attempt << "/" << max_retries
-                    << "次重试，退避" << delay_ms << "ms: " << context << "\n";
+        if (policy.log_enabled) {
+          LogLine(LogLevel::Warn, "hoist_hook") << "⚠️ 第" << attempt << "/" << max_retries
+                                                << "次重试，退避" << delay_ms << "ms: " << context;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
       }
     }
+    probe.beginConnect();
     if (!ensureConnectionLocked(timeout_sec)) {
       disconnectLocked();
       continue;
     }
-    if (sendAndReceiveLocked(packet, response, context)) {
+    probe.endConnect();
+    if (sendAndReceiveLocked(packet, response, context, timeout_sec, &probe)) {
       disconnectLocked();
+      probe.finish(true);
       return true;
     }
     disconnectLocked();
   }
-  if (retry_policy_.log_enabled) {
-    std::cout << "[hoist_hook] ❌ 重试耗尽，操作失败: " << context << "\n";
+  if (policy.log_enabled) {
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ 重试耗尽，操作失败: " << context;
   }
   return false;
 }
 
+std::string HoistHookCore::busKey() const {
+  if (transport_ == Transport::RTU) return device_;
+  return module_ip_ + ":" + std::to_string(module_port_);
+}
+
+std::uint32_t HoistHookCore::busMinGapMs() const {
+  // RTU line is owned by this driver; TCP shares the gateway pacing of other drivers.
+  return transport_ == Transport::RTU ? 0u : 120u;
+}
+
 bool HoistHookCore::ensureConnectionLocked(double timeout_sec) {
   (void)timeout_sec;
   if (transport_ == Transport::RTU) {
     if (serial_fd_ >= 0) return true;
     serial_fd_ = ::open(device_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (serial_fd_ < 0) {
-      std::cout << "[hoist_hook] ❌ 串口打开失败: " << device_ << " " << std::strerror(errno) << "\n";
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ 串口打开失败: " << device_ << " "
+                                             << std::strerror(errno);
       return false;
     }
     speed_t speed = B9600;
@@ -392,14 +403,14 @@ bool HoistHookCore::ensureConnectionLocked(double timeout_sec) {
     else if (baud_ == 57600) speed = B57600;
     else if (baud_ == 115200) speed = B115200;
     else if (baud_ != 9600) {
-      std::cout << "[hoist_hook] ❌ 不支持的波特率: " << baud_ << "\n";
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ 不支持的波特率: " << baud_;
       ::close(serial_fd_);
       serial_fd_ = -1;
       return false;
     }
     struct termios tio;
     if (::tcgetattr(serial_fd_, &tio) != 0) {
-      std::cout << "[hoist_hook] ❌ tcgetattr 失败: " << std::strerror(errno) << "\n";
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ tcgetattr 失败: " << std::strerror(errno);
       ::close(serial_fd_);
       serial_fd_ = -1;
       return false;
@@ -421,7 +432,7 @@ bool HoistHookCore::ensureConnectionLocked(double timeout_sec) {
     tio.c_cc[VMIN] = 0;
     tio.c_cc[VTIME] = 10;
     if (::tcsetattr(serial_fd_, TCSANOW, &tio) != 0) {
-      std::cout << "[hoist_hook] ❌ tcsetattr 失败: " << std::strerror(errno) << "\n";
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ tcsetattr 失败: " << std::strerror(errno);
       ::close(serial_fd_);
       serial_fd_ = -1;
       return false;
@@ -432,7 +443,7 @@ bool HoistHookCore::ensureConnectionLocked(double timeout_sec) {
   if (socket_fd_ >= 0) return true;
   socket_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
   if (socket_fd_ < 0) {
-    std::cout << "[hoist_hook] ❌ socket 创建失败: " << std::strerror(errno) << "\n";
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ socket 创建失败: " << std::strerror(errno);
     return false;
   }
   timeval tv{};
@@ -445,12 +456,12 @@ bool HoistHookCore::ensureConnectionLocked(double timeout_sec) {
   addr.sin_family = AF_INET;
   addr.sin_port = htons(module_port_);
   if (::inet_pton(AF_INET, module_ip_.c_str(), &addr.sin_addr) != 1) {
-    std::cout << "[hoist_hook] ❌ 模块IP无效: " << module_ip_ << "\n";
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ 模块IP无效: " << module_ip_;
     disconnectLocked();
     return false;
   }
   if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
-    std::cout << "[hoist_hook] ❌ 连接失败: " << std::strerror(errno) << "\n";
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ 连接失败: " << std::strerror(errno);
     disconnectLocked();
     return false;
   }
@@ -468,49 +479,64 @@ void HoistHookCore::disconnectLocked() {
   }
 }
 
-bool HoistHookCore::sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                                         std::vector<uint8_t>* response,
-                                         const std::string& context) {
+bool HoistHookCore::sendAndReceiveLocked(const ModbusFrame& packet,
+                                         ModbusFrame* response,
+                                         const LazyContext& context,
+                                         double timeout_sec,
+                                         ai_safety_controller::common::TransactionProbe* probe) {
+  probe->beginExchange();
   if (transport_ == Transport::RTU) {
+    namespace mb = ai_safety_controller::common;
+    // Drop a late reply to an earlier, timed-out request before asking again.
+    ::tcflush(serial_fd_, TCIFLUSH);
     if (::write(serial_fd_, packet.data(), packet.size()) != static_cast<ssize_t>(packet.size())) {
-      std::cout << "[hoist_hook] ❌ 串口发送失败: " << std::strerror(errno) << "\n";
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ 串口发送失败: " << std::strerror(errno);
       return false;
     }
-    response->clear();
-    uint8_t buf[256];
-    const int total_timeout_ms = 500;
-    const int chunk_ms = 50;
-    int elapsed = 0;
-    while (elapsed < total_timeout_ms) {
-      const ssize_t n = ::read(serial_fd_, buf, sizeof(buf));
-      if (n > 0) {
-        response->insert(response->end(), buf, buf + n);
-        if (response->size() >= 5) {
-          const uint8_t byte_count = (*response)[2];
-          const size_t expected = static_cast<size_t>(3) + byte_count + 2;
-          if (response->size() >= expected) break;
-        }
+    // Known-length replies return on their last byte; the silence window only
+    // ends frames of unknown layout or catches a truncated one. It is kept
+    // above one USB-serial latency tick (~16 ms), which is far longer than
+    // 3.5 characters at 9600 baud.
+    const int bits_per_char =
+        1 + data_bit_ + ((parity_ == 'N' || parity_ == 'n') ? 0 : 1) + (stop_bit_ == 2 ? 2 : 1);
+    const std::chrono::microseconds silence =
+        std::max<std::chrono::microseconds>(mb::rtuFrameSilence(baud_, bits_per_char),
+                                            std::chrono::milliseconds(20));
+    const mb::RtuReceiveStatus rx = mb::receiveRtuFrame(
+        serial_fd_, packet[0], packet[1], std::chrono::milliseconds(500), silence, response);
+    if (rx != mb::RtuReceiveStatus::kOk) {
+      if (rx == mb::RtuReceiveStatus::kTimeout) probe->timeout();
+      probe->sent(packet.size());
+      if (rx == mb::RtuReceiveStatus::kTimeout) {
+        LogLine(LogLevel::Error, "hoist_hook") << "❌ 无响应: " << context;
+      } else {
+        LogLine(LogLevel::Error, "hoist_hook")
+            << "❌ RTU 响应无效(" << mb::rtuReceiveStatusName(rx) << ", " << response->size()
+            << "B): " << context;
       }
-      usleep(static_cast<useconds_t>(chunk_ms) * 1000);
-      elapsed += chunk_ms;
-    }
-    if (response->empty()) {
-      std::cout << "[hoist_hook] ❌ 无响应: " << context << "\n";
       return false;
     }
+    probe->endExchange(packet.size(), response->size());
     return true;
   }
   if (::send(socket_fd_, packet.data(), packet.size(), 0) < 0) {
-    std::cout << "[hoist_hook] ❌ 发送失败: " << std::strerror(errno) << "\n";
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ 发送失败: " << std::strerror(errno);
     return false;
   }
-  uint8_t buf[1024];
-  const ssize_t n = ::recv(socket_fd_, buf, sizeof(buf), 0);
-  if (n <= 0) {
-    std::cout << "[hoist_hook] ❌ 无响应: " << context << "\n";
+  namespace mb = ai_safety_controller::common;
+  int stale = 0;
+  const mb::MbapReceiveStatus rx = mb::receiveMbapResponse(
+      socket_fd_, mb::readBe16(packet.data()), mb::deadlineAfter(timeout_sec), response, &stale);
+  if (stale > 0) {
+    LogLine(LogLevel::Warn, "hoist_hook") << "⚠️ 丢弃" << stale << "个过期响应帧: " << context;
+  }
+  if (rx != mb::MbapReceiveStatus::kOk) {
+    if (rx == mb::MbapReceiveStatus::kTimeout) probe->timeout();
+    probe->sent(packet.size());
+    LogLine(LogLevel::Error, "hoist_hook") << "❌ 无响应(" << mb::mbapReceiveStatusName(rx) << "): " << context;
     return false;
   }
-  response->assign(buf, buf + n);
+  probe->endExchange(packet.size(), response->size());
   return true;
 }
 
@@ -518,86 +544,63 @@ bool HoistHookCore::sendRead(uint8_t function_code,
                              uint16_t address,
                              uint16_t quantity,
                              uint8_t unit_id,
-                             std::vector<uint8_t>* response,
+                             ModbusFrame* response,
                              double timeout_sec) {
   bool ok = false;
-  const std::vector<uint8_t> packet =
-      createModbusPacket(function_code, address, 0, quantity, unit_id, &ok);
+  const ModbusFrame packet = createModbusPacket(function_code, address, 0, quantity, unit_id, &ok);
   if (!ok) return false;
-  std::ostringstream context;
-  context << "吊钩读寄存器 fc=0x" << std::hex << std::uppercase << static_cast<int>(function_code)
-          << ", uid=" << std::dec << static_cast<int>(unit_id) << ", addr=0x" << std::hex
-          << std::uppercase << address << ", qty=" << std::dec << quantity;
-  return sendModbusPacket(packet, response, context.str(), timeout_sec);
+  return sendModbusPacket(packet, response,
+                          LazyContext("吊钩读寄存器", function_code, unit_id, address, quantity),
+                          timeout_sec);
 }
 
-bool HoistHookCore::parseRegisterResponse(const std::vector<uint8_t>& response,
+bool HoistHookCore::parseRegisterResponse(const ModbusFrame& response,
                                           uint8_t function_code,
                                           uint16_t quantity,
-                                          std::vector<uint16_t>* values) const {
+                                          std::vector<uint16_t>* values,
+                                          uint8_t* exception_code) const {
+  using ai_safety_controller::common::DecodeError;
   if (!values) return false;
   values->clear();
-
-  if (transport_ == Transport::RTU) {
-    if (response.size() < 5) {
-      std::cout << "[hoist_hook] ❌ RTU 响应过短\n";
+  if (exception_code) *exception_code = 0;
+
+  const bool rtu = (transport_ == Transport::RTU);
+  size_t size = response.size();
+  if (!rtu && size >= 9) {
+    // The gateway may append trailing bytes after the MBAP frame; decode only the frame.
+    size = std::min(size, static_cast<size_t>(9) + response[8]);
+  }
+  namespace mb = ai_safety_controller::common;
+  const auto decoded = rtu ? mb::decodeRtuRegisters(response.data(), size, function_code, quantity)
+                           : mb::decodeMbapRegisters(response.data(), size, function_code, quantity);
+  switch (decoded.error) {
+    case DecodeError::kNone:
+      break;
+    case DecodeError::kTooShort:
+      LogLine(LogLevel::Error, "hoist_hook") << (rtu ? "❌ RTU 响应过短" : "❌ 响应报文过短");
       return false;
-    }
-    const uint8_t recv_fc = response[1];
-    if (recv_fc != function_code) {
-      const uint8_t err = (recv_fc & 0x80) && response.size() > 2 ? response[2] : 0;
-      std::cout << "[hoist_hook] ❌ 设备返回错误，错误码：0x" << std::hex << std::uppercase
-                << static_cast<int>(err) << std::dec << "\n";
+    case DecodeError::kException:
+      if (exception_code) *exception_code = decoded.exception_code;
+      LogLine(LogLevel::Error, "hoist_hook").printf(
+          "❌ 设备返回错误，错误码：0x%X", static_cast<unsigned>(decoded.exception_code));
       return false;
-    }
-    const uint8_t data_len = response[2];
-    const size_t payload_end = static_cast<size_t>(3) + data_len;
-    if (response.size() < payload_end + 2) {
-      std::cout << "[hoist_hook] ❌ RTU 响应长度异常\n";
+    case DecodeError::kFunctionMismatch:
+      LogLine(LogLevel::Error, "hoist_hook").printf(
+          "❌ 功能码不匹配，期望0x%02X，实际0x%02X", static_cast<unsigned>(function_code),
+          static_cast<unsigned>(decoded.function_code));
       return false;
-    }
-    const uint16_t crc_recv = static_cast<uint16_t>(response[payload_end])
-                             | (static_cast<uint16_t>(response[payload_end + 1]) << 8);
-    const uint16_t crc_calc = crc16Modbus(response.data(), payload_end);
-    if (crc_calc != crc_recv) {
-      std::cout << "[hoist_hook] ❌ RTU CRC 校验失败\n";
+    case DecodeError::kLengthMismatch:
+      LogLine(LogLevel::Error, "hoist_hook") << (rtu ? "❌ RTU 响应长度异常" : "❌ 响应长度异常");
       return false;
-    }
-    if (data_len < quantity * 2) {
-      std::cout << "[hoist_hook] ❌ 数据长度不足\n";
+    case DecodeError::kBadCrc:
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ RTU CRC 校验失败";
+      return false;
+    case DecodeError::kShortPayload:
+      LogLine(LogLevel::Error, "hoist_hook") << "❌ 数据长度不足";
       return false;
-    }
-    for (uint16_t i = 0; i < quantity; ++i) {
-      const size_t base = 3 + i * 2;
-      values->push_back(readBe16(&response[base]));
-    }
-    return true;
-  }
-
-  if (response.size() < 9) {
-    std::cout << "[hoist_hook] ❌ 响应报文过短\n";
-    return false;
-  }
-  const uint8_t recv_fc = response[7];
-  if (recv_fc != function_code) {
-    const uint8_t err = response.size() > 8 ? response[8] : 0;
-    std::cout << "[hoist_hook] ❌ 设备返回错误，错误码：0x" << std::hex << std::uppercase
-              << static_cast<int>(err) << std::dec << "\n";
-    return false;
-  }
-  const uint8_t data_len = response[8];
-  if (response.size() < static_cast<size_t>(9 + data_len)) {
-    std::cout << "[hoist_hook] ❌ 响应长度异常\n";
-    return false;
-  }
-  if (data_len < quantity * 2) {
-    std::cout << "[hoist_hook] ❌ 数据长度不足\n";
-    return false;
-  }
-  for (uint16_t i = 0; i < quantity; ++i) {
-    const size_t base = 9 + i * 2;
-    values->push_back(readBe16(&response[base]));
   }
+  values->reserve(quantity);
+  for (uint16_t i = 0; i < quantity; ++i) values->push_back(decoded.registers[i]);
   return true;
 }
 
@@ -637,22 +640,32 @@ void HoistHookCore::printRegisterGroups() const {
   }
 }
 
-void HoistHookCore::genericRead(uint16_t address, uint16_t quantity, int function_code) {
+bool HoistHookCore::readRegisterValues(uint16_t address,
+                                       uint16_t quantity,
+                                       int function_code,
+                                       std::vector<uint16_t>* values,
+                                       std::string* error) {
   if (quantity < 1 || quantity > 125) {
-    std::cout << "[hoist_hook] ❌ 数量超限，读寄存器数量需在1~125\n";
-    return;
+    if (error) *error = "[hoist_hook] ❌ 数量超限，读寄存器数量需在1~125";
+    return false;
   }
   const int fc = (function_code < 0) ? 0x03 : function_code;
   if (fc != 0x03) {
-    std::cout << "[hoist_hook] ❌ 当前仅支持 0x03 读取\n";
-    return;
+    if (error) *error = "[hoist_hook] ❌ 当前仅支持 0x03 读取";
+    return false;
   }
+  ModbusFrame response;
+  if (!sendRead(static_cast<uint8_t>(fc), address, quantity, hook_slave_id_, &response)) return false;
+  return parseRegisterResponse(response, static_cast<uint8_t>(fc), quantity, values);
+}
 
-  std::vector<uint8_t> response;
-  if (!sendRead(static_cast<uint8_t>(fc), address, quantity, hook_slave_id_, &response)) return;
-
+void HoistHookCore::genericRead(uint16_t address, uint16_t quantity, int function_code) {
   std::vector<uint16_t> values;
-  if (!parseRegisterResponse(response, static_cast<uint8_t>(fc), quantity, &values)) return;
+  std::string error;
+  if (!readRegisterValues(address, quantity, function_code, &values, &error)) {
+    if (!error.empty()) std::cout << error << "\n";
+    return;
+  }
 
   if (print_enabled_) {
     std::cout << "✅ 吊钩寄存器读取结果\n";
@@ -678,11 +691,11 @@ void HoistHookCore::genericWrite(uint16_t address, uint16_t value, int function_
   }
 
   bool ok = false;
-  const std::vector<uint8_t> packet =
+  const ModbusFrame packet =
       createModbusPacket(static_cast<uint8_t>(fc), address, value, 0, hook_slave_id_, &ok);
   if (!ok) return;
 
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendModbusPacket(packet, &response, "吊钩写寄存器")) return;
   if (print_enabled_ && !quiet) {
     if (response == packet) {
@@ -740,25 +753,25 @@ void HoistHookCore::controlSpeaker(const std::string& mode, bool quiet) {
 }
 
 void HoistHookCore::syncWarningLightWithSpeaker(bool quiet) {
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendRead(0x03, 0x0001, 2, hook_slave_id_, &response)) {
     if (!quiet) {
-      std::cout << "[hoist_hook] ⚠️ 喇叭-爆闪灯联动失败：读取喇叭状态失败\n";
+      LogLine(LogLevel::Warn, "hoist_hook") << "⚠️ 喇叭-爆闪灯联动失败：读取喇叭状态失败";
     }
     return;
   }
   std::vector<uint16_t> values;
   if (!parseRegisterResponse(response, 0x03, 2, &values) || values.size() < 2) {
     if (!quiet) {
-      std::cout << "[hoist_hook] ⚠️ 喇叭-爆闪灯联动失败：解析喇叭状态失败\n";
+      LogLine(LogLevel::Warn, "hoist_hook") << "⚠️ 喇叭-爆闪灯联动失败：解析喇叭状态失败";
     }
     return;
   }
   const bool any_speaker_on = ((values[0] & 0x0001u) != 0u) || ((values[1] & 0x0001u) != 0u);
   genericWrite(0x0000, any_speaker_on ? 1u : 0u, 0x06, true, true);
   if (!quiet) {
-    std::cout << "[hoist_hook] 🔁 喇叭联动爆闪灯: "
-              << (any_speaker_on ? "开启" : "关闭") << "\n";
+    LogLine(LogLevel::Info, "hoist_hook") << "🔁 喇叭联动爆闪灯: "
+                                          << (any_speaker_on ? "开启" : "关闭");
   }
 }
 
@@ -775,7 +788,7 @@ void HoistHookCore::controlWarningLight(const std::string& status) {
 }
 
 void HoistHookCore::querySpeakerStatus() {
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendRead(0x03, 0x0001, 2, hook_slave_id_, &response)) return;
   std::vector<uint16_t> values;
   if (!parseRegisterResponse(response, 0x03, 2, &values)) return;
@@ -800,7 +813,7 @@ void HoistHookCore::querySpeakerStatus() {
 }
 
 void HoistHookCore::queryLightStatus() {
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendRead(0x03, 0x0000, 1, hook_slave_id_, &response)) return;
   std::vector<uint16_t> values;
   if (!parseRegisterResponse(response, 0x03, 1, &values)) return;
@@ -812,13 +825,13 @@ void HoistHookCore::queryLightStatus() {
 }
 
 void HoistHookCore::queryRfidInfo() {
-  std::vector<uint8_t> mask_resp;
+  ModbusFrame mask_resp;
   if (!sendRead(0x03, 0x0003, 1, hook_slave_id_, &mask_resp)) return;
   std::vector<uint16_t> mask_values;
   if (!parseRegisterResponse(mask_resp, 0x03, 1, &mask_values)) return;
 
   const uint16_t valid_mask = mask_values[0] & 0x00FF;
-  std::vector<uint8_t> group_resp;
+  ModbusFrame group_resp;
   if (!sendRead(0x03, 0x0004, 24, hook_slave_id_, &group_resp)) return;
   std::vector<uint16_t> groups;
   if (!parseRegisterResponse(group_resp, 0x03, 24, &groups)) return;
@@ -858,7 +871,7 @@ void HoistHookCore::queryRfidInfo() {
 
 void HoistHookCore::queryPowerInfo() {
   if (print_enabled_) std::cout << "🔋 正在读取吊钩状态（灯/喇叭/电池/心跳/工作模式）...\n";
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   // 文档：状态寄存器 100~106 在吊钩从站(hook_slave_id)上，地址 0x0064 起共 7 个
   if (!sendRead(0x03, 0x0064, 7, hook_slave_id_, &response)) {
     std::cout << "⚠️ 吊钩状态读取失败，可使用 get 命令手动排查（吊钩从站 " << static_cast<int>(hook_slave_id_)
@@ -894,7 +907,7 @@ void HoistHookCore::queryPowerInfo() {
 }
 
 void HoistHookCore::queryHeartbeat() {
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   // 心跳寄存器：DEC 104 -> 地址 0x0068
   if (!sendRead(0x03, 0x0068, 1, hook_slave_id_, &response)) return;
   std::vector<uint16_t> values;
@@ -903,7 +916,7 @@ void HoistHookCore::queryHeartbeat() {
 }
 
 void HoistHookCore::queryWorkMode() {
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   // 工作模式寄存器：DEC 106 -> 地址 0x006A
   if (!sendRead(0x03, 0x006A, 1, hook_slave_id_, &response)) return;
   std::vector<uint16_t> values;
@@ -920,15 +933,33 @@ bool HoistHookCore::readPowerSummary(PowerSummary* out, double timeout_sec) {
   if (!out) return false;
   *out = PowerSummary{};
 
-  std::vector<uint8_t> response;
-  // 状态寄存器 100~110 在吊钩从站(hook_slave_id)上，地址 0x0064 起共 11 个
-  if (!sendRead(0x03, 0x0064, 11, hook_slave_id_, &response, timeout_sec)) {
-    return false;
-  }
-  std::vector<uint16_t> values;
-  if (!parseRegisterResponse(response, 0x03, 11, &values) || values.size() < 11) {
+  // 状态寄存器在吊钩从站(hook_slave_id)上，只规划实际用到的 102、105、107~110，
+  // values 仍按 0x0064 起的偏移存放
+  using ai_safety_controller::common::ModbusReadPlan;
+  ModbusReadPlan plan(read_gap_tolerance_);
+  plan.add(hook_slave_id_, 0x03, 0x0066, 1);
+  plan.add(hook_slave_id_, 0x03, 0x0069, 1);
+  plan.add(hook_slave_id_, 0x03, 0x006B, 4);
+  const std::size_t failed =
+      plan.execute([&](const ModbusReadPlan::Block& b, std::vector<uint16_t>* block_values) {
+        ModbusFrame response;
+        if (!sendRead(b.function_code, b.address, b.quantity, b.unit_id, &response, timeout_sec)) {
+          return ModbusReadPlan::ReadStatus::kFailed;
+        }
+        uint8_t exception_code = 0;
+        const bool ok =
+            parseRegisterResponse(response, b.function_code, b.quantity, block_values, &exception_code);
+        return ModbusReadPlan::readStatus(ok, exception_code);
+      });
+  if (failed != 0) {
     return false;
   }
+  std::vector<uint16_t> values(11, 0);
+  std::vector<uint16_t> tail;
+  plan.value(hook_slave_id_, 0x03, 0x0066, &values[2]);
+  plan.value(hook_slave_id_, 0x03, 0x0069, &values[5]);
+  plan.values(hook_slave_id_, 0x03, 0x006B, 4, &tail);
+  std::copy(tail.begin(), tail.end(), values.begin() + 7);
 
   const uint16_t battery_raw = values[2];   // 102: 电池电量 0~10000 -> 0~100%
   const uint16_t remain_min = values[5];    // 105: 剩余放电时间(分钟)
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+
 #include <cstdint>
 #include <chrono>
 #include <mutex>
@@ -28,33 +31,51 @@ class IoRelayCore {
               const RetryPolicy& retry_policy);
   ~IoRelayCore();
 
+  /** 运行中替换重试策略，下一次请求生效 */
+  void setRetryPolicy(const RetryPolicy& retry_policy);
+
   bool controlRelay(int relay_num, const std::string& status);
   bool readRelayStatus(int relay_num);  // relay_num <= 0 means read all
   bool getRelayState(int relay_num, bool* on);
 
+  /** 16 路输出映像（bit0 = 第1路）；缓存不超过 max_age 时直接返回，否则一次 FC01 读全部 16 路刷新 */
+  bool getRelayImage(uint16_t* image,
+                     std::chrono::milliseconds max_age = std::chrono::milliseconds(0));
+  /** mask 内各路（bit0 = 第1路）同时置 on/off：每段连续通道一条 FC0F，mask 外的通道不动；写后一次 FC01 回读校验 */
+  bool controlRelays(uint16_t mask, bool on);
+
+  /** "1,2,5" 形式的通道列表转为 mask，通道须在 1-16 */
+  static bool parseRelayMask(const std::string& channels, uint16_t* mask);
+
  private:
+  RetryPolicy retryPolicy() const;
   void waitForStartupStableWindow();
-  std::vector<uint8_t> createModbusPacket(uint8_t function_code,
-                                          uint16_t address,
-                                          uint16_t value,
-                                          uint16_t quantity,
-                                          uint8_t unit_id,
-                                          bool* ok);
-  bool sendModbusPacket(const std::vector<uint8_t>& packet,
-                        std::vector<uint8_t>* response,
-                        const std::string& context,
+  ai_safety_controller::common::ModbusFrame createModbusPacket(uint8_t function_code,
+                                                               uint16_t address,
+                                                               uint16_t value,
+                                                               uint16_t quantity,
+                                                               uint8_t unit_id,
+                                                               bool* ok);
+  bool sendModbusPacket(const ai_safety_controller::common::ModbusFrame& packet,
+                        ai_safety_controller::common::ModbusFrame* response,
+                        const ai_safety_controller::common::LazyContext& context,
                         double timeout_sec = 5.0);
   bool ensureConnectionLocked(double timeout_sec);
+  void releaseConnectionLocked();
   void disconnectLocked();
-  bool sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                            std::vector<uint8_t>* response,
-                            const std::string& context);
-  bool parseReadCoilsResponse(const std::vector<uint8_t>& response,
+  bool sendAndReceiveLocked(const ai_safety_controller::common::ModbusFrame& packet,
+                            ai_safety_controller::common::ModbusFrame* response,
+                            const ai_safety_controller::common::LazyContext& context,
+                            double timeout_sec,
+                            ai_safety_controller::common::TransactionProbe* probe);
+  bool parseReadCoilsResponse(const ai_safety_controller::common::ModbusFrame& response,
                               int expected_count,
                               std::vector<bool>* states);
   bool readRelayStates(int relay_num, std::vector<bool>* states);
   bool readSingleRelayState(int relay_num, bool* on);
   bool parseRelayNum(int relay_num, uint16_t* coil_addr) const;
+  void updateRelayImage(uint16_t mask, uint16_t bits);
+  void invalidateRelayImage(uint16_t mask);
 
   const std::string module_ip_;
   const uint16_t module_port_;
@@ -62,8 +83,14 @@ class IoRelayCore {
   uint16_t transaction_id_;
   int socket_fd_;
   RetryPolicy retry_policy_;
+  mutable std::mutex retry_policy_mutex_;
   std::mutex socket_mutex_;
   std::chrono::steady_clock::time_point startup_stable_after_;
+  // Last known coil states; relay_image_known_ marks the bits actually read or written.
+  std::mutex relay_image_mutex_;
+  uint16_t relay_image_ = 0;
+  uint16_t relay_image_known_ = 0;
+  std::chrono::steady_clock::time_point relay_image_updated_{};
 };
 
 }  // namespace io_relay
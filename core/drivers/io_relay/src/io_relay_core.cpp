@@ -1,5 +1,9 @@
 #include "io_relay/io_relay_core.hpp"
 #include "ai_safety_controller/common/gateway_serial.hpp"
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pipeline.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pool.hpp"
+#include "ai_safety_controller/common/modbus_tcp_receiver.hpp"
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -9,8 +13,10 @@
 #include <algorithm>
 #include <cerrno>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <optional>
 #include <random>
 #include <thread>
 
@@ -18,6 +24,11 @@ namespace io_relay {
 
 namespace {
 
+using ai_safety_controller::common::LazyContext;
+using ai_safety_controller::common::LogLevel;
+using ai_safety_controller::common::LogLine;
+using ai_safety_controller::common::ModbusFrame;
+
 constexpr int kStartupStableDelayMs = 500;
 constexpr int kWriteVerifyDelayMs = 100;
 constexpr int kWriteVerifyRetries = 2;
@@ -63,7 +74,7 @@ IoRelayCore::IoRelayCore(const std::string& module_ip,
 
 IoRelayCore::~IoRelayCore() {
   std::lock_guard<std::mutex> lock(socket_mutex_);
-  disconnectLocked();
+  releaseConnectionLocked();
 }
 
 bool IoRelayCore::parseRelayNum(int relay_num, uint16_t* coil_addr) const {
@@ -82,75 +93,124 @@ void IoRelayCore::waitForStartupStableWindow() {
   }
 }
 
-std::vector<uint8_t> IoRelayCore::createModbusPacket(uint8_t function_code,
-                                                     uint16_t address,
-                                                     uint16_t value,
-                                                     uint16_t quantity,
-                                                     uint8_t unit_id,
-                                                     bool* ok) {
+ModbusFrame IoRelayCore::createModbusPacket(uint8_t function_code,
+                                            uint16_t address,
+                                            uint16_t value,
+                                            uint16_t quantity,
+                                            uint8_t unit_id,
+                                            bool* ok) {
   if (ok) *ok = false;
-  if (!(function_code == 0x01 || function_code == 0x05)) {
-    std::cout << "[io_relay] ❌ 不支持的功能码\n";
+  if (!(function_code == 0x01 || function_code == 0x05 || function_code == 0x0F)) {
+    LogLine(LogLevel::Error, "io_relay") << "❌ 不支持的功能码";
     return {};
   }
 
   transaction_id_ = static_cast<uint16_t>((transaction_id_ + 1) & 0xFFFF);
-  const uint16_t protocol_id = 0x0000;
-  const uint16_t length = 6;
-
-  std::vector<uint8_t> pkt;
-  pkt.reserve(12);
-  pkt.push_back(static_cast<uint8_t>((transaction_id_ >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(transaction_id_ & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((protocol_id >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(protocol_id & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((length >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(length & 0xFF));
-  pkt.push_back(unit_id);
-  pkt.push_back(function_code);
-  pkt.push_back(static_cast<uint8_t>((address >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(address & 0xFF));
 
+  ModbusFrame pkt;
+  if (function_code == 0x0F) {
+    // value carries the coil bits, quantity the number of coils.
+    if (!ai_safety_controller::common::encodeMbapWriteCoils(
+            &pkt, transaction_id_, unit_id, address, quantity, value)) {
+      LogLine(LogLevel::Error, "io_relay") << "❌ FC0F 线圈数量异常: " << quantity;
+      return {};
+    }
+    if (ok) *ok = true;
+    return pkt;
+  }
   const uint16_t data = (function_code == 0x05) ? value : quantity;
-  pkt.push_back(static_cast<uint8_t>((data >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(data & 0xFF));
+  ai_safety_controller::common::encodeMbapRequest(
+      &pkt, transaction_id_, unit_id, function_code, address, data);
   if (ok) *ok = true;
   return pkt;
 }
 
-bool IoRelayCore::sendModbusPacket(const std::vector<uint8_t>& packet,
-                                   std::vector<uint8_t>* response,
-                                   const std::string& context,
+void IoRelayCore::updateRelayImage(uint16_t mask, uint16_t bits) {
+  std::lock_guard<std::mutex> lock(relay_image_mutex_);
+  relay_image_ = static_cast<uint16_t>((relay_image_ & ~mask) | (bits & mask));
+  relay_image_known_ = static_cast<uint16_t>(relay_image_known_ | mask);
+  // Only a read of all 16 coils counts as a fresh image.
+  if (mask == 0xFFFF) relay_image_updated_ = std::chrono::steady_clock::now();
+}
+
+void IoRelayCore::invalidateRelayImage(uint16_t mask) {
+  std::lock_guard<std::mutex> lock(relay_image_mutex_);
+  relay_image_known_ = static_cast<uint16_t>(relay_image_known_ & ~mask);
+}
+
+void IoRelayCore::setRetryPolicy(const RetryPolicy& retry_policy) {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  retry_policy_ = retry_policy;
+}
+
+IoRelayCore::RetryPolicy IoRelayCore::retryPolicy() const {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  return retry_policy_;
+}
+
+bool IoRelayCore::sendModbusPacket(const ModbusFrame& packet,
+                                   ModbusFrame* response,
+                                   const LazyContext& context,
                                    double timeout_sec) {
   if (!response) return false;
   response->clear();
-  const std::string endpoint_key = module_ip_ + ":" + std::to_string(module_port_);
-  ai_safety_controller::common::GatewaySerialGuard serial_guard(endpoint_key, 120);
-  std::lock_guard<std::mutex> lock(socket_mutex_);
-  const int max_retries = std::max(0, retry_policy_.max_retries);
+  const std::string endpoint_key =
+      ai_safety_controller::common::ModbusTcpConnectionPool::endpointKey(module_ip_, module_port_);
+  // Pipelined gateways queue transactions themselves; everything else stays
+  // strictly serial behind the per-endpoint scheduler.
+  auto& pipeline = ai_safety_controller::common::ModbusTcpPipeline::instance();
+  const bool pipelined = pipeline.enabled(module_ip_, module_port_);
+  const std::uint8_t function_code = packet.size() > 7 ? packet[7] : 0;
+  ai_safety_controller::common::TransactionProbe probe(endpoint_key, function_code);
+  std::optional<ai_safety_controller::common::GatewaySerialGuard> serial_guard;
+  std::unique_lock<std::mutex> lock(socket_mutex_, std::defer_lock);
+  if (!pipelined) {
+    serial_guard.emplace(endpoint_key, 120, ai_safety_controller::common::busPriorityFor(function_code));
+    lock.lock();
+  }
+  probe.acquired();
+  const RetryPolicy policy = retryPolicy();
+  const int max_retries = std::max(0, policy.max_retries);
   for (int attempt = 0; attempt <= max_retries; ++attempt) {
     if (attempt > 0) {
-      const int delay_ms = computeRetryDelayMs(retry_policy_, attempt);
+      probe.retry();
+      const int delay_ms = computeRetryDelayMs(policy, attempt);
       if (delay_ms > 0) {
-        if (retry_policy_.log_enabled) {
-          std::cout << "[io_relay] ⚠️ 第" << attempt << "/" << max_retries
-                    << "次重试，退避" << delay_ms << "ms: " << context << "\n";
+        if (policy.log_enabled) {
+          LogLine(LogLevel::Warn, "io_relay") << "⚠️ 第" << attempt << "/" << max_retries
+                                              << "次重试，退避" << delay_ms << "ms: " << context;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
       }
     }
+    if (pipelined) {
+      std::string error;
+      bool timed_out = false;
+      probe.beginExchange();
+      if (pipeline.exchange(module_ip_, module_port_, packet, response, timeout_sec, &error, &timed_out)) {
+        probe.endExchange(packet.size(), response->size());
+        probe.finish(true);
+        return true;
+      }
+      if (timed_out) probe.timeout();
+      LogLine(LogLevel::Error, "io_relay") << "❌ " << error << ": " << context;
+      continue;
+    }
+    probe.beginConnect();
     if (!ensureConnectionLocked(timeout_sec)) {
       disconnectLocked();
       continue;
     }
-    if (sendAndReceiveLocked(packet, response, context)) {
-      disconnectLocked();
+    probe.endConnect();
+    if (sendAndReceiveLocked(packet, response, context, timeout_sec, &probe)) {
+      releaseConnectionLocked();
+      probe.finish(true);
       return true;
     }
     disconnectLocked();
   }
-  if (retry_policy_.log_enabled) {
-    std::cout << "[io_relay] ❌ 重试耗尽，操作失败: " << context << "\n";
+  if (policy.log_enabled) {
+    LogLine(LogLevel::Error, "io_relay") << "❌ 重试耗尽，操作失败: " << context;
   }
   return false;
 }
@@ -158,77 +218,75 @@ bool IoRelayCore::sendModbusPacket(const std::vector<uint8_t>& packet,
 bool IoRelayCore::ensureConnectionLocked(double timeout_sec) {
   if (socket_fd_ >= 0) return true;
 
-  socket_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  std::string error;
+  socket_fd_ = ai_safety_controller::common::ModbusTcpConnectionPool::instance().acquire(
+      module_ip_, module_port_, timeout_sec, &error);
   if (socket_fd_ < 0) {
-    std::cout << "[io_relay] ❌ socket 创建失败: " << std::strerror(errno) << "\n";
-    return false;
-  }
-
-  timeval tv{};
-  tv.tv_sec = static_cast<int>(timeout_sec);
-  tv.tv_usec = static_cast<int>((timeout_sec - tv.tv_sec) * 1000000.0);
-  ::setsockopt(socket_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-  ::setsockopt(socket_fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-  sockaddr_in addr{};
-  addr.sin_family = AF_INET;
-  addr.sin_port = htons(module_port_);
-  if (::inet_pton(AF_INET, module_ip_.c_str(), &addr.sin_addr) != 1) {
-    std::cout << "[io_relay] ❌ 模块IP无效: " << module_ip_ << "\n";
-    disconnectLocked();
-    return false;
-  }
-  if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
-    std::cout << "[io_relay] ❌ 连接失败: " << std::strerror(errno) << "\n";
-    disconnectLocked();
+    LogLine(LogLevel::Error, "io_relay") << "❌ " << error;
     return false;
   }
   return true;
 }
 
+void IoRelayCore::releaseConnectionLocked() {
+  ai_safety_controller::common::ModbusTcpConnectionPool::instance().release(
+      module_ip_, module_port_, socket_fd_);
+  socket_fd_ = -1;
+}
+
 void IoRelayCore::disconnectLocked() {
   if (socket_fd_ >= 0) {
-    ::close(socket_fd_);
+    ai_safety_controller::common::ModbusTcpConnectionPool::instance().discard(socket_fd_);
     socket_fd_ = -1;
   }
 }
 
-bool IoRelayCore::sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                                       std::vector<uint8_t>* response,
-                                       const std::string& context) {
+bool IoRelayCore::sendAndReceiveLocked(const ModbusFrame& packet,
+                                       ModbusFrame* response,
+                                       const LazyContext& context,
+                                       double timeout_sec,
+                                       ai_safety_controller::common::TransactionProbe* probe) {
+  probe->beginExchange();
   if (::send(socket_fd_, packet.data(), packet.size(), 0) < 0) {
-    std::cout << "[io_relay] ❌ 发送失败: " << std::strerror(errno) << "\n";
+    LogLine(LogLevel::Error, "io_relay") << "❌ 发送失败: " << std::strerror(errno);
     return false;
   }
-  uint8_t buf[256];
-  const ssize_t n = ::recv(socket_fd_, buf, sizeof(buf), 0);
-  if (n <= 0) {
-    std::cout << "[io_relay] ❌ 无响应: " << context << "\n";
+  namespace mb = ai_safety_controller::common;
+  int stale = 0;
+  const mb::MbapReceiveStatus rx = mb::receiveMbapResponse(
+      socket_fd_, mb::readBe16(packet.data()), mb::deadlineAfter(timeout_sec), response, &stale);
+  if (stale > 0) {
+    LogLine(LogLevel::Warn, "io_relay") << "⚠️ 丢弃" << stale << "个过期响应帧: " << context;
+  }
+  if (rx != mb::MbapReceiveStatus::kOk) {
+    if (rx == mb::MbapReceiveStatus::kTimeout) probe->timeout();
+    probe->sent(packet.size());
+    LogLine(LogLevel::Error, "io_relay") << "❌ 无响应(" << mb::mbapReceiveStatusName(rx) << "): " << context;
     return false;
   }
-  response->assign(buf, buf + n);
+  probe->endExchange(packet.size(), response->size());
   return true;
 }
 
-bool IoRelayCore::parseReadCoilsResponse(const std::vector<uint8_t>& response,
+bool IoRelayCore::parseReadCoilsResponse(const ModbusFrame& response,
                                          int expected_count,
                                          std::vector<bool>* states) {
   if (!states) return false;
   states->clear();
   if (expected_count <= 0) return false;
   if (response.size() < 10) {
-    std::cout << "[io_relay] ❌ 继电器状态响应长度异常\n";
+    LogLine(LogLevel::Error, "io_relay") << "❌ 继电器状态响应长度异常";
     return false;
   }
   if (response[7] != 0x01) {
-    std::cout << "[io_relay] ❌ 继电器读取功能码异常: 0x" << std::hex << static_cast<int>(response[7])
-              << std::dec << "\n";
+    LogLine(LogLevel::Error, "io_relay").printf(
+        "❌ 继电器读取功能码异常: 0x%x", static_cast<unsigned>(response[7]));
     return false;
   }
 
   const uint8_t byte_count = response[8];
   if (response.size() < static_cast<size_t>(9 + byte_count)) {
-    std::cout << "[io_relay] ❌ 继电器状态数据长度异常\n";
+    LogLine(LogLevel::Error, "io_relay") << "❌ 继电器状态数据长度异常";
     return false;
   }
 
@@ -237,7 +295,7 @@ bool IoRelayCore::parseReadCoilsResponse(const std::vector<uint8_t>& response,
     const int byte_idx = i / 8;
     const int bit_idx = i % 8;
     if (byte_idx >= byte_count) {
-      std::cout << "[io_relay] ❌ 继电器状态字节数不足，期望通道数=" << expected_count << "\n";
+      LogLine(LogLevel::Error, "io_relay") << "❌ 继电器状态字节数不足，期望通道数=" << expected_count;
       states->clear();
       return false;
     }
@@ -251,7 +309,7 @@ bool IoRelayCore::readRelayStates(int relay_num, std::vector<bool>* states) {
   waitForStartupStableWindow();
 
   bool ok = false;
-  std::vector<uint8_t> packet;
+  ModbusFrame packet;
   int expected_count = 0;
   if (relay_num > 0) {
     uint16_t addr = 0;
@@ -267,9 +325,21 @@ bool IoRelayCore::readRelayStates(int relay_num, std::vector<bool>* states) {
   }
   if (!ok) return false;
 
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendModbusPacket(packet, &response, "继电器状态读取")) return false;
-  return parseReadCoilsResponse(response, expected_count, states);
+  if (!parseReadCoilsResponse(response, expected_count, states)) return false;
+
+  uint16_t bits = 0;
+  for (size_t i = 0; i < states->size(); ++i) {
+    if ((*states)[i]) bits = static_cast<uint16_t>(bits | (1u << i));
+  }
+  if (relay_num > 0) {
+    const int shift = relay_num - 1;
+    updateRelayImage(static_cast<uint16_t>(1u << shift), static_cast<uint16_t>(bits << shift));
+  } else {
+    updateRelayImage(0xFFFF, bits);
+  }
+  return true;
 }
 
 bool IoRelayCore::readSingleRelayState(int relay_num, bool* on) {
@@ -294,12 +364,16 @@ bool IoRelayCore::controlRelay(int relay_num, const std::string& status) {
 
   const uint16_t value = (status == "on") ? 0xFF00 : 0x0000;
   bool ok = false;
-  const std::vector<uint8_t> packet =
+  const ModbusFrame packet =
       createModbusPacket(0x05, coil_addr, value, 0, module_slave_id_, &ok);
   if (!ok) return false;
 
-  std::vector<uint8_t> response;
-  if (!sendModbusPacket(packet, &response, "继电器控制")) return false;
+  const uint16_t relay_bit = static_cast<uint16_t>(1u << coil_addr);
+  ModbusFrame response;
+  if (!sendModbusPacket(packet, &response, "继电器控制")) {
+    invalidateRelayImage(relay_bit);
+    return false;
+  }
 
   if (response == packet) {
     const bool target_on = (status == "on");
@@ -307,30 +381,99 @@ bool IoRelayCore::controlRelay(int relay_num, const std::string& status) {
       std::this_thread::sleep_for(std::chrono::milliseconds(kWriteVerifyDelayMs));
       bool readback_on = false;
       if (!readSingleRelayState(relay_num, &readback_on)) {
-        std::cout << "[io_relay] ⚠️ 第" << relay_num << "路继电器写后回读失败，第"
-                  << (verify_attempt + 1) << "/" << (kWriteVerifyRetries + 1) << "次校验\n";
+        LogLine(LogLevel::Warn, "io_relay") << "⚠️ 第" << relay_num << "路继电器写后回读失败，第"
+                                            << (verify_attempt + 1) << "/"
+                                            << (kWriteVerifyRetries + 1) << "次校验";
         continue;
       }
       if (readback_on == target_on) {
-        std::cout << "[io_relay] ✅ 第" << relay_num << "路继电器写入目标="
-                  << (target_on ? "on" : "off") << "，FC01读回="
-                  << (readback_on ? "on" : "off") << "\n";
+        LogLine(LogLevel::Info, "io_relay") << "✅ 第" << relay_num << "路继电器写入目标="
+                                            << (target_on ? "on" : "off") << "，FC01读回="
+                                            << (readback_on ? "on" : "off");
         return true;
       }
-      std::cout << "[io_relay] ⚠️ 第" << relay_num << "路继电器写入目标="
-                << (target_on ? "on" : "off") << "，但FC01读回="
-                << (readback_on ? "on" : "off")
-                << "，第" << (verify_attempt + 1) << "/" << (kWriteVerifyRetries + 1)
-                << "次校验不一致\n";
+      LogLine(LogLevel::Warn, "io_relay") << "⚠️ 第" << relay_num << "路继电器写入目标="
+                                          << (target_on ? "on" : "off") << "，但FC01读回="
+                                          << (readback_on ? "on" : "off")
+                                          << "，第" << (verify_attempt + 1) << "/"
+                                          << (kWriteVerifyRetries + 1) << "次校验不一致";
     }
-    std::cout << "[io_relay] ❌ 第" << relay_num << "路继电器写入后FC01回读始终不一致\n";
+    LogLine(LogLevel::Error, "io_relay") << "❌ 第" << relay_num << "路继电器写入后FC01回读始终不一致";
     return false;
   } else {
-    std::cout << "[io_relay] ⚠️ 模块应答异常，响应长度=" << response.size() << "\n";
+    invalidateRelayImage(relay_bit);
+    LogLine(LogLevel::Warn, "io_relay") << "⚠️ 模块应答异常，响应长度=" << response.size();
     return false;
   }
 }
 
+bool IoRelayCore::controlRelays(uint16_t mask, bool on) {
+  if (mask == 0) {
+    std::cout << "[io_relay] ❌ 未指定继电器通道\n";
+    return false;
+  }
+  waitForStartupStableWindow();
+
+  // One FC0F per run of adjacent channels, so coils outside the mask are
+  // never rewritten from a possibly stale image.
+  for (int start = 0; start < 16;) {
+    if (((mask >> start) & 0x1) == 0) {
+      ++start;
+      continue;
+    }
+    int end = start;
+    while (end < 16 && ((mask >> end) & 0x1) != 0) ++end;
+    const uint16_t quantity = static_cast<uint16_t>(end - start);
+    bool ok = false;
+    const ModbusFrame packet = createModbusPacket(
+        0x0F, static_cast<uint16_t>(start), on ? 0xFFFF : 0x0000, quantity, module_slave_id_, &ok);
+    if (!ok) return false;
+    ModbusFrame response;
+    if (!sendModbusPacket(packet, &response, "继电器批量控制")) {
+      invalidateRelayImage(mask);
+      return false;
+    }
+    // Reply echoes address and quantity: MBAP(7) + fc + address(2) + quantity(2).
+    if (response.size() < 12 || response[7] != 0x0F ||
+        ai_safety_controller::common::readBe16(response.data() + 8) != start ||
+        ai_safety_controller::common::readBe16(response.data() + 10) != quantity) {
+      invalidateRelayImage(mask);
+      LogLine(LogLevel::Warn, "io_relay") << "⚠️ FC0F 应答异常，响应长度=" << response.size();
+      return false;
+    }
+    start = end;
+  }
+
+  const uint16_t target = on ? mask : 0;
+  for (int verify_attempt = 0; verify_attempt <= kWriteVerifyRetries; ++verify_attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kWriteVerifyDelayMs));
+    std::vector<bool> states;
+    if (!readRelayStates(0, &states)) {
+      LogLine(LogLevel::Warn, "io_relay").printf(
+          "⚠️ 继电器批量写后回读失败(mask=0x%04x)，第%d/%d次校验", static_cast<unsigned>(mask),
+          verify_attempt + 1, kWriteVerifyRetries + 1);
+      continue;
+    }
+    uint16_t readback = 0;
+    for (size_t i = 0; i < states.size(); ++i) {
+      if (states[i]) readback = static_cast<uint16_t>(readback | (1u << i));
+    }
+    if ((readback & mask) == target) {
+      LogLine(LogLevel::Info, "io_relay").printf(
+          "✅ 继电器批量写入 mask=0x%04x 目标=%s，FC01读回一致", static_cast<unsigned>(mask),
+          on ? "on" : "off");
+      return true;
+    }
+    LogLine(LogLevel::Warn, "io_relay").printf(
+        "⚠️ 继电器批量写入 mask=0x%04x 目标=%s，但FC01读回=0x%04x，第%d/%d次校验不一致",
+        static_cast<unsigned>(mask), on ? "on" : "off", static_cast<unsigned>(readback & mask),
+        verify_attempt + 1, kWriteVerifyRetries + 1);
+  }
+  LogLine(LogLevel::Error, "io_relay").printf(
+      "❌ 继电器批量写入 mask=0x%04x 后FC01回读始终不一致", static_cast<unsigned>(mask));
+  return false;
+}
+
 bool IoRelayCore::readRelayStatus(int relay_num) {
   std::vector<bool> states;
   if (!readRelayStates(relay_num, &states)) return false;
@@ -353,4 +496,38 @@ bool IoRelayCore::getRelayState(int relay_num, bool* on) {
   return readSingleRelayState(relay_num, on);
 }
 
+bool IoRelayCore::getRelayImage(uint16_t* image, std::chrono::milliseconds max_age) {
+  if (!image) return false;
+  {
+    std::lock_guard<std::mutex> lock(relay_image_mutex_);
+    if (relay_image_known_ == 0xFFFF &&
+        std::chrono::steady_clock::now() - relay_image_updated_ <= max_age) {
+      *image = relay_image_;
+      return true;
+    }
+  }
+  std::vector<bool> states;
+  if (!readRelayStates(0, &states)) return false;
+  std::lock_guard<std::mutex> lock(relay_image_mutex_);
+  *image = relay_image_;
+  return true;
+}
+
+bool IoRelayCore::parseRelayMask(const std::string& channels, uint16_t* mask) {
+  if (!mask || channels.empty()) return false;
+  uint16_t bits = 0;
+  size_t pos = 0;
+  while (pos <= channels.size()) {
+    const size_t comma = std::min(channels.find(',', pos), channels.size());
+    const std::string item = channels.substr(pos, comma - pos);
+    char* end = nullptr;
+    const long ch = std::strtol(item.c_str(), &end, 10);
+    if (item.empty() || !end || *end != '\0' || ch < 1 || ch > 16) return false;
+    bits = static_cast<uint16_t>(bits | (1u << (ch - 1)));
+    pos = comma + 1;
+  }
+  *mask = bits;
+  return true;
+}
+
 }  // namespace io_relay
@@ -42,6 +42,16 @@ class MultiTurnEncoderCore {
   bool isConnected() const;
   bool isRunning() const;
   void setLinearTransform(bool enable, double k, double b);
+  /**
+   * 采样策略，需在 run() 之前设置：
+   * on_demand=false 按 sample_hz 定频采样；on_demand=true 仅在 getLatest() 调用时触发一次采样，
+   * 同样受 sample_hz 限速。getLatest() 不等待本次采样，返回的是最近一次已发布的结果。
+   */
+  void setAcquisition(bool on_demand, double sample_hz);
+  /**
+   * 速度估计：对最近 window 个滤波后样本做最小二乘斜率，累计 warmup 个样本后即输出，需在 run() 之前设置。
+   */
+  void setVelocityWindow(int window, int warmup);
   LatestData getLatest() const;
 
  private:
@@ -51,6 +61,7 @@ class MultiTurnEncoderCore {
   bool linear_enable_;
   double linear_k_;
   double linear_b_;
+  bool on_demand_;
   Transport transport_;
 };
 
@@ -1,5 +1,6 @@
 #include "multi_turn_encoder/multi_turn_encoder_core.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace multi_turn_encoder {
@@ -15,6 +16,7 @@ MultiTurnEncoderCore::MultiTurnEncoderCore(const std::string& device,
       linear_enable_(false),
       linear_k_(1.0),
       linear_b_(0.0),
+      on_demand_(false),
       transport_(Transport::RTU) {}
 
 MultiTurnEncoderCore::MultiTurnEncoderCore(const std::string& ip, int port, int slave)
@@ -23,6 +25,7 @@ MultiTurnEncoderCore::MultiTurnEncoderCore(const std::string& ip, int port, int
       linear_enable_(false),
       linear_k_(1.0),
       linear_b_(0.0),
+      on_demand_(false),
       transport_(Transport::TCP) {}
 
 MultiTurnEncoderCore::~MultiTurnEncoderCore() {
@@ -68,6 +71,22 @@ void MultiTurnEncoderCore::setLinearTransform(bool enable, double k, double b) {
   linear_b_ = b;
 }
 
+void MultiTurnEncoderCore::setAcquisition(bool on_demand, double sample_hz) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  on_demand_ = on_demand;
+  if (!encoder_) return;
+  encoder_->setAcquisitionMode(on_demand ? MultiTurnEncoderRTU::AcquisitionMode::ON_DEMAND
+                                         : MultiTurnEncoderRTU::AcquisitionMode::FIXED_RATE,
+                               sample_hz);
+}
+
+void MultiTurnEncoderCore::setVelocityWindow(int window, int warmup) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!encoder_ || running_) return;
+  encoder_->setVelocityWindow(static_cast<size_t>(std::max(window, 0)),
+                              static_cast<size_t>(std::max(warmup, 0)));
+}
+
 MultiTurnEncoderCore::LatestData MultiTurnEncoderCore::getLatest() const {
   LatestData out{};
   out.valid = false;
@@ -85,12 +104,15 @@ MultiTurnEncoderCore::LatestData MultiTurnEncoderCore::getLatest() const {
   bool linear_enable = false;
   double linear_k = 1.0;
   double linear_b = 0.0;
+  bool on_demand = false;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     linear_enable = linear_enable_;
     linear_k = linear_k_;
     linear_b = linear_b_;
+    on_demand = on_demand_;
   }
+  if (on_demand) encoder_->requestSample();
   out.turns_calibrated = linear_enable ? (linear_k * out.turns_raw + linear_b) : out.turns_raw;
   out.velocity = enc.velocity;
 
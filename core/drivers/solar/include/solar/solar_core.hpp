@@ -1,5 +1,9 @@
 #pragma once
 
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/transaction_metrics.hpp"
+
+#include <atomic>
 #include <cstdint>
 #include <mutex>
 #include <string>
@@ -38,10 +42,22 @@ class SolarCore {
   void printRegisterGroups() const;
   void querySolarInfo(const std::string& info_type);
   void setChargeSampleTimeoutSec(double timeout_sec);
+  void setReadGapTolerance(int registers);
+  /** 运行中替换重试策略，下一次请求生效 */
+  void setRetryPolicy(const RetryPolicy& retry_policy);
   bool readChargeStatusSample(ChargeStatusSample* out);
   static bool hasChargeFault(uint16_t charge_status_word);
   void scanSolarSlaveIds(int start_id, int end_id);
   void genericRead(uint16_t address, uint16_t quantity, int function_code);
+  /**
+   * 读取连续寄存器并返回原始值，不打印；function_code<0 时使用默认功能码。
+   * 参数非法时 error 给出原因；通信失败时 error 为空（驱动已记录日志）。
+   */
+  bool readRegisterValues(uint16_t address,
+                          uint16_t quantity,
+                          int function_code,
+                          std::vector<uint16_t>* values,
+                          std::string* error = nullptr);
   void genericWrite(uint16_t address, uint16_t value, int function_code);
 
   static bool parseNumber(const std::string& text, int* out);
@@ -50,6 +66,7 @@ class SolarCore {
                                 int* out);
 
  private:
+  RetryPolicy retryPolicy() const;
   struct RegisterGroup {
     uint16_t start;
     uint16_t end;
@@ -57,31 +74,42 @@ class SolarCore {
     std::string desc;
   };
 
-  std::vector<uint8_t> createModbusPacket(uint8_t function_code,
-                                          uint16_t address,
-                                          uint16_t value,
-                                          uint16_t quantity,
-                                          uint8_t unit_id,
-                                          bool* ok);
-  bool sendModbusPacket(const std::vector<uint8_t>& packet,
-                        std::vector<uint8_t>* response,
-                        const std::string& context,
+  ai_safety_controller::common::ModbusFrame createModbusPacket(uint8_t function_code,
+                                                               uint16_t address,
+                                                               uint16_t value,
+                                                               uint16_t quantity,
+                                                               uint8_t unit_id,
+                                                               bool* ok);
+  bool sendModbusPacket(const ai_safety_controller::common::ModbusFrame& packet,
+                        ai_safety_controller::common::ModbusFrame* response,
+                        const ai_safety_controller::common::LazyContext& context,
                         double timeout_sec = 5.0);
   bool sendSolarRead(uint8_t function_code,
                      uint16_t address,
                      uint16_t quantity,
                      uint8_t unit_id,
-                     std::vector<uint8_t>* response,
+                     ai_safety_controller::common::ModbusFrame* response,
                      double timeout_sec = 5.0);
-  bool parseRegisterResponse(const std::vector<uint8_t>& response,
+  bool readRegisters(uint8_t function_code,
+                     uint16_t address,
+                     uint16_t quantity,
+                     uint8_t unit_id,
+                     std::vector<uint16_t>* values,
+                     double timeout_sec,
+                     uint8_t* exception_code = nullptr);
+  bool parseRegisterResponse(const ai_safety_controller::common::ModbusFrame& response,
                              uint8_t function_code,
                              uint16_t quantity,
-                             std::vector<uint16_t>* values) const;
+                             std::vector<uint16_t>* values,
+                             uint8_t* exception_code = nullptr) const;
   bool ensureConnectionLocked(double timeout_sec);
+  void releaseConnectionLocked();
   void disconnectLocked();
-  bool sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                            std::vector<uint8_t>* response,
-                            const std::string& context);
+  bool sendAndReceiveLocked(const ai_safety_controller::common::ModbusFrame& packet,
+                            ai_safety_controller::common::ModbusFrame* response,
+                            const ai_safety_controller::common::LazyContext& context,
+                            double timeout_sec,
+                            ai_safety_controller::common::TransactionProbe* probe);
   bool confirmRiskyWrite(uint16_t addr) const;
   std::string describeSolarRegister(uint16_t addr) const;
   int32_t parseSigned32FromLH(uint16_t low_word, uint16_t high_word) const;
@@ -93,7 +121,9 @@ class SolarCore {
   uint16_t transaction_id_;
   int socket_fd_;
   RetryPolicy retry_policy_;
+  mutable std::mutex retry_policy_mutex_;
   double charge_sample_timeout_sec_ = 5.0;
+  std::atomic<uint16_t> read_gap_tolerance_{4};
   std::mutex socket_mutex_;
   std::vector<RegisterGroup> register_groups_;
 };
@@ -1,5 +1,10 @@
 #include "solar/solar_core.hpp"
 #include "ai_safety_controller/common/gateway_serial.hpp"
+#include "ai_safety_controller/common/modbus_frame.hpp"
+#include "ai_safety_controller/common/modbus_read_plan.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pipeline.hpp"
+#include "ai_safety_controller/common/modbus_tcp_pool.hpp"
+#include "ai_safety_controller/common/modbus_tcp_receiver.hpp"
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -13,17 +18,18 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <random>
-#include <sstream>
 #include <thread>
 
 namespace solar {
 
 namespace {
 
-uint16_t readBe16(const uint8_t* p) {
-  return static_cast<uint16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
-}
+using ai_safety_controller::common::LazyContext;
+using ai_safety_controller::common::LogLevel;
+using ai_safety_controller::common::LogLine;
+using ai_safety_controller::common::ModbusFrame;
 
 int computeRetryDelayMs(const SolarCore::RetryPolicy& policy, int retry_index) {
   if (retry_index <= 0) return 0;
@@ -80,7 +86,7 @@ SolarCore::SolarCore(const std::string& module_ip,
 
 SolarCore::~SolarCore() {
   std::lock_guard<std::mutex> lock(socket_mutex_);
-  disconnectLocked();
+  releaseConnectionLocked();
 }
 
 bool SolarCore::parseNumber(const std::string& text, int* out) {
@@ -112,76 +118,103 @@ bool SolarCore::parseFunctionCode(const std::string& text,
   return false;
 }
 
-std::vector<uint8_t> SolarCore::createModbusPacket(uint8_t function_code,
-                                                   uint16_t address,
-                                                   uint16_t value,
-                                                   uint16_t quantity,
-                                                   uint8_t unit_id,
-                                                   bool* ok) {
+ModbusFrame SolarCore::createModbusPacket(uint8_t function_code,
+                                          uint16_t address,
+                                          uint16_t value,
+                                          uint16_t quantity,
+                                          uint8_t unit_id,
+                                          bool* ok) {
   if (ok) *ok = false;
   if (function_code == 0x03 || function_code == 0x04) {
     transaction_id_ = static_cast<uint16_t>((transaction_id_ + 1) & 0xFFFF);
   }
   if (!(function_code == 0x03 || function_code == 0x04 || function_code == 0x05 ||
         function_code == 0x06)) {
-    std::cout << "[solar] ❌ 不支持的功能码\n";
+    LogLine(LogLevel::Error, "solar") << "❌ 不支持的功能码";
     return {};
   }
 
-  std::vector<uint8_t> pkt;
-  pkt.reserve(12);
-  const uint16_t protocol_id = 0x0000;
-  const uint16_t length = 6;
-  pkt.push_back(static_cast<uint8_t>((transaction_id_ >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(transaction_id_ & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((protocol_id >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(protocol_id & 0xFF));
-  pkt.push_back(static_cast<uint8_t>((length >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(length & 0xFF));
-  pkt.push_back(unit_id);
-  pkt.push_back(function_code);
-  pkt.push_back(static_cast<uint8_t>((address >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(address & 0xFF));
+  ModbusFrame pkt;
   const uint16_t data = (function_code == 0x03 || function_code == 0x04) ? quantity : value;
-  pkt.push_back(static_cast<uint8_t>((data >> 8) & 0xFF));
-  pkt.push_back(static_cast<uint8_t>(data & 0xFF));
+  ai_safety_controller::common::encodeMbapRequest(
+      &pkt, transaction_id_, unit_id, function_code, address, data);
   if (ok) *ok = true;
   return pkt;
 }
 
-bool SolarCore::sendModbusPacket(const std::vector<uint8_t>& packet,
-                                 std::vector<uint8_t>* response,
-                                 const std::string& context,
+void SolarCore::setRetryPolicy(const RetryPolicy& retry_policy) {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  retry_policy_ = retry_policy;
+}
+
+SolarCore::RetryPolicy SolarCore::retryPolicy() const {
+  std::lock_guard<std::mutex> lock(retry_policy_mutex_);
+  return retry_policy_;
+}
+
+bool SolarCore::sendModbusPacket(const ModbusFrame& packet,
+                                 ModbusFrame* response,
+                                 const LazyContext& context,
                                  double timeout_sec) {
   if (!response) return false;
   response->clear();
-  const std::string endpoint_key = module_ip_ + ":" + std::to_string(module_port_);
-  ai_safety_controller::common::GatewaySerialGuard serial_guard(endpoint_key, 120);
-  std::lock_guard<std::mutex> lock(socket_mutex_);
-  const int max_retries = std::max(0, retry_policy_.max_retries);
+  const std::string endpoint_key =
+      ai_safety_controller::common::ModbusTcpConnectionPool::endpointKey(module_ip_, module_port_);
+  // Pipelined gateways queue transactions themselves; everything else stays
+  // strictly serial behind the per-endpoint scheduler.
+  auto& pipeline = ai_safety_controller::common::ModbusTcpPipeline::instance();
+  const bool pipelined = pipeline.enabled(module_ip_, module_port_);
+  const std::uint8_t function_code = packet.size() > 7 ? packet[7] : 0;
+  ai_safety_controller::common::TransactionProbe probe(endpoint_key, function_code);
+  std::optional<ai_safety_controller::common::GatewaySerialGuard> serial_guard;
+  std::unique_lock<std::mutex> lock(socket_mutex_, std::defer_lock);
+  if (!pipelined) {
+    serial_guard.emplace(endpoint_key, 120, ai_safety_controller::common::busPriorityFor(function_code));
+    lock.lock();
+  }
+  probe.acquired();
+  const RetryPolicy policy = retryPolicy();
+  const int max_retries = std::max(0, policy.max_retries);
   for (int attempt = 0; attempt <= max_retries; ++attempt) {
     if (attempt > 0) {
-      const int delay_ms = computeRetryDelayMs(retry_policy_, attempt);
+      probe.retry();
+      const int delay_ms = computeRetryDelayMs(policy, attempt);
       if (delay_ms > 0) {
-        if (retry_policy_.log_enabled) {
-          std::cout << "[solar] ⚠️ 第" << attempt << "/" << max_retries
-                    << "次重试，退避" << delay_ms << "ms: " << context << "\n";
+        if (policy.log_enabled) {
+          LogLine(LogLevel::Warn, "solar") << "⚠️ 第" << attempt << "/" << max_retries
+                                           << "次重试，退避" << delay_ms << "ms: " << context;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
       }
     }
+    if (pipelined) {
+      std::string error;
+      bool timed_out = false;
+      probe.beginExchange();
+      if (pipeline.exchange(module_ip_, module_port_, packet, response, timeout_sec, &error, &timed_out)) {
+        probe.endExchange(packet.size(), response->size());
+        probe.finish(true);
+        return true;
+      }
+      if (timed_out) probe.timeout();
+      LogLine(LogLevel::Error, "solar") << "❌ " << error << ": " << context;
+      continue;
+    }
+    probe.beginConnect();
     if (!ensureConnectionLocked(timeout_sec)) {
       disconnectLocked();
       continue;
     }
-    if (sendAndReceiveLocked(packet, response, context)) {
-      disconnectLocked();
+    probe.endConnect();
+    if (sendAndReceiveLocked(packet, response, context, timeout_sec, &probe)) {
+      releaseConnectionLocked();
+      probe.finish(true);
       return true;
     }
     disconnectLocked();
   }
-  if (retry_policy_.log_enabled) {
-    std::cout << "[solar] ❌ 重试耗尽，操作失败: " << context << "\n";
+  if (policy.log_enabled) {
+    LogLine(LogLevel::Error, "solar") << "❌ 重试耗尽，操作失败: " << context;
   }
   return false;
 }
@@ -189,54 +222,53 @@ bool SolarCore::sendModbusPacket(const std::vector<uint8_t>& packet,
 bool SolarCore::ensureConnectionLocked(double timeout_sec) {
   if (socket_fd_ >= 0) return true;
 
-  socket_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  std::string error;
+  socket_fd_ = ai_safety_controller::common::ModbusTcpConnectionPool::instance().acquire(
+      module_ip_, module_port_, timeout_sec, &error);
   if (socket_fd_ < 0) {
-    std::cout << "[solar] ❌ socket 创建失败: " << std::strerror(errno) << "\n";
-    return false;
-  }
-  timeval tv{};
-  tv.tv_sec = static_cast<int>(timeout_sec);
-  tv.tv_usec = static_cast<int>((timeout_sec - tv.tv_sec) * 1000000.0);
-  ::setsockopt(socket_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-  ::setsockopt(socket_fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-  sockaddr_in addr{};
-  addr.sin_family = AF_INET;
-  addr.sin_port = htons(module_port_);
-  if (::inet_pton(AF_INET, module_ip_.c_str(), &addr.sin_addr) != 1) {
-    std::cout << "[solar] ❌ 模块IP无效: " << module_ip_ << "\n";
-    disconnectLocked();
-    return false;
-  }
-  if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
-    std::cout << "[solar] ❌ 连接失败: " << std::strerror(errno) << "\n";
-    disconnectLocked();
+    LogLine(LogLevel::Error, "solar") << "❌ " << error;
     return false;
   }
   return true;
 }
 
+void SolarCore::releaseConnectionLocked() {
+  ai_safety_controller::common::ModbusTcpConnectionPool::instance().release(
+      module_ip_, module_port_, socket_fd_);
+  socket_fd_ = -1;
+}
+
 void SolarCore::disconnectLocked() {
   if (socket_fd_ >= 0) {
-    ::close(socket_fd_);
+    ai_safety_controller::common::ModbusTcpConnectionPool::instance().discard(socket_fd_);
     socket_fd_ = -1;
   }
 }
 
-bool SolarCore::sendAndReceiveLocked(const std::vector<uint8_t>& packet,
-                                     std::vector<uint8_t>* response,
-                                     const std::string& context) {
+bool SolarCore::sendAndReceiveLocked(const ModbusFrame& packet,
+                                     ModbusFrame* response,
+                                     const LazyContext& context,
+                                     double timeout_sec,
+                                     ai_safety_controller::common::TransactionProbe* probe) {
+  probe->beginExchange();
   if (::send(socket_fd_, packet.data(), packet.size(), 0) < 0) {
-    std::cout << "[solar] ❌ 发送失败: " << std::strerror(errno) << "\n";
+    LogLine(LogLevel::Error, "solar") << "❌ 发送失败: " << std::strerror(errno);
     return false;
   }
-  uint8_t buf[1024];
-  const ssize_t n = ::recv(socket_fd_, buf, sizeof(buf), 0);
-  if (n <= 0) {
-    std::cout << "[solar] ❌ 无响应: " << context << "\n";
+  namespace mb = ai_safety_controller::common;
+  int stale = 0;
+  const mb::MbapReceiveStatus rx = mb::receiveMbapResponse(
+      socket_fd_, mb::readBe16(packet.data()), mb::deadlineAfter(timeout_sec), response, &stale);
+  if (stale > 0) {
+    LogLine(LogLevel::Warn, "solar") << "⚠️ 丢弃" << stale << "个过期响应帧: " << context;
+  }
+  if (rx != mb::MbapReceiveStatus::kOk) {
+    if (rx == mb::MbapReceiveStatus::kTimeout) probe->timeout();
+    probe->sent(packet.size());
+    LogLine(LogLevel::Error, "solar") << "❌ 无响应(" << mb::mbapReceiveStatusName(rx) << "): " << context;
     return false;
   }
-  response->assign(buf, buf + n);
+  probe->endExchange(packet.size(), response->size());
   return true;
 }
 
@@ -244,51 +276,68 @@ bool SolarCore::sendSolarRead(uint8_t function_code,
                               uint16_t address,
                               uint16_t quantity,
                               uint8_t unit_id,
-                              std::vector<uint8_t>* response,
+                              ModbusFrame* response,
                               double timeout_sec) {
   bool ok = false;
-  const std::vector<uint8_t> pkt =
-      createModbusPacket(function_code, address, 0, quantity, unit_id, &ok);
+  const ModbusFrame pkt = createModbusPacket(function_code, address, 0, quantity, unit_id, &ok);
   if (!ok) return false;
-  std::ostringstream ctx;
-  ctx << "太阳能读寄存器 fc=0x" << std::hex << std::uppercase << static_cast<int>(function_code)
-      << ", uid=" << std::dec << static_cast<int>(unit_id) << ", addr=0x" << std::hex
-      << std::uppercase << address << ", qty=" << std::dec << quantity;
-  return sendModbusPacket(pkt, response, ctx.str(), timeout_sec);
+  return sendModbusPacket(pkt, response,
+                          LazyContext("太阳能读寄存器", function_code, unit_id, address, quantity),
+                          timeout_sec);
+}
+
+bool SolarCore::readRegisters(uint8_t function_code,
+                              uint16_t address,
+                              uint16_t quantity,
+                              uint8_t unit_id,
+                              std::vector<uint16_t>* values,
+                              double timeout_sec,
+                              uint8_t* exception_code) {
+  ModbusFrame response;
+  if (exception_code) *exception_code = 0;
+  if (!sendSolarRead(function_code, address, quantity, unit_id, &response, timeout_sec)) {
+    return false;
+  }
+  return parseRegisterResponse(response, function_code, quantity, values, exception_code);
 }
 
-bool SolarCore::parseRegisterResponse(const std::vector<uint8_t>& response,
+bool SolarCore::parseRegisterResponse(const ModbusFrame& response,
                                       uint8_t function_code,
                                       uint16_t quantity,
-                                      std::vector<uint16_t>* values) const {
+                                      std::vector<uint16_t>* values,
+                                      uint8_t* exception_code) const {
+  using ai_safety_controller::common::DecodeError;
   if (!values) return false;
   values->clear();
-  if (response.size() < 9) {
-    std::cout << "[solar] ❌ 响应报文过短\n";
-    return false;
-  }
-  const uint8_t recv_fc = response[7];
-  if (recv_fc != function_code) {
-    const uint8_t err = response.size() > 8 ? response[8] : 0;
-    std::cout << "❌ 太阳能返回错误，错误码：0x" << std::hex << std::uppercase
-              << static_cast<int>(err) << std::dec << "\n";
-    return false;
-  }
-  const uint8_t data_len = response[8];
-  const size_t expected_len = 9 + data_len;
-  if (response.size() != expected_len) {
-    std::cout << "[solar] ❌ 响应长度异常，预期" << expected_len << "字节，实际" << response.size()
-              << "字节\n";
-    return false;
-  }
-  if (data_len < quantity * 2) {
-    std::cout << "[solar] ❌ 数据长度不足\n";
-    return false;
-  }
-  for (uint16_t i = 0; i < quantity; ++i) {
-    const size_t base = 9 + i * 2;
-    values->push_back(readBe16(&response[base]));
-  }
+  if (exception_code) *exception_code = 0;
+  const auto decoded = ai_safety_controller::common::decodeMbapRegisters(
+      response.data(), response.size(), function_code, quantity);
+  switch (decoded.error) {
+    case DecodeError::kNone:
+      break;
+    case DecodeError::kException:
+      if (exception_code) *exception_code = decoded.exception_code;
+      LogLine(LogLevel::Error, "solar").printf(
+          "❌ 太阳能返回错误，错误码：0x%X", static_cast<unsigned>(decoded.exception_code));
+      return false;
+    case DecodeError::kFunctionMismatch:
+      LogLine(LogLevel::Error, "solar").printf(
+          "❌ 功能码不匹配，期望0x%02X，实际0x%02X", static_cast<unsigned>(function_code),
+          static_cast<unsigned>(decoded.function_code));
+      return false;
+    case DecodeError::kLengthMismatch:
+      LogLine(LogLevel::Error, "solar") << "❌ 响应长度异常，预期" << decoded.expected_size << "字节，实际"
+                                        << response.size() << "字节";
+      return false;
+    case DecodeError::kShortPayload:
+      LogLine(LogLevel::Error, "solar") << "❌ 数据长度不足";
+      return false;
+    default:
+      LogLine(LogLevel::Error, "solar") << "❌ 响应报文过短";
+      return false;
+  }
+  values->reserve(quantity);
+  for (uint16_t i = 0; i < quantity; ++i) values->push_back(decoded.registers[i]);
   return true;
 }
 
@@ -320,23 +369,36 @@ void SolarCore::setChargeSampleTimeoutSec(double timeout_sec) {
   charge_sample_timeout_sec_ = std::min(std::max(timeout_sec, 0.1), 10.0);
 }
 
+void SolarCore::setReadGapTolerance(int registers) {
+  read_gap_tolerance_ = static_cast<uint16_t>(std::min(std::max(registers, 0), 64));
+}
+
 bool SolarCore::readChargeStatusSample(ChargeStatusSample* out) {
   if (!out) return false;
   out->ok = false;
   out->charge_status_word = 0;
   out->battery_current_a = 0.0;
 
-  std::vector<uint8_t> status_resp;
-  if (!sendSolarRead(0x04, 0x3201, 1, solar_slave_id_, &status_resp, charge_sample_timeout_sec_)) return false;
-  std::vector<uint16_t> status_values;
-  if (!parseRegisterResponse(status_resp, 0x04, 1, &status_values) || status_values.empty()) return false;
+  // 0x3201 charge status and 0x331B~0x331C battery current are more than one
+  // PDU apart, so the plan keeps them as two reads. A timeout on the first
+  // read ends the sample without issuing the second.
+  using ai_safety_controller::common::ModbusReadPlan;
+  ModbusReadPlan plan(read_gap_tolerance_);
+  plan.add(solar_slave_id_, 0x04, 0x3201, 1);
+  plan.add(solar_slave_id_, 0x04, 0x331B, 2);
+  const std::size_t failed =
+      plan.execute([&](const ModbusReadPlan::Block& b, std::vector<uint16_t>* block_values) {
+        uint8_t exception_code = 0;
+        const bool ok = readRegisters(b.function_code, b.address, b.quantity, b.unit_id, block_values,
+                                      charge_sample_timeout_sec_, &exception_code);
+        return ModbusReadPlan::readStatus(ok, exception_code);
+      });
+  if (failed != 0) return false;
 
-  std::vector<uint8_t> batt_curr_resp;
-  if (!sendSolarRead(0x04, 0x331B, 2, solar_slave_id_, &batt_curr_resp, charge_sample_timeout_sec_)) return false;
+  std::vector<uint16_t> status_values;
+  if (!plan.values(solar_slave_id_, 0x04, 0x3201, 1, &status_values)) return false;
   std::vector<uint16_t> batt_curr_values;
-  if (!parseRegisterResponse(batt_curr_resp, 0x04, 2, &batt_curr_values) || batt_curr_values.size() < 2) {
-    return false;
-  }
+  if (!plan.values(solar_slave_id_, 0x04, 0x331B, 2, &batt_curr_values)) return false;
 
   out->charge_status_word = status_values[0];
   out->battery_current_a = parseSigned32FromLH(batt_curr_values[0], batt_curr_values[1]) / 100.0;
@@ -372,22 +434,31 @@ bool SolarCore::confirmRiskyWrite(uint16_t addr) const {
   return input == "YES";
 }
 
-void SolarCore::genericRead(uint16_t address, uint16_t quantity, int function_code) {
+bool SolarCore::readRegisterValues(uint16_t address,
+                                   uint16_t quantity,
+                                   int function_code,
+                                   std::vector<uint16_t>* values,
+                                   std::string* error) {
   if (quantity < 1 || quantity > 125) {
-    std::cout << "[solar] ❌ 数量超限，读寄存器数量需在1~125\n";
-    return;
+    if (error) *error = "[solar] ❌ 数量超限，读寄存器数量需在1~125";
+    return false;
   }
-  int fc = (function_code < 0) ? 0x04 : function_code;
+  const int fc = (function_code < 0) ? 0x04 : function_code;
   if (!(fc == 0x03 || fc == 0x04)) {
-    std::cout << "❌ 太阳能读取仅支持功能码 0x03/0x04\n";
-    return;
+    if (error) *error = "❌ 太阳能读取仅支持功能码 0x03/0x04";
+    return false;
   }
-  std::vector<uint8_t> response;
-  if (!sendSolarRead(static_cast<uint8_t>(fc), address, quantity, solar_slave_id_, &response)) {
+  return readRegisters(static_cast<uint8_t>(fc), address, quantity, solar_slave_id_, values, 5.0);
+}
+
+void SolarCore::genericRead(uint16_t address, uint16_t quantity, int function_code) {
+  std::vector<uint16_t> values;
+  std::string error;
+  if (!readRegisterValues(address, quantity, function_code, &values, &error)) {
+    if (!error.empty()) std::cout << error << "\n";
     return;
   }
-  std::vector<uint16_t> values;
-  if (!parseRegisterResponse(response, static_cast<uint8_t>(fc), quantity, &values)) return;
+  const int fc = (function_code < 0) ? 0x04 : function_code;
   std::cout << "✅ 太阳能寄存器读取结果（fc=0x" << std::hex << std::uppercase << fc << std::dec
             << "）\n";
   for (size_t i = 0; i < values.size(); ++i) {
@@ -410,10 +481,10 @@ void SolarCore::genericWrite(uint16_t address, uint16_t value, int function_code
     return;
   }
   bool ok = false;
-  const std::vector<uint8_t> packet = createModbusPacket(
+  const ModbusFrame packet = createModbusPacket(
       static_cast<uint8_t>(fc), address, value, 0, solar_slave_id_, &ok);
   if (!ok) return;
-  std::vector<uint8_t> response;
+  ModbusFrame response;
   if (!sendModbusPacket(packet, &response, "太阳能写寄存器")) return;
   if (response == packet) {
     std::cout << "✅ 太阳能写入成功：0x" << std::hex << std::uppercase << std::setw(4)
@@ -431,10 +502,10 @@ void SolarCore::querySolarInfo(const std::string& info_type) {
   }
 
   if (info_type == "basic") {
-    std::vector<uint8_t> pv_resp;
-    std::vector<uint8_t> load_resp;
-    std::vector<uint8_t> soc_resp;
-    std::vector<uint8_t> batt_resp;
+    ModbusFrame pv_resp;
+    ModbusFrame load_resp;
+    ModbusFrame soc_resp;
+    ModbusFrame batt_resp;
     sendSolarRead(0x04, 0x3100, 4, solar_slave_id_, &pv_resp);
     sendSolarRead(0x04, 0x310C, 4, solar_slave_id_, &load_resp);
     sendSolarRead(0x04, 0x311A, 1, solar_slave_id_, &soc_resp);
@@ -479,7 +550,7 @@ void SolarCore::querySolarInfo(const std::string& info_type) {
       std::cout << "❌ 太阳能基础信息读取失败\n";
     }
   } else if (info_type == "status") {
-    std::vector<uint8_t> status_resp;
+    ModbusFrame status_resp;
     if (!sendSolarRead(0x04, 0x3200, 3, solar_slave_id_, &status_resp)) {
       std::cout << "❌ 太阳能状态信息读取失败\n";
       return;
@@ -526,7 +597,7 @@ void SolarCore::scanSolarSlaveIds(int start_id, int end_id) {
   std::vector<int> found;
   for (int uid = start_id; uid <= end_id; ++uid) {
     if (uid == module_slave_id_) continue;
-    std::vector<uint8_t> response;
+    ModbusFrame response;
     if (!sendSolarRead(0x04, 0x3100, 1, static_cast<uint8_t>(uid), &response, 1.5)) continue;
     std::vector<uint16_t> values;
     if (!parseRegisterResponse(response, 0x04, 1, &values)) continue;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -8,12 +10,15 @@
 
 namespace spd_lidar {
 
+constexpr size_t kSpdLidarFrameSize = 8;
+
+// raw 为定长数组，on_frame 回调全程不分配堆内存。
 struct SpdLidarFrame {
   bool valid_header = false;
   bool checksum_ok = false;
   uint8_t status = 0;
   uint16_t data = 0;
-  std::vector<uint8_t> raw;
+  std::array<uint8_t, kSpdLidarFrameSize> raw{};
 };
 
 class SpdLidarCore {
@@ -33,7 +38,12 @@ class SpdLidarCore {
   void emitFrameIfComplete();
   void emitLog(const std::string& text);
 
-  std::vector<uint8_t> recv_buf_;
+  // 定长接收缓冲：[recv_begin_, recv_end_) 为未消费字节。解析完成后剩余不足一帧，
+  // 只在尾部空间不够时把这几个字节搬回开头。
+  static constexpr size_t kRecvCapacity = 256;
+  std::array<uint8_t, kRecvCapacity> recv_buf_{};
+  size_t recv_begin_ = 0;
+  size_t recv_end_ = 0;
 };
 
 }  // namespace spd_lidar
@@ -1,6 +1,8 @@
 #include "spd_lidar/spd_lidar_core.hpp"
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -11,7 +13,6 @@ namespace {
 constexpr uint8_t kHeader1 = 0x55;
 constexpr uint8_t kHeader2 = 0xAA;
 constexpr uint8_t kCmdSingle = 0x88;
-constexpr size_t kFrameSize = 8;
 
 std::string formatHex(const std::vector<uint8_t>& data) {
   std::ostringstream oss;
@@ -90,41 +91,57 @@ void SpdLidarCore::handleInputLine(const std::string& line) {
 }
 
 void SpdLidarCore::handleRecvBytes(const uint8_t* data, size_t len) {
-  recv_buf_.insert(recv_buf_.end(), data, data + len);
-  emitFrameIfComplete();
+  while (len > 0) {
+    if (recv_end_ == kRecvCapacity) {
+      const size_t pending = recv_end_ - recv_begin_;
+      std::memmove(recv_buf_.data(), recv_buf_.data() + recv_begin_, pending);
+      recv_begin_ = 0;
+      recv_end_ = pending;
+    }
+    const size_t chunk = std::min(len, kRecvCapacity - recv_end_);
+    std::memcpy(recv_buf_.data() + recv_end_, data, chunk);
+    recv_end_ += chunk;
+    data += chunk;
+    len -= chunk;
+    emitFrameIfComplete();
+  }
 }
 
 void SpdLidarCore::reset() {
-  recv_buf_.clear();
+  recv_begin_ = 0;
+  recv_end_ = 0;
 }
 
 void SpdLidarCore::emitFrameIfComplete() {
-  while (recv_buf_.size() >= kFrameSize) {
-    size_t start = 0;
-    while (start + 2 < recv_buf_.size()) {
-      if (recv_buf_[start] == kHeader1 && recv_buf_[start + 1] == kHeader2 &&
-          recv_buf_[start + 2] == kCmdSingle) {
-        break;
-      }
-      ++start;
-    }
-    if (start > 0) {
-      recv_buf_.erase(recv_buf_.begin(), recv_buf_.begin() + static_cast<long>(start));
-    }
-    if (recv_buf_.size() < kFrameSize) {
+  const uint8_t* buf = recv_buf_.data();
+  while (recv_end_ - recv_begin_ >= kSpdLidarFrameSize) {
+    // memchr 定位帧头首字节，再校验后两个字节；不匹配则跳过这一字节继续找。
+    const void* hit = std::memchr(buf + recv_begin_, kHeader1, recv_end_ - recv_begin_);
+    if (!hit) {
+      recv_begin_ = recv_end_;
       break;
     }
+    recv_begin_ = static_cast<size_t>(static_cast<const uint8_t*>(hit) - buf);
+    if (recv_end_ - recv_begin_ < kSpdLidarFrameSize) break;
+    const uint8_t* frame = buf + recv_begin_;
+    if (frame[1] != kHeader2 || frame[2] != kCmdSingle) {
+      ++recv_begin_;
+      continue;
+    }
 
     SpdLidarFrame parsed;
-    parsed.raw.assign(recv_buf_.begin(), recv_buf_.begin() + static_cast<long>(kFrameSize));
-    parsed.valid_header = (parsed.raw[0] == kHeader1 && parsed.raw[1] == kHeader2 &&
-                           parsed.raw[2] == kCmdSingle);
-    parsed.status = parsed.raw[3];
-    parsed.data = static_cast<uint16_t>((parsed.raw[5] << 8) | parsed.raw[6]);
-    parsed.checksum_ok = (checksumRecv(parsed.raw.data()) == parsed.raw[7]);
+    std::memcpy(parsed.raw.data(), frame, kSpdLidarFrameSize);
+    parsed.valid_header = true;
+    parsed.status = frame[3];
+    parsed.data = static_cast<uint16_t>((frame[5] << 8) | frame[6]);
+    parsed.checksum_ok = (checksumRecv(frame) == frame[7]);
+    recv_begin_ += kSpdLidarFrameSize;
 
     on_frame(parsed);
-    recv_buf_.erase(recv_buf_.begin(), recv_buf_.begin() + static_cast<long>(kFrameSize));
+  }
+  if (recv_begin_ == recv_end_) {
+    recv_begin_ = 0;
+    recv_end_ = 0;
   }
 }
 
@@ -3,10 +3,12 @@
  * - Pull 槽：通过终端命令设置 SignalGetAlertMessage / SignalGetBatteryButtonSignals 的返回值。
  * - Push 槽：设备管理定时推送的数据会缓存，可通过终端命令读取并打印。
  *
- * 命令: help | alert <enable3|enable7|3m|7m> <on|off> | power <none|on|off> | status | crane | quit
+ * 命令: help | alert <enable3|enable7|3m|7m> <on|off> | power <none|on|off> | status | crane |
+ *       device metrics | quit
  */
 
 #include "ai_safety_controller/devices_manager_client.hpp"
+#include "ai_safety_controller/common/transaction_metrics_format.hpp"
 #include "ai_safety_common/shared_memory_types.hpp"
 
 #include <atomic>
@@ -71,6 +73,7 @@ void print_help() {
             << "  power <none|on|off>     - 设置 SignalGetBatteryButtonSignals 返回值\n"
             << "  status                  - 从 push 槽读取并打印最近一次 DeviceStatus\n"
             << "  crane                   - 从 push 槽读取并打印最近一次 CraneState\n"
+            << "  device metrics          - 打印各端点 / 功能码的收发延迟分位数与计数，以及各总线按优先级的排队统计\n"
             << "  quit                    - 退出\n";
 }
 
@@ -80,7 +83,9 @@ bool parse_on_off(const std::string& s, bool* out) {
   return false;
 }
 
-bool run_command(TestState& state, const std::string& line) {
+bool run_command(TestState& state,
+                 const ai_safety_controller::DevicesManagerClient& client,
+                 const std::string& line) {
   std::istringstream iss(line);
   std::string cmd;
   if (!(iss >> cmd)) return true;
@@ -119,6 +124,16 @@ bool run_command(TestState& state, const std::string& line) {
               << "m groundToTrolley=" << c.groundToTrolleyDistanceM << "m\n";
     return true;
   }
+  if (cmd == "device") {
+    std::string sub;
+    if (!(iss >> sub) || sub != "metrics") {
+      std::cout << "usage: device metrics\n";
+      return true;
+    }
+    std::cout << ai_safety_controller::common::formatTransactionMetrics(client.getMetricsSnapshot());
+    std::cout << ai_safety_controller::common::formatBusQueueMetrics(client.getBusQueueSnapshot());
+    return true;
+  }
   if (cmd == "alert") {
     std::string key, onoff;
     int applied = 0;
@@ -255,7 +270,7 @@ int main(int argc, char* argv[]) {
   while (g_running.load()) {
     if (read_line_with_timeout(line, 300)) {
       if (!line.empty()) {
-        run_command(state, line);
+        run_command(state, client, line);
       }
     }
   }
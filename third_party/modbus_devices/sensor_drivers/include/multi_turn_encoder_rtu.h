@@ -7,9 +7,12 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
-#include <deque>
+#include <type_traits>
 
 class MultiTurnEncoderRTU {
 public:
@@ -37,6 +40,12 @@ public:
         EVEN_CHECK = 3
     };
 
+    // Sampling policy of the run() thread
+    enum class AcquisitionMode {
+        FIXED_RATE = 0,  // sample every 1/rate_hz seconds
+        ON_DEMAND = 1    // sample only after requestSample(), still capped at rate_hz
+    };
+
     struct EncoderSettings {
         uint16_t deviceAddress;
         BaudRate baudRate;
@@ -62,6 +71,8 @@ public:
             : timestamp(ts), time_variance(var), value(val), velocity(vel) {}
     };
 
+    static constexpr size_t kVelocityWindowMax = 100;
+
     MultiTurnEncoderRTU(const char* ip, int port, int slave = 1);
     MultiTurnEncoderRTU(const char* device, int baud, char parity, int data_bit, int stop_bit, int slave);
     ~MultiTurnEncoderRTU();
@@ -84,36 +95,76 @@ public:
     bool readRawSettings(uint16_t registers[4]);
     EncoderSettingsString getEncoderSettings();
 
+    // Least-squares slope over the last `window` filtered samples; 0 until
+    // `warmup` samples are available.
     double computeVelocity();
+    // Call before run(); clears the history. window is clamped to
+    // [2, kVelocityWindowMax], warmup to [2, window].
+    void setVelocityWindow(size_t window, size_t warmup);
     void updateEncoderData(const double& turns, const double& timestamp, const double& duration);
+    // Single producer: call from the run() thread, or directly while it is stopped.
     void run_once();
     void run();
     void stop();
     
+    // Takes effect on the next run().
+    void setAcquisitionMode(AcquisitionMode mode, double rate_hz);
+    // Wake the ON_DEMAND loop; requests arriving faster than rate_hz coalesce.
+    void requestSample();
+
     StampedDouble getData() const {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        return data_;
+        return loadSample().raw;
     }
 
     double getDataTimestamp() const {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        return data_.timestamp;
+        return loadSample().raw.timestamp;
     }
 
     StampedEncoderData getEncoderData() const {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        return encoder_data_;
+        return loadSample().filtered;
     }
 
 private:
+    struct Sample {
+        StampedDouble raw;
+        StampedEncoderData filtered;
+    };
+    static_assert(std::is_trivially_copyable<Sample>::value, "Sample must be trivially copyable");
+    static constexpr size_t kSampleWords = (sizeof(Sample) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Seqlock with a single writer (the sampling thread): readers never block
+    // and retry only if they overlapped a publish.
+    void publishSample(const Sample& sample);
+    Sample loadSample() const;
+
     std::unique_ptr<ModbusControl> modbus_;
     std::thread run_thread_;
-    bool running_thread_{false};
-    mutable std::mutex data_mutex_;
+    std::atomic<bool> running_thread_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool sample_requested_{false};
+    AcquisitionMode acquisition_mode_{AcquisitionMode::FIXED_RATE};
+    double acquisition_rate_hz_{50.0};
+    std::atomic<uint64_t> sample_seq_{0};
+    std::atomic<uint64_t> sample_words_[kSampleWords] = {};
     StampedDouble data_;
     StampedEncoderData encoder_data_;
-    std::deque<StampedDouble> data_filtered_history_;
-    int history_size_ = 100;
+    void pushHistory(const StampedDouble& sample);
+    void rebaseHistory();
+
+    // Fixed ring of filtered samples plus running sums for the regression.
+    // Times are kept relative to history_t0_, which is moved to the oldest
+    // sample every full wrap so the sums stay well conditioned.
+    std::array<StampedDouble, kVelocityWindowMax> history_{};
+    size_t history_head_ = 0;
+    size_t history_count_ = 0;
+    size_t velocity_window_ = 20;
+    size_t velocity_warmup_ = 5;
+    double history_t0_ = 0.0;
+    double sum_t_ = 0.0;
+    double sum_v_ = 0.0;
+    double sum_tt_ = 0.0;
+    double sum_tv_ = 0.0;
     double alpha_ = 0.95;
-    bool data_valid_;
+    bool data_valid_{false};
 }; 
\ No newline at end of file
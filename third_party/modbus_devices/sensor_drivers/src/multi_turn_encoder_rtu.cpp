@@ -1,4 +1,5 @@
 #include "multi_turn_encoder_rtu.h"
+#include <algorithm>
 #include <memory>  // Add this for std::make_unique
 #include <iostream>
 #include <iomanip>
@@ -127,14 +128,66 @@ MultiTurnEncoderRTU::EncoderSettingsString MultiTurnEncoderRTU::getEncoderSettin
 
 
 double MultiTurnEncoderRTU::computeVelocity() {
-    if (data_filtered_history_.size() < history_size_) {
+    if (history_count_ < velocity_warmup_) {
         return 0.0;
+    }
+    const double n = static_cast<double>(history_count_);
+    const double denom = n * sum_tt_ - sum_t_ * sum_t_;
+    if (denom <= 1e-12) {
+        return 0.0;
+    }
+    return (n * sum_tv_ - sum_t_ * sum_v_) / denom;
+}
+
+void MultiTurnEncoderRTU::setVelocityWindow(size_t window, size_t warmup) {
+    velocity_window_ = std::min(std::max<size_t>(window, 2), kVelocityWindowMax);
+    velocity_warmup_ = std::min(std::max<size_t>(warmup, 2), velocity_window_);
+    history_head_ = 0;
+    history_count_ = 0;
+    sum_t_ = sum_v_ = sum_tt_ = sum_tv_ = 0.0;
+}
+
+void MultiTurnEncoderRTU::pushHistory(const StampedDouble& sample) {
+    if (history_count_ == 0) {
+        history_t0_ = sample.timestamp;
+    }
+    if (history_count_ == velocity_window_) {
+        // history_head_ is also the oldest slot once the window is full.
+        const StampedDouble& oldest = history_[history_head_];
+        const double t = oldest.timestamp - history_t0_;
+        sum_t_ -= t;
+        sum_v_ -= oldest.value;
+        sum_tt_ -= t * t;
+        sum_tv_ -= t * oldest.value;
     } else {
-        double dt = data_filtered_history_.back().timestamp - data_filtered_history_.front().timestamp;
-        if (dt == 0.0) {
-            return 0.0;
-        }
-        return (data_filtered_history_.back().value - data_filtered_history_.front().value) / dt;
+        ++history_count_;
+    }
+
+    history_[history_head_] = sample;
+    const double t = sample.timestamp - history_t0_;
+    sum_t_ += t;
+    sum_v_ += sample.value;
+    sum_tt_ += t * t;
+    sum_tv_ += t * sample.value;
+
+    history_head_ = (history_head_ + 1) % velocity_window_;
+    if (history_head_ == 0) {
+        rebaseHistory();
+    }
+}
+
+void MultiTurnEncoderRTU::rebaseHistory() {
+    // O(window) once per window, i.e. O(1) amortized per sample.
+    const size_t oldest = (history_head_ + velocity_window_ - history_count_) % velocity_window_;
+    history_t0_ = history_[oldest].timestamp;
+    sum_t_ = sum_v_ = sum_tt_ = sum_tv_ = 0.0;
+    for (size_t k = 0; k < history_count_; ++k) {
+        const StampedDouble& s = history_[(oldest + k) % velocity_window_];
+        const double t = s.timestamp - history_t0_;
+        sum_t_ += t;
+        sum_v_ += s.value;
+        sum_tt_ += t * t;
+        sum_tv_ += t * s.value;
     }
 }
 
@@ -146,27 +199,66 @@ void MultiTurnEncoderRTU::updateEncoderData(const double& turns, const double& t
     } else {
         turns_filtered = (1 - alpha_) * data_.value + alpha_ * turns;
     }
-    StampedDouble data_filtered = {timestamp, duration, turns_filtered};
-    data_filtered_history_.push_back(data_filtered);
-    if (data_filtered_history_.size() > history_size_) {
-        data_filtered_history_.pop_front();
-    }
+    pushHistory(StampedDouble{timestamp, duration, turns_filtered});
     double velocity = computeVelocity();
     encoder_data_ = {timestamp, duration, turns_filtered, velocity};
 }
 
+void MultiTurnEncoderRTU::publishSample(const Sample& sample) {
+    uint64_t buf[kSampleWords] = {};
+    std::memcpy(buf, &sample, sizeof(Sample));
+    const uint64_t seq = sample_seq_.load(std::memory_order_relaxed);
+    sample_seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kSampleWords; ++i) {
+        sample_words_[i].store(buf[i], std::memory_order_relaxed);
+    }
+    sample_seq_.store(seq + 2, std::memory_order_release);
+}
+
+MultiTurnEncoderRTU::Sample MultiTurnEncoderRTU::loadSample() const {
+    uint64_t buf[kSampleWords];
+    for (;;) {
+        const uint64_t begin = sample_seq_.load(std::memory_order_acquire);
+        if (begin & 1) continue;
+        for (size_t i = 0; i < kSampleWords; ++i) {
+            buf[i] = sample_words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sample_seq_.load(std::memory_order_relaxed) == begin) break;
+    }
+    Sample out;
+    std::memcpy(&out, buf, sizeof(Sample));
+    return out;
+}
+
 void MultiTurnEncoderRTU::run_once() {
     double turns, timestamp, duration;
     if (readEncoderNumberOfTurns(turns, timestamp, duration)) {
-        std::lock_guard<std::mutex> lock(data_mutex_);
         updateEncoderData(turns, timestamp, duration);
         data_ = {
             timestamp,
             duration,
             turns
         };
-        
+        publishSample(Sample{data_, encoder_data_});
+    }
+}
+
+void MultiTurnEncoderRTU::setAcquisitionMode(AcquisitionMode mode, double rate_hz) {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    acquisition_mode_ = mode;
+    if (rate_hz > 0.0) {
+        acquisition_rate_hz_ = rate_hz;
+    }
+}
+
+void MultiTurnEncoderRTU::requestSample() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        sample_requested_ = true;
     }
+    wake_cv_.notify_one();
 }
 
 void MultiTurnEncoderRTU::run() {
@@ -176,15 +268,45 @@ void MultiTurnEncoderRTU::run() {
     
     running_thread_ = true;
     run_thread_ = std::thread([this]() {
+        using Clock = std::chrono::steady_clock;
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        const AcquisitionMode mode = acquisition_mode_;
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / acquisition_rate_hz_));
+        Clock::time_point next = Clock::now();
+
         while (running_thread_) {
+            if (mode == AcquisitionMode::ON_DEMAND) {
+                wake_cv_.wait(lock, [this]() { return !running_thread_ || sample_requested_; });
+            }
+            // Deadline wait doubles as the rate cap in ON_DEMAND mode.
+            wake_cv_.wait_until(lock, next, [this]() { return !running_thread_; });
+            if (!running_thread_) {
+                break;
+            }
+            sample_requested_ = false;
+
+            lock.unlock();
             run_once();
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            lock.lock();
+
+            // Keep the fixed phase, but skip missed slots after a slow bus
+            // transaction instead of firing them back to back.
+            next += period;
+            const Clock::time_point now = Clock::now();
+            if (next < now) {
+                next = now;
+            }
         }
     });
 }
 
 void MultiTurnEncoderRTU::stop() {
-    running_thread_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_thread_ = false;
+    }
+    wake_cv_.notify_all();
     if (run_thread_.joinable()) {
         run_thread_.join();
     }